@@ -59,7 +59,7 @@ bool SzArchive::Open(FILE *file)
 	return (res == SZ_OK);
 }
 
-ArchiveFile* SzArchive::OpenFile(const char* name)
+int SzArchive::FindFile(const char *name)
 {
 	u16 fname[512];
 	for (UInt32 i = 0; i < szarchive.NumFiles; i++)
@@ -73,18 +73,43 @@ ArchiveFile* SzArchive::OpenFile(const char* name)
 		for (; j < len && j < sizeof(szname) - 1; j++)
 			szname[j] = fname[j];
 		szname[j] = 0;
-		if (strcmp(name, szname))
-			continue;
+		if (!strcmp(name, szname))
+			return (int)i;
+	}
+	return -1;
+}
 
-		size_t offset = 0;
-		size_t out_size_processed = 0;
-		SRes res = SzArEx_Extract(&szarchive, &lookStream.vt, i, &block_idx, &out_buffer, &out_buffer_size, &offset, &out_size_processed, &g_Alloc, &g_Alloc);
-		if (res != SZ_OK)
-			return NULL;
+ArchiveFile* SzArchive::OpenFile(const char* name)
+{
+	int i = FindFile(name);
+	if (i < 0)
+		return NULL;
 
-		return new SzArchiveFile(out_buffer, offset, (u32)out_size_processed);
-	}
-	return NULL;
+	size_t offset = 0;
+	size_t out_size_processed = 0;
+	SRes res = SzArEx_Extract(&szarchive, &lookStream.vt, i, &block_idx, &out_buffer, &out_buffer_size, &offset, &out_size_processed, &g_Alloc, &g_Alloc);
+	if (res != SZ_OK)
+		return NULL;
+
+	return new SzArchiveFile(out_buffer, offset, (u32)out_size_processed);
+}
+
+u32 SzArchive::GetFileCrc(const char *name)
+{
+	int i = FindFile(name);
+	if (i < 0 || !SzBitWithVals_Check(&szarchive.CRCs, i))
+		return 0;
+	return szarchive.CRCs.Vals[i];
+}
+
+bool SzArchive::HasFileCrc(u32 crc)
+{
+	if (crc == 0)
+		return false;
+	for (UInt32 i = 0; i < szarchive.NumFiles; i++)
+		if (!SzArEx_IsDir(&szarchive, i) && crc == szarchive.CRCs.Vals[i])
+			return true;
+	return false;
 }
 
 ArchiveFile* SzArchive::OpenFileByCrc(u32 crc)
@@ -38,11 +38,15 @@ public:
 
 	ArchiveFile* OpenFile(const char* name) override;
 	ArchiveFile *OpenFileByCrc(u32 crc) override;
+	u32 GetFileCrc(const char *name) override;
+	bool HasFileCrc(u32 crc) override;
 
 protected:
 	bool Open(FILE *file) override;
 
 private:
+	int FindFile(const char *name);
+
 	CSzArEx szarchive;
 	UInt32 block_idx;				/* it can have any value before first call (if outBuffer = 0) */
 	Byte *out_buffer;				/* it must be 0 before first call for each new archive. */
@@ -50,22 +50,29 @@ ArchiveFile* ZipArchive::OpenFile(const char* name)
 	return new ZipArchiveFile(zip_file, stat.size, stat.name);
 }
 
-static zip_file *zip_fopen_by_crc(zip_t *za, u32 crc, int flags, zip_uint64_t& index)
+static bool zip_find_crc(zip_t *za, u32 crc, int flags, zip_uint64_t& index)
 {
 	if (crc == 0)
-		return nullptr;
+		return false;
 
 	zip_int64_t n = zip_get_num_entries(za, 0);
 	for (index = 0; index < (zip_uint64_t)n; index++)
 	{
 		zip_stat_t stat;
 		if (zip_stat_index(za, index, flags, &stat) < -1)
-			return nullptr;
+			return false;
 		if (stat.crc == crc)
-			return zip_fopen_index(za, index, flags);
+			return true;
 	}
 
-	return nullptr;
+	return false;
+}
+
+static zip_file *zip_fopen_by_crc(zip_t *za, u32 crc, int flags, zip_uint64_t& index)
+{
+	if (!zip_find_crc(za, crc, flags, index))
+		return nullptr;
+	return zip_fopen_index(za, index, flags);
 }
 
 ArchiveFile* ZipArchive::OpenFileByCrc(u32 crc)
@@ -80,6 +87,20 @@ ArchiveFile* ZipArchive::OpenFileByCrc(u32 crc)
 	return new ZipArchiveFile(zip_file, stat.size, stat.name);
 }
 
+u32 ZipArchive::GetFileCrc(const char *name)
+{
+	zip_stat_t stat;
+	if (zip_stat(zip, name, 0, &stat) != 0 || (stat.valid & ZIP_STAT_CRC) == 0)
+		return 0;
+	return stat.crc;
+}
+
+bool ZipArchive::HasFileCrc(u32 crc)
+{
+	zip_uint64_t index;
+	return zip_find_crc(zip, crc, 0, index);
+}
+
 u32 ZipArchiveFile::Read(void* buffer, u32 length)
 {
 	return zip_fread(zip_file, buffer, length);
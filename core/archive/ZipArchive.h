@@ -30,6 +30,8 @@ public:
 
 	ArchiveFile* OpenFile(const char* name) override;
 	ArchiveFile* OpenFileByCrc(u32 crc) override;
+	u32 GetFileCrc(const char *name) override;
+	bool HasFileCrc(u32 crc) override;
 
 	bool Open(FILE *file) override;
 	bool Open(const void *data, size_t size);
@@ -37,6 +37,10 @@ public:
 	virtual ~Archive() = default;
 	virtual ArchiveFile *OpenFile(const char *name) = 0;
 	virtual ArchiveFile *OpenFileByCrc(u32 crc) = 0;
+	// CRC32 of the named file as recorded in the archive directory, or 0 if not found
+	virtual u32 GetFileCrc(const char *name) = 0;
+	// Returns true if the archive contains a file with the given CRC32
+	virtual bool HasFileCrc(u32 crc) = 0;
 
 protected:
 	virtual bool Open(FILE *file) = 0;
@@ -19,8 +19,13 @@
 #include "rzip.h"
 #include <zlib.h>
 
+#include <algorithm>
 #include <cstring>
+#include <thread>
+#include <vector>
 
+// RetroArch savestate format. Chunks must be zlib-compressed to stay readable by existing
+// savestates and libretro frontends, even though zstd is available through libchdr.
 const u8 RZipHeader[8] = { '#', 'R', 'Z', 'I', 'P', 'v', 1, '#' };
 
 bool RZipFile::Open(FILE *file, bool write)
@@ -146,31 +151,47 @@ size_t RZipFile::Write(const void *data, size_t length)
 
 	size += length;
 	const u8 *p = (const u8 *)data;
+	// Chunks are independent so a batch of them is compressed in parallel, then written in order
+	const u32 batchSize = std::max(1u, std::thread::hardware_concurrency());
 	// compression output buffer must be 0.1% larger + 12 bytes
-	uLongf maxZippedSize = maxChunkSize + maxChunkSize / 1000 + 12;
-	u8 *zipped = new u8[maxZippedSize];
+	const uLongf maxZippedSize = maxChunkSize + maxChunkSize / 1000 + 12;
+	std::vector<u8> zipped((size_t)maxZippedSize * batchSize);
+	std::vector<uLongf> zippedSizes(batchSize);
+	std::vector<int> results(batchSize);
+	std::vector<std::thread> threads;
 	size_t rv = 0;
 	while (rv < length)
 	{
-		uLongf zippedSize = maxZippedSize;
-		uLongf uncompressedSize = std::min(maxChunkSize, (u32)(length - rv));
-		u32 rc = compress(zipped, &zippedSize, p, uncompressedSize);
-		if (rc != Z_OK)
-		{
-			WARN_LOG(SAVESTATE, "Compression error: %d", rc);
-			break;
-		}
-		u32 sz = (u32)zippedSize;
-		if (std::fwrite(&sz, sizeof(sz), 1, file) != 1
-			|| std::fwrite(zipped, zippedSize, 1, file) != 1)
+		const u32 chunkCount = std::min<size_t>(batchSize, (length - rv + maxChunkSize - 1) / maxChunkSize);
+		auto compressChunk = [&](u32 i) {
+			const size_t offset = (size_t)i * maxChunkSize;
+			const uLongf uncompressedSize = std::min<size_t>(maxChunkSize, length - rv - offset);
+			zippedSizes[i] = maxZippedSize;
+			results[i] = compress(&zipped[(size_t)i * maxZippedSize], &zippedSizes[i], p + offset, uncompressedSize);
+		};
+		for (u32 i = 1; i < chunkCount; i++)
+			threads.emplace_back(compressChunk, i);
+		compressChunk(0);
+		for (std::thread& thread : threads)
+			thread.join();
+		threads.clear();
+
+		for (u32 i = 0; i < chunkCount; i++)
 		{
-			rv = 0;
-			break;
+			if (results[i] != Z_OK)
+			{
+				WARN_LOG(SAVESTATE, "Compression error: %d", results[i]);
+				return rv;
+			}
+			u32 sz = (u32)zippedSizes[i];
+			if (std::fwrite(&sz, sizeof(sz), 1, file) != 1
+				|| std::fwrite(&zipped[(size_t)i * maxZippedSize], sz, 1, file) != 1)
+				return 0;
+			const u32 uncompressedSize = std::min<size_t>(maxChunkSize, length - rv);
+			p += uncompressedSize;
+			rv += uncompressedSize;
 		}
-		p += uncompressedSize;
-		rv += uncompressedSize;
 	}
-	delete [] zipped;
-	
+
 	return rv;
 }
@@ -1,12 +1,131 @@
 #include "audiostream.h"
 #include "cfg/option.h"
+#include "oslib/oslib.h"
+#include "stdclass.h"
+
+#include <thread>
 
 struct SoundFrame { s16 l; s16 r; };
 
 static SoundFrame Buffer[SAMPLE_COUNT];
 static u32 writePtr;  // next sample index
-
 static AudioBackend *currentBackend;
+
+//
+// The emulated audio is queued in a ring buffer and pushed to the backend by the audio output thread,
+// so that the emulator never blocks inside the backend.
+// By default the emulator waits when a chunk is already queued, which synchronizes the emulation with
+// the audio output. The queued chunk adds about 12 ms of latency compared to pushing the samples
+// to the backend directly. With dynamic rate control the emulator never waits, and the output is
+// resampled slightly faster or slower to keep the buffer half full.
+//
+constexpr u32 ChunkSize = sizeof(Buffer);
+// Chunks queued before the emulator waits for the output, when synchronized with the audio.
+// Each chunk is 512 samples or 11.6 ms.
+constexpr u32 QueuedChunks = 1;
+constexpr u32 RingChunks = 4;
+// Maximum resampling ratio deviation
+constexpr float MaxDrift = 0.005f;
+
+static RingBuffer ringBuffer;
+static std::thread outputThread;
+static std::atomic<bool> outputRunning;
+static cResetEvent dataAvailable;
+static cResetEvent spaceAvailable;
+
+static std::atomic<u32> underruns;
+static std::atomic<u32> overruns;
+static std::atomic<int> drift;
+
+// Linear interpolation resampler reading from the ring buffer
+class Resampler
+{
+	SoundFrame prev {};
+	SoundFrame next {};
+	u32 pos = 0x10000;	// 16.16 position between prev and next
+
+public:
+	// Returns false if there isn't enough buffered input
+	bool resample(SoundFrame *out, u32 count, u32 step)
+	{
+		const u64 needed = ((u64)pos + (u64)(count - 1) * step) >> 16;
+		if (ringBuffer.available() < needed * sizeof(SoundFrame))
+			return false;
+		for (u32 i = 0; i < count; i++, pos += step)
+		{
+			for (; pos >= 0x10000; pos -= 0x10000)
+			{
+				prev = next;
+				ringBuffer.read((u8 *)&next, sizeof(next));
+			}
+			// the sample difference times the 16-bit fraction doesn't fit in 32 bits
+			const s64 frac = pos;
+			out[i].l = prev.l + (s32)(((next.l - prev.l) * frac) >> 16);
+			out[i].r = prev.r + (s32)(((next.r - prev.r) * frac) >> 16);
+		}
+		return true;
+	}
+
+	void reset() {
+		*this = Resampler();
+	}
+};
+static Resampler resampler;
+
+static bool readOutput(SoundFrame *out)
+{
+	if (!config::DynamicRateControl)
+		return ringBuffer.read((u8 *)out, ChunkSize);
+
+	// Consume faster when the buffer is more than half full, and slower when less
+	const float fill = (float)ringBuffer.available() / ringBuffer.capacity();
+	const float ratio = 1.f + MaxDrift * (fill - 0.5f) * 2.f;
+	drift = (int)std::lround((ratio - 1.f) * 1000000.f);
+	return resampler.resample(out, SAMPLE_COUNT, (u32)std::lround(ratio * 0x10000));
+}
+
+static void audioOutput()
+{
+	ThreadName _("AudioOutput");
+	SoundFrame out[SAMPLE_COUNT];
+	bool starved = true;
+	while (outputRunning)
+	{
+		if (!readOutput(out))
+		{
+			if (!starved)
+				underruns++;
+			starved = true;
+			dataAvailable.Wait(10);
+			continue;
+		}
+		starved = false;
+		spaceAvailable.Set();
+		currentBackend->push(out, SAMPLE_COUNT, config::LimitFPS);
+	}
+}
+
+static void startOutput()
+{
+	ringBuffer.setCapacity(RingChunks * ChunkSize + sizeof(SoundFrame));
+	resampler.reset();
+	underruns = 0;
+	overruns = 0;
+	drift = 0;
+	outputRunning = true;
+	outputThread = std::thread(audioOutput);
+}
+
+static void stopOutput()
+{
+	if (!outputThread.joinable())
+		return;
+	outputRunning = false;
+	dataAvailable.Set();
+	spaceAvailable.Set();
+	outputThread.join();
+}
+
 std::vector<AudioBackend *> *AudioBackend::backends;
 
 static bool audio_recording_started;
@@ -52,12 +171,31 @@ void WriteSample(s16 r, s16 l)
 
 	if (++writePtr == SAMPLE_COUNT)
 	{
-		if (currentBackend != nullptr)
-			currentBackend->push(Buffer, SAMPLE_COUNT, config::LimitFPS);
 		writePtr = 0;
+		if (currentBackend == nullptr)
+			return;
+		if (!config::DynamicRateControl && config::LimitFPS)
+		{
+			while (ringBuffer.available() >= QueuedChunks * ChunkSize && outputRunning)
+				spaceAvailable.Wait(10);
+		}
+		if (ringBuffer.write((const u8 *)Buffer, ChunkSize))
+			dataAvailable.Set();
+		else
+			overruns++;
 	}
 }
 
+AudioStats GetAudioStats()
+{
+	AudioStats stats;
+	stats.underruns = underruns;
+	stats.overruns = overruns;
+	stats.fillLevel = ringBuffer.capacity() == 0 ? 0.f : (float)ringBuffer.available() / ringBuffer.capacity();
+	stats.drift = drift;
+	return stats;
+}
+
 void InitAudio()
 {
 	TermAudio();
@@ -91,6 +229,7 @@ void InitAudio()
 		WARN_LOG(AUDIO, "Running without audio!");
 		return;
 	}
+	startOutput();
 
 	if (audio_recording_started)
 	{
@@ -105,6 +244,7 @@ void TermAudio()
 	if (currentBackend == nullptr)
 		return;
 
+	stopOutput();
 	// Save recording state before stopping
 	bool rec_started = audio_recording_started;
 	StopAudioRecording();
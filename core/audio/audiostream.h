@@ -63,6 +63,15 @@ void InitAudio();
 void TermAudio();
 void WriteSample(s16 right, s16 left);
 
+struct AudioStats
+{
+	u32 underruns;		// times the output ran out of emulated audio
+	u32 overruns;		// emulated chunks dropped because the buffer was full
+	float fillLevel;	// buffer fill level, from 0 to 1
+	int drift;			// resampling ratio deviation in ppm
+};
+AudioStats GetAudioStats();
+
 void StartAudioRecording(bool eight_khz);
 u32 RecordAudio(void *buffer, u32 samples);
 void StopAudioRecording();
@@ -83,6 +92,13 @@ class RingBuffer
 	}
 
 public:
+	u32 available() {
+		return readSize();
+	}
+	u32 capacity() const {
+		return buffer.empty() ? 0 : (u32)buffer.size() - 1;
+	}
+
 	bool write(const u8 *data, u32 size)
 	{
 		if (size > writeSize())
@@ -0,0 +1,98 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "types.h"
+#include <atomic>
+
+//
+// Per-subsystem timers and counters of the flycast-bench runner.
+// They compile to nothing unless FC_BENCHMARK is defined (BUILD_BENCHMARK),
+// and the timers only run once flycast-bench sets bench::enabled.
+//
+namespace bench
+{
+
+enum Subsystem {
+	Sh4,
+	Arm7,
+	Aica,
+	Ta,				// TA data DMA and display list parsing, timed per list or per DMA transfer
+	RendererPrep,
+	SubsystemCount
+};
+
+enum Counter {
+	BlocksCompiled,
+	CacheFlushes,
+	CounterCount
+};
+
+#ifdef FC_BENCHMARK
+
+// Set by flycast-bench before the emulation starts. The emulator built with the benchmark runner keeps it off.
+extern bool enabled;
+// Exclusive time in nanoseconds: the time spent in nested scopes is only accounted to them.
+// Updated by the emulator, render, aica and audio threads.
+extern std::atomic<u64> times[SubsystemCount];
+extern std::atomic<u64> counters[CounterCount];
+
+u64 now();
+
+class Scope
+{
+public:
+	Scope(Subsystem subsystem) : subsystem(subsystem)
+	{
+		if (!enabled)
+			return;
+		parent = current;
+		start = now();
+		current = this;
+	}
+	~Scope()
+	{
+		if (start == 0)
+			return;
+		u64 elapsed = now() - start;
+		times[subsystem].fetch_add(elapsed - children, std::memory_order_relaxed);
+		if (parent != nullptr)
+			parent->children += elapsed;
+		current = parent;
+	}
+
+private:
+	Subsystem subsystem;
+	Scope *parent = nullptr;
+	u64 start = 0;
+	u64 children = 0;
+
+	static thread_local Scope *current;
+};
+
+#define BENCH_SCOPE(subsystem) bench::Scope _benchScope(bench::subsystem)
+#define BENCH_COUNT(counter) bench::counters[bench::counter].fetch_add(1, std::memory_order_relaxed)
+
+#else
+
+#define BENCH_SCOPE(subsystem)
+#define BENCH_COUNT(counter)
+
+#endif
+
+}	// namespace bench
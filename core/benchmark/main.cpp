@@ -0,0 +1,253 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// flycast-bench: headless benchmark runner.
+// Boots a disc image (and optionally a savestate) with no audio output and no renderer, or the software renderer,
+// runs a fixed number of guest frames as fast as possible and prints the results in JSON.
+//
+#include "benchmark.h"
+#include "emulator.h"
+#include "log/LogManager.h"
+#include "cfg/cfg.h"
+#include "cfg/option.h"
+#include "hw/mem/addrspace.h"
+#include "hw/pvr/Renderer_if.h"
+#include "oslib/oslib.h"
+#include "stdclass.h"
+#include "version.h"
+#include "json.hpp"
+#include <stb_image_write.h>
+
+#include <csignal>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace nlohmann;
+
+Renderer *rend_norend();
+
+namespace bench
+{
+
+static const char * const subsystemNames[SubsystemCount] = { "sh4", "arm7", "aica", "ta", "renderer_prep" };
+static const char * const counterNames[CounterCount] = { "blocks_compiled", "cache_flushes" };
+
+static u32 frames;
+
+static void vblankCallback(Event, void *) {
+	frames++;
+}
+
+static std::string userDir(const char *xdgVar, const char *homeSuffix)
+{
+	std::string dir;
+	if (nowide::getenv(xdgVar) != nullptr)
+		dir = nowide::getenv(xdgVar);
+	else if (nowide::getenv("HOME") != nullptr)
+		dir = std::string(nowide::getenv("HOME")) + homeSuffix;
+	if (dir.empty())
+		return "./";
+	return dir + "/flycast/";
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-frames <count>] [-state <slot>] [-output <file.json>] [-interpreter] [-software] [-screenshot <file.png>] [-config section:key=value] <game>\n", name);
+	exit(1);
+}
+
+static void saveScreenshot(const std::string& path)
+{
+	std::vector<u8> data;
+	int width = 0;
+	int height = 0;
+	if (renderer == nullptr || !renderer->GetLastFrame(data, width, height))
+	{
+		WARN_LOG(COMMON, "No frame available for the screenshot");
+		return;
+	}
+	if (stbi_write_png(path.c_str(), width, height, 3, data.data(), width * 3) == 0)
+		ERROR_LOG(COMMON, "Can't write %s", path.c_str());
+}
+
+static json run(const std::string& game, u32 frameCount, int stateSlot, bool software, const std::string& screenshotPath)
+{
+	if (!software)
+		// No rendering at all unless the software renderer is benchmarked
+		renderer = rend_norend();
+	rend_init_renderer();
+	emu.loadGame(game.c_str());
+	if (stateSlot >= 0)
+		dc_loadstate(stateSlot);
+	for (auto& time : times)
+		time = 0;
+	for (auto& counter : counters)
+		counter = 0;
+	frames = 0;
+	enabled = true;
+	EventManager::listen(Event::VBlank, vblankCallback);
+
+	emu.start();
+	u64 start = now();
+	while (frames < frameCount && emu.running())
+	{
+		BENCH_SCOPE(Sh4);
+		emu.render();
+	}
+	u64 elapsed = now() - start;
+	enabled = false;
+	EventManager::unlisten(Event::VBlank, vblankCallback);
+	if (!screenshotPath.empty())
+		saveScreenshot(screenshotPath);
+	emu.unloadGame();
+	rend_term_renderer();
+
+	json result;
+	result["version"] = GIT_VERSION;
+	result["game"] = game;
+	result["dynarec"] = (bool)config::DynarecEnabled;
+	result["frames"] = frames;
+	result["seconds"] = elapsed / 1e9;
+	result["fps"] = elapsed == 0 ? 0.0 : frames * 1e9 / elapsed;
+	json subsystems;
+	for (int i = 0; i < SubsystemCount; i++)
+		subsystems[subsystemNames[i]] = times[i].load() / 1e9;
+	result["subsystems"] = subsystems;
+	for (int i = 0; i < CounterCount; i++)
+		result[counterNames[i]] = counters[i].load();
+
+	return result;
+}
+
+}	// namespace bench
+
+void os_DoEvents()
+{
+}
+
+void os_RunInstance(int argc, const char *argv[])
+{
+}
+
+[[noreturn]] void os_DebugBreak()
+{
+	raise(SIGTRAP);
+	std::abort();
+}
+
+void common_linux_setup();
+
+int main(int argc, char *argv[])
+{
+	u32 frameCount = 3600;
+	int stateSlot = -1;
+	bool interpreter = false;
+	bool software = false;
+	std::string outputPath;
+	std::string screenshotPath;
+	// Remaining arguments are handled by the regular command line parser
+	std::vector<char *> args { argv[0] };
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "-frames" && i + 1 < argc)
+			frameCount = atoi(argv[++i]);
+		else if (arg == "-state" && i + 1 < argc)
+			stateSlot = atoi(argv[++i]);
+		else if (arg == "-output" && i + 1 < argc)
+			outputPath = argv[++i];
+		else if (arg == "-interpreter")
+			interpreter = true;
+		else if (arg == "-software")
+			software = true;
+		else if (arg == "-screenshot" && i + 1 < argc)
+			screenshotPath = argv[++i];
+		else if (arg == "-help" || arg == "--help")
+			bench::usage(argv[0]);
+		else
+			args.push_back(argv[i]);
+	}
+
+	LogManager::Init();
+	set_user_config_dir(bench::userDir("XDG_CONFIG_HOME", "/.config"));
+	set_user_data_dir(bench::userDir("XDG_DATA_HOME", "/.local/share"));
+	add_system_data_dir("./");
+	add_system_data_dir("data/");
+	common_linux_setup();
+
+	if (!addrspace::reserve())
+	{
+		ERROR_LOG(VMEM, "Failed to alloc mem");
+		return 1;
+	}
+	ParseCommandLine((int)args.size(), args.data());
+	if (settings.content.path.empty())
+		bench::usage(argv[0]);
+
+	// No frame pacing, no audio output, no state loaded or saved behind our back
+	cfgSetVirtual("config", "rend.ThreadedRendering", "no");
+	cfgSetVirtual("audio", "backend", "null");
+	cfgSetVirtual("config", "Dreamcast.AutoLoadState", "no");
+	cfgSetVirtual("config", "Dreamcast.AutoSaveState", "no");
+	cfgSetVirtual("network", "GGPO", "no");
+	if (interpreter)
+		cfgSetVirtual("config", "Dynarec.Enabled", "no");
+	if (software)
+		cfgSetVirtual("config", "pvr.rend", std::to_string((int)RenderType::Software));
+	settings.aica.muteAudio = true;
+
+	config::Settings::instance().reset();
+	LogManager::Shutdown();
+	cfgOpen();
+	LogManager::Init();
+	config::Settings::instance().load(false);
+
+	int rc = 0;
+	try {
+		json result = bench::run(settings.content.path, frameCount, stateSlot, software, screenshotPath);
+		std::string output = result.dump(4);
+		if (outputPath.empty())
+		{
+			printf("%s\n", output.c_str());
+		}
+		else
+		{
+			FILE *f = nowide::fopen(outputPath.c_str(), "w");
+			if (f == nullptr)
+			{
+				ERROR_LOG(COMMON, "Can't create %s: errno %d", outputPath.c_str(), errno);
+				rc = 1;
+			}
+			else
+			{
+				fprintf(f, "%s\n", output.c_str());
+				std::fclose(f);
+			}
+		}
+	} catch (const std::exception& e) {
+		ERROR_LOG(COMMON, "Benchmark failed: %s", e.what());
+		rc = 1;
+	}
+
+	emu.term();
+	os_UninstallFaultHandler();
+
+	return rc;
+}
@@ -25,6 +25,12 @@ namespace config {
 // Dynarec
 
 Option<bool> DynarecEnabled("Dynarec.Enabled", true);
+Option<bool> DynarecBlockCache("Dynarec.BlockCache");
+Option<bool> DynarecTieredCompilation("Dynarec.TieredCompilation");
+Option<bool> DynarecSuperblocks("Dynarec.Superblocks");
+Option<bool> DynarecHostMmu("Dynarec.HostMmu", false);
+// Interpreter underclock factor. Full speed by default.
+Option<int> InterpreterCpuRatio("Dynarec.InterpreterCpuRatio", 1);
 Option<int> Sh4Clock("Sh4Clock", 200);
 
 // General
@@ -44,11 +50,13 @@ Option<int, false> UIScaling("UIScaling", 100);
 // Sound
 
 Option<bool> DSPEnabled("aica.DSPEnabled", false);
+Option<bool> ThreadedAudio("aica.ThreadedAudio", false);
 #if HOST_CPU == CPU_ARM
 Option<int> AudioBufferSize("aica.BufferSize", 5644);	// 128 ms
 #else
 Option<int> AudioBufferSize("aica.BufferSize", 2822);	// 64 ms
 #endif
+Option<bool> DynamicRateControl("aica.DynamicRateControl", false);
 Option<bool> AutoLatency("aica.AutoLatency",
 #ifdef __ANDROID__
 		true
@@ -76,6 +84,7 @@ Option<int> MaxFilteredTextureSize("rend.MaxFilteredTextureSize", 256);
 Option<float> ExtraDepthScale("rend.ExtraDepthScale", 1.f);
 Option<bool> CustomTextures("rend.CustomTextures");
 Option<bool> DumpTextures("rend.DumpTextures");
+Option<bool> AsyncTextureDecode("rend.AsyncTextureDecode");
 Option<int> ScreenStretching("rend.ScreenStretching", 100);
 Option<bool> Fog("rend.Fog", true);
 Option<bool> FloatVMUs("rend.FloatVMUs");
@@ -100,9 +109,11 @@ Option<int> AutoSkipFrame("pvr.AutoSkipFrame", 0);
 Option<int> RenderResolution("rend.Resolution", 480);
 Option<bool> VSync("rend.vsync", true);
 Option<int64_t> PixelBufferSize("rend.PixelBufferSize", 512_MB);
+Option<int64_t> TextureCacheSize("rend.TextureCacheSize", 512_MB);
 Option<int> AnisotropicFiltering("rend.AnisotropicFiltering", 1);
 Option<int> TextureFiltering("rend.TextureFiltering", 0); // Default
 Option<bool> ThreadedRendering("rend.ThreadedRendering", true);
+Option<bool> PipelinedTAParsing("rend.PipelinedTAParsing");
 Option<bool> DupeFrames("rend.DupeFrames", false);
 Option<int> PerPixelLayers("rend.PerPixelLayers", 32);
 Option<bool> NativeDepthInterpolation("rend.NativeDepthInterpolation", false);
@@ -124,6 +135,9 @@ Option<int> GDBPort("Debug.GDBPort", debugger::DEFAULT_PORT);
 Option<bool> GDBWaitForConnection("Debug.GDBWaitForConnection");
 Option<bool> UseReios("UseReios");
 Option<bool> FastGDRomLoad("FastGDRomLoad", false);
+Option<int, false> ChdCacheSize("ChdCacheSize", 16);
+Option<bool, false> DimmCache("DimmCache", false);
+Option<bool, false> NaomiRomCache("NaomiRomCache", false);
 Option<bool> RamMod32MB("Dreamcast.RamMod32MB", false);
 
 Option<bool> OpenGlChecks("OpenGlChecks", false, "validate");
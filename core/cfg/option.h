@@ -356,6 +356,11 @@ using OptionString = Option<std::string>;
 // Dynarec
 
 extern Option<bool> DynarecEnabled;
+extern Option<bool> DynarecBlockCache;
+extern Option<bool> DynarecTieredCompilation;
+extern Option<bool> DynarecSuperblocks;
+extern Option<bool> DynarecHostMmu;
+extern Option<int> InterpreterCpuRatio;
 #ifndef LIBRETRO
 extern Option<int> Sh4Clock;
 #endif
@@ -378,8 +383,10 @@ extern Option<int, false> UIScaling;
 
 constexpr bool LimitFPS = true;
 extern Option<bool> DSPEnabled;
+extern Option<bool> ThreadedAudio;
 extern Option<int> AudioBufferSize;	//In samples ,*4 for bytes
 extern Option<bool> AutoLatency;
+extern Option<bool> DynamicRateControl;
 
 extern OptionString AudioBackend;
 
@@ -452,6 +459,7 @@ extern Option<int> PerPixelLayers;
 extern Option<float> ExtraDepthScale;
 extern Option<bool> CustomTextures;
 extern Option<bool> DumpTextures;
+extern Option<bool> AsyncTextureDecode;
 extern Option<int> ScreenStretching;	// in percent. 150 means stretch from 4/3 to 6/3
 extern Option<bool> Fog;
 extern Option<bool> FloatVMUs;
@@ -467,9 +475,11 @@ extern Option<int> AutoSkipFrame;		// 0: none, 1: some, 2: more
 extern Option<int> RenderResolution;
 extern Option<bool> VSync;
 extern Option<int64_t> PixelBufferSize;
+extern Option<int64_t> TextureCacheSize;	// host memory used by cached textures, in bytes. 0: no limit
 extern Option<int> AnisotropicFiltering;
 extern Option<int> TextureFiltering; // 0: default, 1: force nearest, 2: force linear
 extern Option<bool> ThreadedRendering;
+extern Option<bool> PipelinedTAParsing;
 extern Option<bool> DupeFrames;
 extern Option<bool> NativeDepthInterpolation;
 extern Option<bool> EmulateFramebuffer;
@@ -490,6 +500,9 @@ extern Option<int> GDBPort;
 extern Option<bool> GDBWaitForConnection;
 extern Option<bool> UseReios;
 extern Option<bool> FastGDRomLoad;
+extern Option<int, false> ChdCacheSize;	// in hunks
+extern Option<bool, false> DimmCache;
+extern Option<bool, false> NaomiRomCache;
 extern Option<bool> RamMod32MB;
 
 extern Option<bool> OpenGlChecks;
@@ -708,6 +708,8 @@ void Emulator::stop()
 		// normally only useful on android due to multithreading
 		stopRequested = true;
 #else
+		// the aica thread may still be generating audio
+		aica::sync();
 		TermAudio();
 		nvmem::saveFiles();
 		EventManager::event(Event::Pause);
@@ -770,6 +772,7 @@ void Emulator::stepRange(u32 from, u32 to)
 
 void dc_loadstate(Deserializer& deser)
 {
+	aica::sync();
 	custom_texture.Terminate();
 #if FEAT_AREC == DYNAREC_JIT
 	aica::arm::recompiler::flush();
@@ -887,10 +890,12 @@ void Emulator::start()
 						if (!ggpo::nextFrame())
 							break;
 					}
+					aica::sync();
 					TermAudio();
 				} catch (...) {
 					setNetworkState(false);
 					sh4_cpu.Stop();
+					aica::sync();
 					TermAudio();
 					throw;
 				}
@@ -939,6 +944,7 @@ bool Emulator::render()
 		if (stopRequested)
 		{
 			stopRequested = false;
+			aica::sync();
 			TermAudio();
 			nvmem::saveFiles();
 			EventManager::event(Event::Pause);
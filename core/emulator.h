@@ -41,6 +41,8 @@ void dc_loadstate(int index = 0);
 void dc_loadstate(Deserializer& deser);
 time_t dc_getStateCreationDate(int index);
 void dc_getStateScreenshot(int index, std::vector<u8>& pngData);
+// Show the result of savestates written in the background. Called by the UI thread.
+void dc_savestateNotify();
 
 enum class Event {
 	Start,
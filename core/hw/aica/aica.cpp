@@ -7,6 +7,9 @@
 #include "hw/sh4/sh4_sched.h"
 #include "hw/arm7/arm7.h"
 #include "hw/arm7/arm_mem.h"
+#include "benchmark/benchmark.h"
+#include "cfg/option.h"
+#include "stdclass.h"
 
 namespace aica
 {
@@ -15,6 +18,14 @@ namespace aica
 
 std::deque<u8> midiSendBuffer;
 
+static thread_local bool isAicaThread;
+// Set by the aica thread when the SH4 interrupt state needs to be updated
+static bool sh4IntsChanged;
+
+bool onAicaThread() {
+	return isAicaThread;
+}
+
 //Interrupts
 //arm side
 static u32 GetL(u32 which)
@@ -65,6 +76,12 @@ static void update_arm_interrupts()
 static bool UpdateSh4Ints()
 {
 	u32 p_ints = MCIEB->full & MCIPD->full;
+	if (isAicaThread)
+	{
+		// The emulator thread raises or cancels the interrupt when it syncs with the aica thread
+		sh4IntsChanged = true;
+		return p_ints != 0;
+	}
 	if (p_ints)
 	{
 		if ((SB_ISTEXT & SH4_IRQ_BIT) == 0)
@@ -84,9 +101,50 @@ AicaTimer timers[3];
 int aica_schid = -1;
 const int AICA_TICK = 145125;	// 44.1 KHz / 32
 
+//
+// Threaded audio.
+// Each timeslice of the ARM7, sound generation and DSP runs on the aica thread while the SH4
+// runs the same timeslice. The emulator thread waits for the aica thread before accessing
+// the aica registers, before accessing aica ram through the memory handlers or G2 DMA, and
+// before starting the next timeslice.
+// The SH4 interrupts and MIDI output of the aica thread are applied when syncing, so they
+// can be delivered up to one timeslice (32 samples) late. Aica ram reads that the
+// recompiler performs directly in the host address space aren't synced either.
+// The emulation is therefore not deterministic in this mode, which is why netplay disables it.
+//
+static WorkerThread aicaThread("AICA");
+static bool aicaThreadBusy;
+
+void sync()
+{
+	if (!aicaThreadBusy || isAicaThread)
+		return;
+	aicaThread.flush();
+	aicaThreadBusy = false;
+	if (sh4IntsChanged)
+	{
+		sh4IntsChanged = false;
+		UpdateSh4Ints();
+	}
+	flushMidiOut();
+}
+
 static int AicaUpdate(int tag, int cycles, int jitter, void *arg)
 {
-	arm::run(32);
+	sync();
+	// Netplay requires a deterministic emulation, and the disc must only be read by the emulator thread
+	if (config::ThreadedAudio && !config::GGPOEnable && !sgc::readsCddaSector(32))
+	{
+		aicaThreadBusy = true;
+		aicaThread.run([]() {
+			isAicaThread = true;
+			arm::run(32);
+		});
+	}
+	else
+	{
+		arm::run(32);
+	}
 
 	return AICA_TICK;
 }
@@ -95,6 +153,7 @@ static int AicaUpdate(int tag, int cycles, int jitter, void *arg)
 
 void timeStep()
 {
+	BENCH_SCOPE(Aica);
 	for (auto& timer : timers)
 		timer.StepTimer(1);
 
@@ -238,6 +297,7 @@ template void writeTimerAndIntReg<>(u32 reg, u32 data);
 
 void midiSend(u8 data)
 {
+	sync();
 	midiSendBuffer.push_back(data);
 	SCIPD->MIDI_IN = 1;
 	update_arm_interrupts();
@@ -258,6 +318,7 @@ void init()
 
 void reset(bool hard)
 {
+	sync();
 	if (hard)
 	{
 		initMem();
@@ -273,6 +334,8 @@ void reset(bool hard)
 
 void term()
 {
+	sync();
+	aicaThread.stop();
 	arm::term();
 	sgc::term();
 	termMem();
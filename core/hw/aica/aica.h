@@ -327,6 +327,9 @@ extern const DSP_OUT_VOL_REG * const dsp_out_vol;
 template<typename T>
 void writeTimerAndIntReg(u32 reg, T data);
 
+// Whether the caller is the thread running the aica in threaded audio mode
+bool onAicaThread();
+
 class AicaTimer
 {
 	struct AicaTimerData
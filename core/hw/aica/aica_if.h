@@ -16,6 +16,8 @@ void init();
 void reset(bool hard);
 void term();
 void timeStep();
+// Wait for the aica thread to complete the current timeslice
+void sync();
 void serialize(Serializer& ser);
 void deserialize(Deserializer& deser);
 
@@ -5,6 +5,8 @@
 #include "sgc_if.h"
 #include "hw/hwreg.h"
 
+#include <vector>
+
 namespace aica
 {
 
@@ -23,6 +25,8 @@ InterruptInfo * const MCIRE = (InterruptInfo *)&aica_reg[MCIRE_addr];
 DSP_OUT_VOL_REG const * const dsp_out_vol = (DSP_OUT_VOL_REG *)&aica_reg[0x2000];
 
 static void (*midiReceiver)(u8 data);
+// MIDI output of the aica thread, delivered when the emulator thread syncs with it
+static std::vector<u8> midiOutBuffer;
 
 //Aica read/write (both sh4 & arm)
 
@@ -93,7 +97,12 @@ static void writeCommonReg8(u32 reg, u8 data)
 	}
 	else if (reg == 0x280c) {	// MOBUF
 		if (midiReceiver != nullptr)
-			midiReceiver(data);
+		{
+			if (onAicaThread())
+				midiOutBuffer.push_back(data);
+			else
+				midiReceiver(data);
+		}
 	}
 }
 
@@ -209,10 +218,22 @@ void initMem()
 	aica_ram[ARAM_SIZE - 1] = 1;
 	aica_ram.zero();
 	midiReceiver = nullptr;
+	midiOutBuffer.clear();
 }
 
 void termMem()
 {
+	midiOutBuffer.clear();
+}
+
+void flushMidiOut()
+{
+	if (midiOutBuffer.empty())
+		return;
+	if (midiReceiver != nullptr)
+		for (u8 data : midiOutBuffer)
+			midiReceiver(data);
+	midiOutBuffer.clear();
 }
 
 void setMidiReceiver(void (*handler)(u8 data)) {
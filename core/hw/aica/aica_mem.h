@@ -9,6 +9,7 @@ template<typename T> void writeRegInternal(u32 addr, T data);
 
 void initMem();
 void termMem();
+void flushMidiOut();
 
 alignas(4) extern u8 aica_reg[0x8000];
 
@@ -545,99 +545,52 @@ struct ChannelEx
 		return rv;
 	}
 
-	bool Step(SampleType& oLeft, SampleType& oRight, SampleType& oDsp)
+	// Interpolated and low-pass filtered sample of an enabled channel
+	SampleType FilteredSample()
 	{
-		if (!enabled)
-		{
-			oLeft=oRight=oDsp=0;
-			return false;
-		}
-		else
-		{
-			SampleType sample = InterpolateSample();
-
-			// Low-pass filter
-			if (FEG.active)
-			{
-				u32 fv = FEG.GetValue();
-				s32 f = (((fv & 0x1FF) | 0x200) << 3) >> ((fv >> 9) ^ 0xF);
-				if (f == 0) {
-					sample = 0;
-				}
-				else
-				{
-					sample = f * sample + (0x2000 - f + FEG.q) * FEG.prev1 - FEG.q * FEG.prev2;
-					sample >>= 13;
-					sample = std::clamp(sample, -32768, 32767);
-				}
-				FEG.prev2 = FEG.prev1;
-				FEG.prev1 = sample;
-			}
+		SampleType sample = InterpolateSample();
 
-			//Volume & Mixer processing
-			//All attenuations are added together then applied and mixed :)
-
-			//offset is up to 511
-			//*Att is up to 511
-			//logtable handles up to 1024, anything >=255 is mute
-
-			u32 ofsatt;
-			if (ccd->VOFF == 1)
-			{
-				ofsatt = 0;
+		if (FEG.active)
+		{
+			u32 fv = FEG.GetValue();
+			s32 f = (((fv & 0x1FF) | 0x200) << 3) >> ((fv >> 9) ^ 0xF);
+			if (f == 0) {
+				sample = 0;
 			}
 			else
 			{
-				ofsatt = lfo.alfo + (AEG.GetValue() >> 2);
-				ofsatt = std::min(ofsatt, (u32)255); // make sure it never gets more 255 -- it can happen with some alfo/aeg combinations
+				sample = f * sample + (0x2000 - f + FEG.q) * FEG.prev1 - FEG.q * FEG.prev2;
+				sample >>= 13;
+				sample = std::clamp(sample, -32768, 32767);
 			}
-			u32 const max_att = ((16 << 4) - 1) - ofsatt;
-			
-			s32* logtable = ofsatt + tl_lut;
-
-			u32 dl = std::min(VolMix.DLAtt, max_att);
-			u32 dr = std::min(VolMix.DRAtt, max_att);
-			u32 ds = std::min(VolMix.DSPAtt, max_att);
-
-			oLeft = FPMul(sample, logtable[dl], 15);
-			oRight = FPMul(sample, logtable[dr], 15);
-			oDsp = FPMul(sample, logtable[ds], 11);	// 20 bits
-
-			clip_verify(((s16)oLeft)==oLeft);
-			clip_verify(((s16)oRight)==oRight);
-			clip_verify((oDsp << 12) >> 12 == oDsp);
-			clip_verify(sample*oLeft>=0);
-			clip_verify(sample*oRight>=0);
-			clip_verify((s64)sample*oDsp>=0);
-
-			StepAEG(this);
-			StepFEG(this);
-			StepStream(this);
-			lfo.Step(this);
-			return true;
+			FEG.prev2 = FEG.prev1;
+			FEG.prev1 = sample;
 		}
+		return sample;
 	}
 
-	void Step(SampleType& mixl, SampleType& mixr)
+	// AEG and ALFO attenuation, added to the send levels
+	u32 OffsetAttenuation()
 	{
-		SampleType oLeft,oRight,oDsp;
-
-		Step(oLeft, oRight, oDsp);
-
-		*VolMix.DSPOut += oDsp;
-		if (oLeft + oRight == 0 && !config::DSPEnabled)
-			oLeft = oRight = oDsp >> 4;
-
-		mixl+=oLeft;
-		mixr+=oRight;
+		if (ccd->VOFF == 1)
+			return 0;
+		u32 ofsatt = lfo.alfo + (AEG.GetValue() >> 2);
+		// make sure it never gets more 255 -- it can happen with some alfo/aeg combinations
+		return std::min(ofsatt, (u32)255);
 	}
 
-	static void StepAll(SampleType& mixl, SampleType& mixr)
+	// Advance the envelopes, sample position and LFO by one sample
+	void StepState()
 	{
-		for (ChannelEx& channel : Chans)
-			channel.Step(mixl, mixr);
+		StepAEG(this);
+		if (FEG.active)
+			StepFEG(this);
+		StepStream(this);
+		lfo.Step(this);
 	}
 
+	static void StepAll(SampleType& mixl, SampleType& mixr);
+
 	void SetAegState(_EG_state newstate)
 	{
 		StepAEG=AEG_STEP_LUT[newstate];
@@ -952,6 +905,107 @@ struct ChannelEx
 	}
 };
 
+//
+// The enabled channels are processed in stages, one for all channels at a time.
+// Their samples and attenuations are stored in separate arrays so that the
+// volume and mixing loops don't touch the channel state and can be vectorized.
+//
+struct ChannelMixer
+{
+	u32 count;
+	ChannelEx *channels[64];
+	alignas(16) SampleType sample[64];
+	alignas(16) u32 ofsatt[64];
+	alignas(16) u32 attLeft[64];
+	alignas(16) u32 attRight[64];
+	alignas(16) u32 attDsp[64];
+	alignas(16) SampleType left[64];
+	alignas(16) SampleType right[64];
+	alignas(16) SampleType dsp[64];
+
+	void generate()
+	{
+		count = 0;
+		for (ChannelEx& channel : ChannelEx::Chans)
+		{
+			if (!channel.enabled)
+				continue;
+			channels[count] = &channel;
+			sample[count] = channel.FilteredSample();
+			ofsatt[count] = channel.OffsetAttenuation();
+			attLeft[count] = channel.VolMix.DLAtt;
+			attRight[count] = channel.VolMix.DRAtt;
+			attDsp[count] = channel.VolMix.DSPAtt;
+			count++;
+		}
+	}
+
+	//Volume & Mixer processing
+	//All attenuations are added together then applied and mixed :)
+	//offset is up to 511
+	//*Att is up to 511
+	//logtable handles up to 1024, anything >=255 is mute
+	void applyVolume()
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			const u32 maxAtt = ((16 << 4) - 1) - ofsatt[i];
+			attLeft[i] = ofsatt[i] + std::min(attLeft[i], maxAtt);
+			attRight[i] = ofsatt[i] + std::min(attRight[i], maxAtt);
+			attDsp[i] = ofsatt[i] + std::min(attDsp[i], maxAtt);
+		}
+		for (u32 i = 0; i < count; i++)
+		{
+			left[i] = FPMul(sample[i], tl_lut[attLeft[i]], 15);
+			right[i] = FPMul(sample[i], tl_lut[attRight[i]], 15);
+			dsp[i] = FPMul(sample[i], tl_lut[attDsp[i]], 11);	// 20 bits
+
+			clip_verify(((s16)left[i]) == left[i]);
+			clip_verify(((s16)right[i]) == right[i]);
+			clip_verify((dsp[i] << 12) >> 12 == dsp[i]);
+			clip_verify(sample[i] * left[i] >= 0);
+			clip_verify(sample[i] * right[i] >= 0);
+			clip_verify((s64)sample[i] * dsp[i] >= 0);
+		}
+	}
+
+	void mix(SampleType& mixl, SampleType& mixr)
+	{
+		for (u32 i = 0; i < count; i++)
+			*channels[i]->VolMix.DSPOut += dsp[i];
+		if (!config::DSPEnabled)
+		{
+			for (u32 i = 0; i < count; i++)
+				if (left[i] + right[i] == 0)
+					left[i] = right[i] = dsp[i] >> 4;
+		}
+		SampleType l = 0;
+		SampleType r = 0;
+		for (u32 i = 0; i < count; i++)
+		{
+			l += left[i];
+			r += right[i];
+		}
+		mixl += l;
+		mixr += r;
+	}
+
+	void step()
+	{
+		for (u32 i = 0; i < count; i++)
+			channels[i]->StepState();
+	}
+};
+static ChannelMixer channelMixer;
+
+void ChannelEx::StepAll(SampleType& mixl, SampleType& mixr)
+{
+	channelMixer.generate();
+	channelMixer.applyVolume();
+	channelMixer.mix(mixl, mixr);
+	channelMixer.step();
+}
+
 static SampleType DecodeADPCM(u32 sample,s32 prev,s32& quant)
 {
 	s32 sign=1-2*(sample/8);
@@ -1457,6 +1511,7 @@ void ReadCommonReg(u32 reg,bool byte)
 
 void vmuBeep(int on, int period)
 {
+	aica::sync();
 	beep.update(on, period);
 }
 
@@ -1464,6 +1519,10 @@ constexpr int CDDA_SIZE = 2352 / 2;
 static s16 cdda_sector[CDDA_SIZE];
 static u32 cdda_index = CDDA_SIZE;
 
+bool readsCddaSector(u32 samples) {
+	return cdda_index + samples * 2 > CDDA_SIZE;
+}
+
 void AICA_Sample()
 {
 	SampleType mixl,mixr;
@@ -5,6 +5,8 @@ namespace aica::sgc
 {
 
 void AICA_Sample();
+// Whether a CDDA sector will be read during the next samples
+bool readsCddaSector(u32 samples);
 
 void WriteChannelReg(u32 channel, u32 reg, int size);
 
@@ -1,6 +1,7 @@
 #include "arm7.h"
 #include "arm_mem.h"
 #include "arm7_rec.h"
+#include "benchmark/benchmark.h"
 
 namespace aica::arm
 {
@@ -81,6 +82,7 @@ void avoidRaceCondition()
 
 void run(u32 samples)
 {
+	BENCH_SCOPE(Arm7);
 	for (u32 i = 0; i < samples; i++)
 	{
 		runInterpreter(ARM_CYCLES_PER_SAMPLE);
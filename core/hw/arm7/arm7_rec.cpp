@@ -26,6 +26,7 @@
 #include "hw/aica/aica_if.h"
 #include "oslib/virtmem.h"
 #include "arm_mem.h"
+#include "benchmark/benchmark.h"
 
 #if 0
 // for debug
@@ -742,6 +743,7 @@ void *getMemOp(bool Load, bool Byte)
 
 void run(u32 samples)
 {
+	BENCH_SCOPE(Arm7);
 	for (u32 i = 0; i < samples; i++)
 	{
 		if (Arm7Enabled)
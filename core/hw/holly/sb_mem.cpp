@@ -123,6 +123,7 @@ T DYNACALL ReadMem_area0(u32 paddr)
 	case 6:
 	case 7:
 		// AICA ram
+		aica::sync();
 		return ReadMemArr<T>(&aica::aica_ram[0], addr & ARAM_MASK);
 
 	default:
@@ -241,6 +242,7 @@ void DYNACALL WriteMem_area0(u32 paddr, T data)
 	case 6:
 	case 7:
 		// AICA ram
+		aica::sync();
 		WriteMemArr(&aica::aica_ram[0], addr & ARAM_MASK, data);
 		return;
 
@@ -6,7 +6,9 @@
 #include "hw/sh4/sh4_mem.h"
 #include "oslib/oslib.h"
 #include "oslib/virtmem.h"
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
 namespace addrspace
 {
@@ -467,8 +469,175 @@ void initMappings()
 			(u32)(ARAM_SIZE / 1_MB), &aica::aica_ram[0]);
 }
 
+//
+// MMU mirror
+//
+u8 *mmu_base;
+static u8 *mmuMirrorBase;
+constexpr u64 MMU_MIRROR_SIZE = 0x100000000ull;
+// Only U0/P0, P1 and P2 are mirrored. P3 and P4 accesses always fault.
+constexpr u32 MMU_MIRROR_END = 0xC0000000;
+// Each mapped page is a separate host mapping, which are limited in number
+constexpr u32 MMU_MIRROR_MAX_PAGES = 16384;
+
+// Mirrored pages are backed by system RAM or by VRAM (64-bit path)
+constexpr u32 RAM_PAGES = RAM_SIZE_MAX / PAGE_SIZE;
+constexpr u32 BACKING_PAGES = RAM_PAGES + VRAM_SIZE_MAX / PAGE_SIZE;
+
+// virtual page -> backing page + 1, or 0 if not mapped
+static u16 mirrorPages[MMU_MIRROR_END / PAGE_SIZE];
+static u32 mirrorPageCount;
+// virtual pages mapped to each backing page. May contain stale entries.
+static std::vector<u32> pageAliases[BACKING_PAGES];
+static bool pageLocked[BACKING_PAGES];
+
+// Returns the backing page of a physical address, or -1 if it can't be mirrored
+static int backingPage(u32 paddr)
+{
+	if (IsOnRam(paddr))
+		return (paddr & RAM_MASK) / PAGE_SIZE;
+	// Only the first vram mirror is write-protected to detect texture updates
+	if ((paddr & 0x1F000000) == 0x04000000 && (paddr >> 29) != 7)
+		return RAM_PAGES + (paddr & VRAM_MASK) / PAGE_SIZE;
+	return -1;
+}
+
+static size_t backingOffset(u32 page)
+{
+	if (page < RAM_PAGES)
+		return MAP_RAM_START_OFFSET + page * PAGE_SIZE;
+	else
+		return MAP_VRAM_START_OFFSET + (page - RAM_PAGES) * PAGE_SIZE;
+}
+
+void mmuMirrorEnable(bool enable)
+{
+#if HOST_CPU == CPU_X64 && FEAT_SHREC == DYNAREC_JIT && defined(FAST_MMU)
+	if (enable && ram_base != nullptr && mmuMirrorBase == nullptr)
+	{
+		mmuMirrorBase = (u8 *)virtmem::reserve_mirror(MMU_MIRROR_SIZE);
+		if (mmuMirrorBase == nullptr)
+			WARN_LOG(VMEM, "MMU mirror reservation failed");
+		else
+			INFO_LOG(VMEM, "MMU mirror reserved at %p", mmuMirrorBase);
+	}
+	if (enable && mmuMirrorBase != nullptr)
+	{
+		if (mmu_base == nullptr)
+		{
+			mmu_base = mmuMirrorBase;
+			mmuMirrorUnmap(0, MMU_MIRROR_END);
+		}
+		return;
+	}
+#endif
+	mmu_base = nullptr;
+}
+
+bool mmuMirrorCanMap(u32 vaddr, u32 paddr)
+{
+	return vaddr < MMU_MIRROR_END && backingPage(paddr) >= 0;
+}
+
+void mmuMirrorMap(u32 vaddr, u32 paddr, u32 pageSize)
+{
+	// The guest page must cover the whole host page
+	if (mmu_base == nullptr || vaddr >= MMU_MIRROR_END || pageSize < PAGE_SIZE)
+		return;
+	const int page = backingPage(paddr);
+	if (page < 0)
+		return;
+	const u32 vpage = vaddr / PAGE_SIZE;
+	if (mirrorPages[vpage] == page + 1)
+		return;
+	if (mirrorPageCount >= MMU_MIRROR_MAX_PAGES)
+	{
+		DEBUG_LOG(VMEM, "MMU mirror full");
+		mmuMirrorUnmap(0, MMU_MIRROR_END);
+	}
+	if (!virtmem::map_mirror(mmu_base + vpage * PAGE_SIZE, backingOffset(page), PAGE_SIZE, !pageLocked[page]))
+		return;
+	if (mirrorPages[vpage] == 0)
+		mirrorPageCount++;
+	std::vector<u32>& aliases = pageAliases[page];
+	aliases.erase(std::remove_if(aliases.begin(), aliases.end(), [page](u32 v) {
+		return mirrorPages[v] != page + 1;
+	}), aliases.end());
+	aliases.push_back(vpage);
+	mirrorPages[vpage] = page + 1;
+}
+
+void mmuMirrorUnmap(u32 vaddr, u32 size)
+{
+	if (mmu_base == nullptr || mirrorPageCount == 0 || vaddr >= MMU_MIRROR_END)
+		return;
+	const u32 start = vaddr / PAGE_SIZE;
+	const u32 end = std::min<u64>(((u64)vaddr + size + PAGE_SIZE - 1) / PAGE_SIZE, MMU_MIRROR_END / PAGE_SIZE);
+	u32 first = end;
+	u32 last = start;
+	for (u32 vpage = start; vpage < end; vpage++)
+	{
+		if (mirrorPages[vpage] != 0)
+		{
+			mirrorPages[vpage] = 0;
+			mirrorPageCount--;
+			if (first == end)
+				first = vpage;
+			last = vpage + 1;
+		}
+	}
+	if (first < last)
+		virtmem::unmap_mirror(mmu_base + first * PAGE_SIZE, (last - first) * PAGE_SIZE);
+}
+
+static void protectPages(u32 firstPage, u32 lastPage, bool locked)
+{
+	for (u32 page = firstPage; page < lastPage; page++)
+	{
+		pageLocked[page] = locked;
+		std::vector<u32>& aliases = pageAliases[page];
+		if (mmu_base == nullptr)
+		{
+			aliases.clear();
+			continue;
+		}
+		for (auto it = aliases.begin(); it != aliases.end(); )
+		{
+			if (mirrorPages[*it] != page + 1)
+			{
+				it = aliases.erase(it);
+				continue;
+			}
+			if (locked)
+				virtmem::region_lock(mmu_base + *it * PAGE_SIZE, PAGE_SIZE);
+			else
+				virtmem::region_unlock(mmu_base + *it * PAGE_SIZE, PAGE_SIZE);
+			++it;
+		}
+	}
+}
+
+void mmuMirrorProtect(u32 ramOffset, u32 size, bool locked)
+{
+	protectPages(ramOffset / PAGE_SIZE, (ramOffset + size) / PAGE_SIZE, locked);
+}
+
+static void mmuMirrorProtectVram(u32 vramOffset, u32 size, bool locked)
+{
+	const u32 first = RAM_PAGES + vramOffset / PAGE_SIZE;
+	protectPages(first, std::min(first + (size + PAGE_SIZE - 1) / PAGE_SIZE, BACKING_PAGES), locked);
+}
+
 void release()
 {
+	if (mmuMirrorBase != nullptr)
+	{
+		virtmem::release_mirror(mmuMirrorBase, MMU_MIRROR_SIZE);
+		mmuMirrorBase = nullptr;
+		mmu_base = nullptr;
+		memset(mirrorPages, 0, sizeof(mirrorPages));
+		mirrorPageCount = 0;
+	}
 	if (ram_base != nullptr)
 	{
 		virtmem::destroy();
@@ -501,6 +670,7 @@ void protectVram(u32 addr, u32 size)
 	{
 		virtmem::region_lock(&vram[addr], size);
 	}
+	mmuMirrorProtectVram(addr, size, true);
 }
 
 void unprotectVram(u32 addr, u32 size)
@@ -523,6 +693,7 @@ void unprotectVram(u32 addr, u32 size)
 	{
 		virtmem::region_unlock(&vram[addr], size);
 	}
+	mmuMirrorProtectVram(addr, size, false);
 }
 
 u32 getVramOffset(void *addr)
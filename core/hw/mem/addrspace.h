@@ -81,4 +81,19 @@ void protectVram(u32 addr, u32 size);
 void unprotectVram(u32 addr, u32 size);
 u32 getVramOffset(void *addr);
 
+// Host mirror of the SH4 virtual address space used by the dynarec when the MMU is enabled.
+// Virtual pages translated to system RAM or VRAM are mapped on demand. Accesses to other pages fault.
+extern u8 *mmu_base;
+
+static inline bool mmuMirrorEnabled() {
+	return mmu_base != nullptr;
+}
+void mmuMirrorEnable(bool enable);
+// Returns false if the virtual page can never be mapped to this physical address in the mirror
+bool mmuMirrorCanMap(u32 vaddr, u32 paddr);
+void mmuMirrorMap(u32 vaddr, u32 paddr, u32 pageSize);
+void mmuMirrorUnmap(u32 vaddr, u32 size);
+// Keeps the mirror in sync with the write protection of RAM pages
+void mmuMirrorProtect(u32 ramOffset, u32 size, bool locked);
+
 } // namespace addrspace
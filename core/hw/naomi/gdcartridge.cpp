@@ -14,6 +14,10 @@
 #include "stdclass.h"
 #include "emulator.h"
 #include "oslib/storage.h"
+#include "cfg/option.h"
+
+#include <atomic>
+#include <thread>
 
 /*
 
@@ -435,6 +439,138 @@ void GDCartridge::find_file(const char *name, const u8 *dir_sector, u32 &file_st
 	}
 }
 
+//
+// ECB mode: all the blocks are independent so they are decrypted in parallel
+//
+void GDCartridge::decrypt(u8 *data, u32 size, u64 key, LoadProgress *progress)
+{
+	constexpr u32 ChunkSize = 64_KB;
+
+	u32 des_subkeys[32];
+	des_generate_subkeys(rev64(key), des_subkeys);
+
+	const u32 chunkCount = (size + ChunkSize - 1) / ChunkSize;
+	std::atomic<u32> nextChunk { 0 };
+	std::atomic<u32> chunksDone { 0 };
+	std::atomic<bool> cancelled { false };
+	auto decryptChunks = [&]() {
+		for (;;)
+		{
+			const u32 chunk = nextChunk++;
+			if (chunk >= chunkCount || cancelled)
+				break;
+			const u32 end = std::min(size, (chunk + 1) * ChunkSize);
+			for (u32 i = chunk * ChunkSize; i < end; i += 8)
+				*(u64 *)(data + i) = des_encrypt_decrypt<true>(*(u64 *)(data + i), des_subkeys);
+			chunksDone++;
+		}
+	};
+	std::vector<std::thread> threads;
+	const u32 threadCount = std::min(chunkCount, std::max(1u, std::thread::hardware_concurrency()));
+	for (u32 i = 1; i < threadCount; i++)
+		threads.emplace_back(decryptChunks);
+
+	// This thread also reports progress and handles cancellation
+	for (;;)
+	{
+		const u32 chunk = nextChunk++;
+		if (chunk < chunkCount && !cancelled)
+		{
+			const u32 end = std::min(size, (chunk + 1) * ChunkSize);
+			for (u32 i = chunk * ChunkSize; i < end; i += 8)
+				*(u64 *)(data + i) = des_encrypt_decrypt<true>(*(u64 *)(data + i), des_subkeys);
+			chunksDone++;
+		}
+		else if (chunksDone == chunkCount || cancelled)
+		{
+			break;
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		if (progress != nullptr)
+		{
+			if (progress->cancelled)
+				cancelled = true;
+			progress->label = "Decrypting...";
+			progress->progress = (float)chunksDone / chunkCount;
+		}
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+	if (cancelled)
+		throw LoadCancelledException();
+}
+
+//
+// Decrypted DIMM image cache
+//
+struct DimmCacheHeader
+{
+	char magic[8];
+	u64 key;
+	u32 fileStart;
+	u32 size;
+	u32 digestSize;
+	u8 digest[32];
+
+	static constexpr const char *MAGIC = "FLYDIMM1";
+};
+
+static bool initCacheHeader(DimmCacheHeader& header, const std::vector<u8>& discDigest, u64 key, u32 fileStart, u32 size)
+{
+	if (discDigest.empty() || discDigest.size() > sizeof(header.digest))
+		return false;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, DimmCacheHeader::MAGIC, sizeof(header.magic));
+	header.key = key;
+	header.fileStart = fileStart;
+	header.size = size;
+	header.digestSize = (u32)discDigest.size();
+	memcpy(header.digest, discDigest.data(), discDigest.size());
+	return true;
+}
+
+bool GDCartridge::loadDecryptedCache(const std::string& path, const std::vector<u8>& discDigest, u64 key, u32 fileStart, u32 size)
+{
+	DimmCacheHeader expected;
+	if (!initCacheHeader(expected, discDigest, key, fileStart, size))
+		return false;
+	FILE *f = nowide::fopen(path.c_str(), "rb");
+	if (f == nullptr)
+		return false;
+	DimmCacheHeader header;
+	bool rc = std::fread(&header, sizeof(header), 1, f) == 1
+			&& memcmp(&header, &expected, sizeof(header)) == 0
+			&& std::fread(dimm_data, 1, size, f) == size;
+	std::fclose(f);
+	if (rc)
+		INFO_LOG(NAOMI, "Loaded decrypted DIMM image from %s", path.c_str());
+	return rc;
+}
+
+void GDCartridge::saveDecryptedCache(const std::string& path, const std::vector<u8>& discDigest, u64 key, u32 fileStart, u32 size)
+{
+	DimmCacheHeader header;
+	if (!initCacheHeader(header, discDigest, key, fileStart, size))
+		return;
+	FILE *f = nowide::fopen(path.c_str(), "wb");
+	if (f == nullptr)
+	{
+		WARN_LOG(NAOMI, "Can't create DIMM cache %s: errno %d", path.c_str(), errno);
+		return;
+	}
+	bool rc = std::fwrite(&header, sizeof(header), 1, f) == 1
+			&& std::fwrite(dimm_data, 1, size, f) == size;
+	std::fclose(f);
+	if (!rc)
+	{
+		WARN_LOG(NAOMI, "Error writing DIMM cache %s", path.c_str());
+		nowide::remove(path.c_str());
+	}
+}
+
 void GDCartridge::read_gdrom(Disc *gdrom, u32 sector, u8* dst, u32 count, LoadProgress *progress)
 {
 	gdrom->ReadSectors(sector + 150, count, dst, 2048, progress);
@@ -496,8 +632,11 @@ void GDCartridge::device_start(LoadProgress *progress, std::vector<u8> *digest)
 		std::string gdrom_path = get_file_basename(settings.content.fileName) + "/" + gdrom_name;
 		gdrom_path = hostfs::storage().getSubPath(parent, gdrom_path);
 		std::unique_ptr<Disc> gdrom;
+		// The digest of CHD files is free so it's always used to identify the cached decrypted image
+		std::vector<u8> chdDigest;
+		std::vector<u8> *discDigest = digest != nullptr ? digest : &chdDigest;
 		try {
-			gdrom = std::unique_ptr<Disc>(OpenDisc(gdrom_path + ".chd", digest));
+			gdrom = std::unique_ptr<Disc>(OpenDisc(gdrom_path + ".chd", discDigest));
 		}
 		catch (const FlycastException& e)
 		{
@@ -511,7 +650,7 @@ void GDCartridge::device_start(LoadProgress *progress, std::vector<u8> *digest)
 				{
 					std::string gdrom_parent_path = hostfs::storage().getSubPath(parent, std::string(gdrom_parent_name) + "/" + gdrom_name);
 					try {
-						gdrom = std::unique_ptr<Disc>(OpenDisc(gdrom_parent_path + ".chd", digest));
+						gdrom = std::unique_ptr<Disc>(OpenDisc(gdrom_parent_path + ".chd", discDigest));
 					} catch (const FlycastException& e) {
 						WARN_LOG(NAOMI, "Opening parent chd failed: %s", e.what());
 						try {
@@ -598,24 +737,18 @@ void GDCartridge::device_start(LoadProgress *progress, std::vector<u8> *digest)
 			if (dimm_data_size != file_rounded_size)
 				memset(dimm_data + file_rounded_size, 0, dimm_data_size - file_rounded_size);
 
-			// read encrypted data into dimm_data
-			u32 sectors = file_rounded_size / 2048;
-			read_gdrom(gdrom.get(), file_start, dimm_data, sectors, progress);
+			const std::string cachePath = get_game_save_prefix() + ".dimm";
+			if (!config::DimmCache || !loadDecryptedCache(cachePath, *discDigest, key, file_start, file_rounded_size))
+			{
+				// read encrypted data into dimm_data
+				u32 sectors = file_rounded_size / 2048;
+				read_gdrom(gdrom.get(), file_start, dimm_data, sectors, progress);
 
-			// decrypt loaded data
-			u32 des_subkeys[32];
-			des_generate_subkeys(rev64(key), des_subkeys);
+				// decrypt loaded data
+				decrypt(dimm_data, file_rounded_size, key, progress);
 
-			for (u32 i = 0; i < file_rounded_size; i += 8)
-			{
-				if ((i & 0xfff) == 0 && progress != nullptr)
-				{
-					if (progress->cancelled)
-						throw LoadCancelledException();
-					progress->label = "Decrypting...";
-					progress->progress = (float)(i + 8) / file_rounded_size;
-				}
-				*(u64 *)(dimm_data + i) = des_encrypt_decrypt<true>(*(u64 *)(dimm_data + i), des_subkeys);
+				if (config::DimmCache)
+					saveDecryptedCache(cachePath, *discDigest, key, file_start, file_rounded_size);
 			}
 		}
 
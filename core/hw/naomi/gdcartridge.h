@@ -70,7 +70,10 @@ private:
 	template<bool decrypt>
 	u64 des_encrypt_decrypt(u64 src, const u32 *des_subkeys);
 	u64 rev64(u64 src);
+	void decrypt(u8 *data, u32 size, u64 key, LoadProgress *progress);
 	void read_gdrom(Disc *gdrom, u32 sector, u8* dst, u32 count = 1, LoadProgress *progress = nullptr);
+	bool loadDecryptedCache(const std::string& path, const std::vector<u8>& discDigest, u64 key, u32 fileStart, u32 size);
+	void saveDecryptedCache(const std::string& path, const std::vector<u8>& discDigest, u64 key, u32 fileStart, u32 size);
 };
 
 #endif /* CORE_HW_NAOMI_GDCARTRIDGE_H_ */
@@ -46,6 +46,16 @@
 #include "systemsp.h"
 #include "hopper.h"
 
+#include <xxhash.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <nowide/convert.hpp>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 Cartridge *CurrentCartridge;
 bool bios_loaded = false;
 
@@ -207,6 +217,50 @@ void naomi_cart_LoadBios(const char *filename)
 	bios_loaded = true;
 }
 
+static bool isRomBlob(BlobType type)
+{
+	return type == Normal || type == InterleavedWord || type == Copy;
+}
+
+// CRC of the file the loader will use for a blob: found by CRC first, then by name
+static u32 blobFileCrc(const Game *game, int blob, Archive *archive, Archive *parentArchive)
+{
+	const u32 blobCrc = game->blobs[blob].crc;
+	if ((archive != nullptr && archive->HasFileCrc(blobCrc))
+			|| (parentArchive != nullptr && parentArchive->HasFileCrc(blobCrc)))
+		return blobCrc;
+	u32 crc = 0;
+	if (archive != nullptr)
+		crc = archive->GetFileCrc(game->blobs[blob].filename);
+	if (crc == 0 && parentArchive != nullptr)
+		crc = parentArchive->GetFileCrc(game->blobs[blob].filename);
+	return crc;
+}
+
+// Identifies the content of the ROM image built from the game archive(s)
+static u64 romCacheHash(const Game *game, Archive *archive, Archive *parentArchive)
+{
+	XXH64_state_t *state = XXH64_createState();
+	XXH64_reset(state, 0);
+	XXH64_update(state, game->name, strlen(game->name));
+	XXH64_update(state, &game->size, sizeof(game->size));
+	for (int i = 0; game->blobs[i].filename != nullptr; i++)
+	{
+		if (!isRomBlob(game->blobs[i].blob_type))
+			continue;
+		// Blobs may be found by name if the CRC doesn't match so the CRC of the file actually read
+		// is used. Clones load some of their blobs from the parent archive.
+		const u32 fileCrc = game->blobs[i].blob_type == Copy ? 0
+				: blobFileCrc(game, i, archive, parentArchive);
+		const u32 blob[] { game->blobs[i].offset, game->blobs[i].length, fileCrc,
+			(u32)game->blobs[i].blob_type, game->blobs[i].src_offset };
+		XXH64_update(state, blob, sizeof(blob));
+	}
+	u64 hash = XXH64_digest(state);
+	XXH64_freeState(state);
+	return hash;
+}
+
 static void loadMameRom(const std::string& path, const std::string& fileName, LoadProgress *progress)
 {
 	const Game *game = FindGame(fileName.c_str());
@@ -219,9 +273,10 @@ static void loadMameRom(const std::string& path, const std::string& fileName, Lo
 		INFO_LOG(NAOMI, "Opened %s", path.c_str());
 
 	std::unique_ptr<Archive> parent_archive;
+	std::string parentPath;
 	if (game->parent_name != nullptr)
 	{
-		std::string parentPath = hostfs::storage().getParentPath(path);
+		parentPath = hostfs::storage().getParentPath(path);
 		parentPath = hostfs::storage().getSubPath(parentPath, game->parent_name);
 		parent_archive.reset(OpenArchive(parentPath));
 		if (parent_archive != nullptr)
@@ -286,6 +341,18 @@ static void loadMameRom(const std::string& path, const std::string& fileName, Lo
 		NaomiGameInputs = game->inputs;
 		CurrentCartridge->game = game;
 
+		// The cached image isn't used with GGPO since the ROM content must be hashed
+		const bool useRomCache = config::NaomiRomCache && !config::GGPOEnable && game->cart_type != GD;
+		std::string romCachePath;
+		u64 romHash = 0;
+		bool romCached = false;
+		if (useRomCache)
+		{
+			romCachePath = get_game_save_prefix() + ".rom";
+			romHash = romCacheHash(game, archive.get(), parent_archive.get());
+			romCached = CurrentCartridge->MapRomCache(romCachePath, romHash);
+		}
+
 		MD5Sum md5;
 
 		int romCount = 0;
@@ -306,6 +373,9 @@ static void loadMameRom(const std::string& path, const std::string& fileName, Lo
 				}
 			}
 
+			if (romCached && isRomBlob(game->blobs[romid].blob_type))
+				continue;
+
 			u32 len = game->blobs[romid].length;
 
 			if (game->blobs[romid].blob_type == Copy)
@@ -418,6 +488,8 @@ static void loadMameRom(const std::string& path, const std::string& fileName, Lo
 				}
 			}
 		}
+		if (useRomCache && !romCached)
+			CurrentCartridge->SaveRomCache(romCachePath, romHash);
 		if (naomi_default_eeprom == NULL && game->eeprom_dump != NULL)
 			naomi_default_eeprom = game->eeprom_dump;
 		if (game->rotation_flag == ROT270)
@@ -820,10 +892,125 @@ Cartridge::Cartridge(u32 size)
 
 Cartridge::~Cartridge()
 {
-	if (RomPtr != NULL)
+	if (romMapped)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(RomPtr);
+#else
+		munmap(RomPtr, RomSize);
+#endif
+	}
+	else if (RomPtr != NULL)
 		free(RomPtr);
 }
 
+//
+// ROM cache file: ROM image followed by a trailer, so that the image starts at offset 0 and can be mapped directly
+//
+struct RomCacheTrailer
+{
+	char magic[8];
+	u64 hash;
+	u32 size;
+	u32 _pad = 0;
+
+	static constexpr const char *MAGIC = "FLYROM01";
+
+	RomCacheTrailer() = default;
+	RomCacheTrailer(u64 hash, u32 size) : hash(hash), size(size) {
+		memcpy(magic, MAGIC, sizeof(magic));
+	}
+	bool operator==(const RomCacheTrailer& other) const {
+		return !memcmp(magic, other.magic, sizeof(magic)) && hash == other.hash && size == other.size;
+	}
+};
+
+bool Cartridge::MapRomCache(const std::string& path, u64 hash)
+{
+	if (RomSize == 0)
+		return false;
+	FILE *f = nowide::fopen(path.c_str(), "rb");
+	if (f == nullptr)
+		return false;
+	RomCacheTrailer trailer;
+	bool valid = std::fseek(f, 0, SEEK_END) == 0
+			&& std::ftell(f) == (long)(RomSize + sizeof(RomCacheTrailer))
+			&& std::fseek(f, RomSize, SEEK_SET) == 0
+			&& std::fread(&trailer, sizeof(trailer), 1, f) == 1
+			&& trailer == RomCacheTrailer(hash, RomSize);
+	std::fclose(f);
+	if (!valid)
+		return false;
+
+	// Private mapping: pages are shared with other processes until written to (System SP flash)
+	void *p = nullptr;
+#ifdef _WIN32
+	HANDLE file = CreateFileW(nowide::widen(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping != NULL)
+		{
+			p = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, RomSize);
+			CloseHandle(mapping);
+		}
+	}
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd >= 0)
+	{
+		p = mmap(nullptr, RomSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (p == MAP_FAILED)
+			p = nullptr;
+	}
+#endif
+	if (p == nullptr)
+	{
+		WARN_LOG(NAOMI, "Can't map ROM cache %s", path.c_str());
+		return false;
+	}
+	free(RomPtr);
+	RomPtr = (u8 *)p;
+	romMapped = true;
+	INFO_LOG(NAOMI, "Mapped ROM cache %s", path.c_str());
+
+	return true;
+}
+
+void Cartridge::SaveRomCache(const std::string& path, u64 hash) const
+{
+	// Write to a temporary file so that other instances never map a partial image.
+	// The pid keeps instances started at the same time from writing to the same file.
+#ifdef _WIN32
+	const std::string tmpPath = path + "." + std::to_string(GetCurrentProcessId()) + ".tmp";
+#else
+	const std::string tmpPath = path + "." + std::to_string(getpid()) + ".tmp";
+#endif
+	FILE *f = nowide::fopen(tmpPath.c_str(), "wb");
+	if (f == nullptr)
+	{
+		WARN_LOG(NAOMI, "Can't create ROM cache %s: errno %d", tmpPath.c_str(), errno);
+		return;
+	}
+	RomCacheTrailer trailer(hash, RomSize);
+	bool rc = std::fwrite(RomPtr, 1, RomSize, f) == RomSize
+			&& std::fwrite(&trailer, sizeof(trailer), 1, f) == 1;
+	rc = std::fclose(f) == 0 && rc;
+	if (rc)
+	{
+		nowide::remove(path.c_str());
+		rc = nowide::rename(tmpPath.c_str(), path.c_str()) == 0;
+	}
+	if (!rc)
+	{
+		WARN_LOG(NAOMI, "Error writing ROM cache %s", path.c_str());
+		nowide::remove(tmpPath.c_str());
+	}
+}
+
 bool Cartridge::Read(u32 offset, u32 size, void* dst)
 {
 	offset &= 0x1FFFFFFF;
@@ -71,11 +71,18 @@ public:
 	virtual void SetKeyData(u8 *key_data) { }
 	virtual bool GetBootId(RomBootID *bootId) = 0;
 
+	// Uncompressed ROM image cache, mapped copy-on-write so that several instances share the same pages
+	bool MapRomCache(const std::string& path, u64 hash);
+	void SaveRomCache(const std::string& path, u64 hash) const;
+
 	const Game *game = nullptr;
 
 protected:
 	u8* RomPtr;
 	u32 RomSize;
+
+private:
+	bool romMapped = false;
 };
 
 class NaomiCartridge : public Cartridge
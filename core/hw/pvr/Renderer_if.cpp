@@ -1,5 +1,6 @@
 #include "Renderer_if.h"
 #include "spg.h"
+#include "ta.h"
 #include "rend/TexCache.h"
 #include "rend/transform_matrix.h"
 #include "cfg/option.h"
@@ -8,6 +9,7 @@
 #include "hw/holly/holly_intc.h"
 #include "hw/sh4/sh4_if.h"
 #include "profiler/fc_profiler.h"
+#include "benchmark/benchmark.h"
 #include "network/ggpo.h"
 
 #include <mutex>
@@ -175,6 +177,7 @@ private:
 	void render()
 	{
 		FC_PROFILE_SCOPE;
+		BENCH_SCOPE(RendererPrep);
 
 		_pvrrc = DequeueRender();
 		if (_pvrrc == nullptr)
@@ -272,14 +275,21 @@ Renderer* rend_OITVulkan();
 Renderer* rend_DirectX9();
 Renderer* rend_DirectX11();
 Renderer* rend_OITDirectX11();
+Renderer* rend_software();
 
 static void rend_create_renderer()
 {
 #ifdef NO_REND
-	renderer	 = rend_norend();
+	if (config::RendererType == RenderType::Software)
+		renderer = rend_software();
+	else
+		renderer = rend_norend();
 #else
 	switch (config::RendererType)
 	{
+	case RenderType::Software:
+		renderer = rend_software();
+		break;
 	default:
 #ifdef USE_OPENGL
 	case RenderType::OpenGL:
@@ -387,6 +397,7 @@ void rend_start_render()
 	if (ctx == nullptr)
 		return;
 
+	ctx->preparsed = ta_pipeline_finish(ctx);
 	FillBGP(ctx);
 
 	ctx->rend.isRTT = (FB_W_SOF1 & 0x1000000) != 0;
@@ -2,6 +2,8 @@
 #include "ta_ctx.h"
 #include "hw/holly/holly_intc.h"
 #include "pvr_mem.h"
+#include "benchmark/benchmark.h"
+#include "cfg/option.h"
 
 /*
 	Threaded TA Implementation
@@ -509,6 +511,7 @@ void ta_vtx_ListInit(bool continuation)
 		taRenderPass = 0;
 	else
 		taRenderPass++;
+	ta_pipeline_stop();
 	SetCurrentTARC(TA_OL_BASE);
 	ta_tad.ClearPartial();
 	markObjectListBlocks(taRenderPass);
@@ -517,10 +520,14 @@ void ta_vtx_ListInit(bool continuation)
 	ta_fsm_cl = 7;
 	if (settings.platform.isNaomi2())
 		ta_parse_reset();
+	else if (config::PipelinedTAParsing && !continuation)
+		ta_pipeline_begin(ta_ctx);
 }
 
 void ta_vtx_SoftReset()
 {
+	// The data parsed so far won't be part of the next list
+	ta_pipeline_stop();
 	ta_cur_state = TAS_NS;
 }
 
@@ -547,6 +554,8 @@ static void DYNACALL ta_thd_data32_i(const simd256_t *data)
 	*dst = *data;
 
 	ta_tad.thd_data += 32;
+	if (ta_pipeline_active)
+		ta_pipeline_push(ta_tad.thd_data);
 
 	//process TA state
 	u32 state_in = (ta_cur_state << 8) | (pcw.ParaType << 5) | ((pcw.obj_ctrl >> 2) & 31);
@@ -573,6 +582,7 @@ void DYNACALL ta_vtx_data32(const SQBuffer *data)
 
 void ta_vtx_data(const SQBuffer *data, u32 size)
 {
+	BENCH_SCOPE(Ta);
 	while (size >= 4)
 	{
 		ta_thd_data32_i((simd256_t *)data);
@@ -16,6 +16,14 @@ void ta_vtx_data(const SQBuffer *data, u32 size);
 
 void ta_parse(TA_context *ctx, bool primRestart);
 
+// Pipelined TA parsing
+extern bool ta_pipeline_active;
+void ta_pipeline_begin(TA_context *ctx);
+void ta_pipeline_push(u8 *dataEnd);
+// Returns true if the display lists of the context are ready
+bool ta_pipeline_finish(TA_context *ctx);
+void ta_pipeline_stop();
+
 class TaTypeLut
 {
 public:
@@ -1,4 +1,5 @@
 #include "ta_ctx.h"
+#include "ta.h"
 #include "spg.h"
 #include "cfg/option.h"
 #include "Renderer_if.h"
@@ -198,6 +199,7 @@ TA_context *tactx_Pop(u32 addr)
 
 void tactx_Term()
 {
+	ta_pipeline_stop();
 	if (ta_ctx != nullptr)
 		SetCurrentTARC(TACTX_NONE);
 
@@ -272,6 +274,7 @@ void SerializeTAContext(Serializer& ser)
 
 void DeserializeTAContext(Deserializer& deser)
 {
+	ta_pipeline_stop();
 	if (::ta_ctx != nullptr)
 		SetCurrentTARC(TACTX_NONE);
 	if (deser.version() >= Deserializer::V25)
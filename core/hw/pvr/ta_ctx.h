@@ -326,6 +326,8 @@ struct TA_context
 	rend_context rend;
 
 	TA_context *nextContext = nullptr;
+	// The display lists have been parsed by the TA pipeline
+	bool preparsed = false;
 	/*
 		Dreamcast games use up to 20k vtx, 30k idx, 1k (in total) parameters.
 		at 30 fps, thats 600kvtx (900 stripped)
@@ -376,6 +378,7 @@ struct TA_context
 		verify(tad.End() - tad.thd_root <= (ptrdiff_t)TA_DATA_SIZE);
 		tad.Clear();
 		nextContext = nullptr;
+		preparsed = false;
 		rend.Clear();
 	}
 
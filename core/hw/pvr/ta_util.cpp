@@ -19,6 +19,7 @@
 #include "ta_ctx.h"
 #include "pvr_mem.h"
 #include <algorithm>
+#include <cstring>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
@@ -52,9 +53,77 @@ static float minZ(const Vertex *v, const u32 *mod)
 	return std::min(std::min(v[mod[0]].z, v[mod[1]].z), v[mod[2]].z);
 }
 
-static bool operator<(const IndexTrig& left, const IndexTrig& right)
+// Map a float to an unsigned int with the same ordering
+static u32 sortableKey(f32 z)
 {
-	return left.z < right.z;
+	// -0 and +0 must compare equal
+	z += 0.f;
+	u32 u;
+	memcpy(&u, &z, sizeof(u));
+	return (u & 0x80000000) ? ~u : u | 0x80000000;
+}
+
+//
+// Stable LSD radix sort of the triangles by z, 11 bits per pass.
+// Returns the sorted order as indices into triangles.
+//
+static void radixSort(const std::vector<IndexTrig>& triangles, std::vector<u32>& order)
+{
+	constexpr u32 Bits = 11;
+	constexpr u32 Buckets = 1 << Bits;
+	constexpr u32 Passes = (32 + Bits - 1) / Bits;
+	static std::vector<u32> keys[2];
+	static std::vector<u32> indices[2];
+	static u32 histogram[Passes][Buckets];
+
+	const u32 size = triangles.size();
+	if (size == 0)
+	{
+		order.clear();
+		return;
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		keys[i].resize(size);
+		indices[i].resize(size);
+	}
+	memset(histogram, 0, sizeof(histogram));
+	for (u32 i = 0; i < size; i++)
+	{
+		const u32 key = sortableKey(triangles[i].z);
+		keys[0][i] = key;
+		indices[0][i] = i;
+		for (u32 pass = 0; pass < Passes; pass++)
+			histogram[pass][(key >> (pass * Bits)) & (Buckets - 1)]++;
+	}
+	int cur = 0;
+	for (u32 pass = 0; pass < Passes; pass++)
+	{
+		u32 *counts = histogram[pass];
+		const u32 shift = pass * Bits;
+		// Nothing to do if all the keys have the same digit
+		if (counts[(keys[cur][0] >> shift) & (Buckets - 1)] == size)
+			continue;
+		u32 offset = 0;
+		for (u32 b = 0; b < Buckets; b++)
+		{
+			const u32 count = counts[b];
+			counts[b] = offset;
+			offset += count;
+		}
+		const u32 *srcKeys = keys[cur].data();
+		const u32 *srcIndices = indices[cur].data();
+		u32 *dstKeys = keys[cur ^ 1].data();
+		u32 *dstIndices = indices[cur ^ 1].data();
+		for (u32 i = 0; i < size; i++)
+		{
+			const u32 pos = counts[(srcKeys[i] >> shift) & (Buckets - 1)]++;
+			dstKeys[pos] = srcKeys[i];
+			dstIndices[pos] = srcIndices[i];
+		}
+		cur ^= 1;
+	}
+	order.swap(indices[cur]);
 }
 
 static float getProjectedZ(const Vertex *v, const float *mat)
@@ -130,7 +199,29 @@ void sortTriangles(rend_context& ctx, RenderPass& pass, const RenderPass& previo
 	}
 
 	//sort them
-	std::stable_sort(triangleList.begin(), triangleList.end());
+	// The sorted order is kept for each pass and reused as long as its triangles don't change
+	struct SortedOrder
+	{
+		std::vector<IndexTrig> triangles;
+		std::vector<u32> order;
+	};
+	static std::vector<SortedOrder> sortedOrders;
+	static std::vector<IndexTrig> sortedList;
+
+	const size_t passIndex = &pass - ctx.render_passes.data();
+	if (passIndex >= sortedOrders.size())
+		sortedOrders.resize(passIndex + 1);
+	SortedOrder& sorted = sortedOrders[passIndex];
+	if (sorted.triangles.size() != triangleList.size()
+			|| memcmp(sorted.triangles.data(), triangleList.data(), triangleList.size() * sizeof(IndexTrig)) != 0)
+	{
+		radixSort(triangleList, sorted.order);
+		sorted.triangles.swap(triangleList);
+	}
+	sortedList.resize(sorted.order.size());
+	for (size_t i = 0; i < sorted.order.size(); i++)
+		sortedList[i] = sorted.triangles[sorted.order[i]];
+	triangleList.swap(sortedList);
 
 	//Merge pids/draw cmds if two different pids are actually equal
 	for (size_t k = 1; k < triangleList.size(); k++)
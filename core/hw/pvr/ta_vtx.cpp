@@ -9,11 +9,21 @@
 #include "pvr_mem.h"
 #include "Renderer_if.h"
 #include "cfg/option.h"
+#include "benchmark/benchmark.h"
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <utility>
 
-#define TACALL DYNACALL
+#if HOST_CPU == CPU_X64 || ((HOST_CPU == CPU_X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#include <emmintrin.h>
+#define TA_SSE2
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define TA_NEON
+#endif
+
 #ifdef NDEBUG
 #undef verify
 #define verify(x)
@@ -25,7 +35,36 @@ static u8 float_to_satu8(float val) {
 	return f32_su8_tbl[(u32&)val >> 16];
 }
 
-static TA_context *vd_ctx;
+//
+// Convert 4 float color components to u8 like float_to_satu8.
+// Returns the components in the low to high bytes.
+// Only the upper 16 bits of each float are used so that the result is identical to the table lookup.
+//
+static u32 float4_to_satu8(const f32 *v)
+{
+#if defined(TA_SSE2)
+	__m128 f = _mm_castsi128_ps(_mm_and_si128(_mm_loadu_si128((const __m128i *)v), _mm_set1_epi32(0xffff0000)));
+	const __m128i nan = _mm_castps_si128(_mm_cmpunord_ps(f, f));
+	// max returns the second operand if either is NaN
+	f = _mm_min_ps(_mm_max_ps(f, _mm_setzero_ps()), _mm_set1_ps(1.f));
+	__m128i i = _mm_cvttps_epi32(_mm_mul_ps(f, _mm_set1_ps(255.f)));
+	i = _mm_or_si128(i, _mm_and_si128(nan, _mm_set1_epi32(0xff)));
+	i = _mm_packs_epi32(i, i);
+	return _mm_cvtsi128_si32(_mm_packus_epi16(i, i));
+#elif defined(TA_NEON)
+	float32x4_t f = vreinterpretq_f32_u32(vandq_u32(vld1q_u32((const u32 *)v), vdupq_n_u32(0xffff0000)));
+	const uint32x4_t notNan = vceqq_f32(f, f);
+	f = vbslq_f32(notNan, f, vdupq_n_f32(0.f));
+	f = vminq_f32(vmaxq_f32(f, vdupq_n_f32(0.f)), vdupq_n_f32(1.f));
+	uint32x4_t i = vcvtq_u32_f32(vmulq_f32(f, vdupq_n_f32(255.f)));
+	i = vorrq_u32(i, vbicq_u32(vdupq_n_u32(0xff), notNan));
+	const uint8x8_t b = vmovn_u16(vcombine_u16(vmovn_u32(i), vmovn_u32(i)));
+	return vget_lane_u32(vreinterpret_u32_u8(b), 0);
+#else
+	return float_to_satu8(v[0]) | (float_to_satu8(v[1]) << 8) | (float_to_satu8(v[2]) << 16) | (float_to_satu8(v[3]) << 24);
+#endif
+}
+
 #define vd_rc (vd_ctx->rend)
 
 constexpr u32 ListType_None = -1;
@@ -36,16 +75,23 @@ static f32 f16(u16 v)
 	return *(f32*)&z;
 }
 
+//
+// TA parser state.
+// There is no global parser state: each thread parsing TA data owns its parser object,
+// so that the TA pipeline, the renderer and the Naomi 2 emulation can parse concurrently.
+//
 class BaseTAParser
 {
-	static Ta_Dma *DYNACALL NullVertexData(Ta_Dma *data, Ta_Dma *data_end)
-	{
-		INFO_LOG(PVR, "TA: Invalid state, ignoring VTX data");
-		return data + SZ32;
-	}
-
 public:
-	static bool startList(u32 listType)
+	virtual ~BaseTAParser() = default;
+
+	// Returns a parser producing the vertex color order of the current renderer
+	static std::unique_ptr<BaseTAParser> create();
+
+	// Parses the TA data until data_end, or until a Naomi 2 command is found
+	virtual Ta_Dma *parse(Ta_Dma *data, Ta_Dma *data_end) = 0;
+
+	bool startList(u32 listType)
 	{
 		if (CurrentList != ListType_None)
 			return true;
@@ -73,7 +119,7 @@ public:
 		return true;
 	}
 
-	static void endList()
+	virtual void endList()
 	{
 		if (CurrentList == ListType_None)
 			return;
@@ -86,26 +132,22 @@ public:
 				|| CurrentList == ListType_Translucent_Modifier_Volume)
 			endModVol();
 		CurrentList = ListType_None;
-		VertexDataFP = NullVertexData;
 	}
 
-	static int getCurrentList() {
+	int getCurrentList() const {
 		return CurrentList;
 	}
 
-	static u32 getTileClip() {
+	u32 getTileClip() const {
 		return tileclip_val;
 	}
 
-	static void setTileClip(u32 tileclip) {
+	void setTileClip(u32 tileclip) {
 		tileclip_val = tileclip;
 	}
 
 protected:
-	typedef Ta_Dma* DYNACALL TaListFP(Ta_Dma* data, Ta_Dma* data_end);
-	typedef void TACALL TaPolyParamFP(void* ptr);
-
-	static void endModVol()
+	void endModVol()
 	{
 		std::vector<ModifierVolumeParam> *list = nullptr;
 		if (CurrentList == ListType_Opaque_Modifier_Volume)
@@ -123,75 +165,58 @@ protected:
 		}
 	}
 
-	static void reset()
-	{
-		tileclip_val = 0;
-		memset(FaceBaseColor, 0xff, sizeof(FaceBaseColor));
-		memset(FaceOffsColor, 0xff, sizeof(FaceOffsColor));
-		memset(FaceBaseColor1, 0xff, sizeof(FaceBaseColor1));
-		memset(FaceOffsColor1, 0xff, sizeof(FaceOffsColor1));
-		SFaceBaseColor = 0;
-		SFaceOffsColor = 0;
-		lmr = nullptr;
-		CurrentList = ListType_None;
-		CurrentPP = nullptr;
-		CurrentPPlist = nullptr;
-		VertexDataFP = NullVertexData;
-	}
-
 	static const u32 *ta_type_lut;
 
 	//cache state vars
-	static u32 tileclip_val;
+	u32 tileclip_val = 0;
 
 	//TA state vars
-	static u8 FaceBaseColor[4];
-	static u8 FaceOffsColor[4];
-	static u8 FaceBaseColor1[4];
-	static u8 FaceOffsColor1[4];
-	static u32 SFaceBaseColor;
-	static u32 SFaceOffsColor;
+	alignas(4) u8 FaceBaseColor[4] { 0xff, 0xff, 0xff, 0xff };
+	alignas(4) u8 FaceOffsColor[4] { 0xff, 0xff, 0xff, 0xff };
+	alignas(4) u8 FaceBaseColor1[4] { 0xff, 0xff, 0xff, 0xff };
+	alignas(4) u8 FaceOffsColor1[4] { 0xff, 0xff, 0xff, 0xff };
+	u32 SFaceBaseColor = 0;
+	u32 SFaceOffsColor = 0;
 	//vdec state variables
-	static ModTriangle* lmr;
+	ModTriangle* lmr = nullptr;
 
-	static u32 CurrentList;
-	static TaListFP *VertexDataFP;
+	u32 CurrentList = ListType_None;
 public:
-	static std::vector<PolyParam> *CurrentPPlist;
-	static PolyParam* CurrentPP;
-	static TaListFP* TaCmd;
-	inline static bool fetchTextures = true;
+	// Context receiving the parsed data
+	TA_context *vd_ctx = nullptr;
+	std::vector<PolyParam> *CurrentPPlist = nullptr;
+	PolyParam* CurrentPP = nullptr;
+	bool fetchTextures = true;
 };
 
 const u32 *BaseTAParser::ta_type_lut = TaTypeLut::instance().table;
-u32 BaseTAParser::tileclip_val;
-alignas(4) u8 BaseTAParser::FaceBaseColor[4];
-alignas(4) u8 BaseTAParser::FaceOffsColor[4];
-alignas(4) u8 BaseTAParser::FaceBaseColor1[4];
-alignas(4) u8 BaseTAParser::FaceOffsColor1[4];
-u32 BaseTAParser::SFaceBaseColor;
-u32 BaseTAParser::SFaceOffsColor;
-ModTriangle* BaseTAParser::lmr;
-u32 BaseTAParser::CurrentList;
-PolyParam* BaseTAParser::CurrentPP;
-std::vector<PolyParam>* BaseTAParser::CurrentPPlist;
-BaseTAParser::TaListFP *BaseTAParser::TaCmd;
-BaseTAParser::TaListFP *BaseTAParser::VertexDataFP;
 
 template<int Red = 0, int Green = 1, int Blue = 2, int Alpha = 3>
-class TAParserTempl : public BaseTAParser
+class TAParserTempl final : public BaseTAParser
 {
+	typedef Ta_Dma* (TAParserTempl::*TaListFP)(Ta_Dma* data, Ta_Dma* data_end);
+	typedef void (TAParserTempl::*TaPolyParamFP)(void* ptr);
+
+	TaListFP TaCmd = &TAParserTempl::ta_main;
+	TaListFP VertexDataFP = &TAParserTempl::NullVertexData;
+
+	Ta_Dma *NullVertexData(Ta_Dma *data, Ta_Dma *data_end)
+	{
+		INFO_LOG(PVR, "TA: Invalid state, ignoring VTX data");
+		return data + SZ32;
+	}
+
 	//part : 0 fill all data , 1 fill upper 32B , 2 fill lower 32B
 	//Poly decoder , will be moved to pvr code
 	template <u32 poly_type,u32 part>
-	static Ta_Dma* TACALL ta_handle_poly(Ta_Dma* data,Ta_Dma* data_end)
+	Ta_Dma* ta_handle_poly(Ta_Dma* data,Ta_Dma* data_end)
 	{
 		TA_VertexParam* vp=(TA_VertexParam*)data;
 		u32 rv=0;
 
 		if constexpr (part == 2)
 		{
-			TaCmd=ta_main;
+			TaCmd = &TAParserTempl::ta_main;
 		}
 
 		switch (poly_type)
@@ -253,21 +278,21 @@ case num : {\
 
 	//Code Splitter/routers
 
-	static Ta_Dma* TACALL ta_modvolB_32(Ta_Dma* data,Ta_Dma* data_end)
+	Ta_Dma* ta_modvolB_32(Ta_Dma* data,Ta_Dma* data_end)
 	{
 		AppendModVolVertexB((TA_ModVolB*)data);
-		TaCmd=ta_main;
+		TaCmd = &TAParserTempl::ta_main;
 		return data+SZ32;
 	}
 		
-	static Ta_Dma* TACALL ta_mod_vol_data(Ta_Dma* data,Ta_Dma* data_end)
+	Ta_Dma* ta_mod_vol_data(Ta_Dma* data,Ta_Dma* data_end)
 	{
 		TA_VertexParam* vp=(TA_VertexParam*)data;
 		if (data == data_end - SZ32)
 		{
 			AppendModVolVertexA(&vp->mvolA);
 			//32B more needed , 32B done :)
-			TaCmd=ta_modvolB_32;
+			TaCmd = &TAParserTempl::ta_modvolB_32;
 			return data+SZ32;
 		}
 		else
@@ -278,22 +303,22 @@ case num : {\
 			return data+SZ64;
 		}
 	}
-	static Ta_Dma* TACALL ta_spriteB_data(Ta_Dma* data,Ta_Dma* data_end)
+	Ta_Dma* ta_spriteB_data(Ta_Dma* data,Ta_Dma* data_end)
 	{
 		//32B more needed , 32B done :)
-		TaCmd=ta_main;
+		TaCmd = &TAParserTempl::ta_main;
 			
 		AppendSpriteVertexB((TA_Sprite1B*)data);
 
 		return data+SZ32;
 	}
-	static Ta_Dma* TACALL ta_sprite_data(Ta_Dma* data,Ta_Dma* data_end)
+	Ta_Dma* ta_sprite_data(Ta_Dma* data,Ta_Dma* data_end)
 	{
 		verify(data->pcw.ParaType==ParamType_Vertex_Parameter);
 		if (data == data_end - SZ32)
 		{
 			//32B more needed , 32B done :)
-			TaCmd=ta_spriteB_data;
+			TaCmd = &TAParserTempl::ta_spriteB_data;
 
 			TA_VertexParam* vp=(TA_VertexParam*)data;
 
@@ -312,7 +337,7 @@ case num : {\
 	}
 
 	template <u32 poly_type,u32 poly_size>
-	static Ta_Dma* TACALL ta_poly_data(Ta_Dma* data,Ta_Dma* data_end)
+	Ta_Dma* ta_poly_data(Ta_Dma* data,Ta_Dma* data_end)
 	{
 		verify(data < data_end);
 
@@ -322,21 +347,42 @@ case num : {\
 		if (IS_FIST_HALF)
 			goto fist_half;
 
-		do
+		if constexpr (isBatchedVertex(poly_type))
 		{
-			verify(data->pcw.ParaType == ParamType_Vertex_Parameter);
-			ta_handle_poly<poly_type,0>(data, 0);
-			if (data->pcw.EndOfStrip)
-				goto strip_end;
-			data += poly_size;
-		} while (data <= data_end - poly_size);
+			// Convert all the complete vertices until the end of the strip at once
+			Ta_Dma *runStart = data;
+			for (;;)
+			{
+				verify(data->pcw.ParaType == ParamType_Vertex_Parameter);
+				if (data->pcw.EndOfStrip)
+				{
+					AppendPolyVertices<poly_type, poly_size>(runStart, (data - runStart) / poly_size + 1);
+					goto strip_end;
+				}
+				data += poly_size;
+				if (data > data_end - poly_size)
+					break;
+			}
+			AppendPolyVertices<poly_type, poly_size>(runStart, (data - runStart) / poly_size);
+		}
+		else
+		{
+			do
+			{
+				verify(data->pcw.ParaType == ParamType_Vertex_Parameter);
+				ta_handle_poly<poly_type,0>(data, 0);
+				if (data->pcw.EndOfStrip)
+					goto strip_end;
+				data += poly_size;
+			} while (data <= data_end - poly_size);
+		}
 			
 		if (IS_FIST_HALF)
 		{
 		fist_half:
 			ta_handle_poly<poly_type,1>(data,0);
 			if (data->pcw.EndOfStrip) EndPolyStrip();
-			TaCmd=ta_handle_poly<poly_type,2>;
+			TaCmd = &TAParserTempl::ta_handle_poly<poly_type,2>;
 					
 			data+=SZ32;
 		}
@@ -344,13 +390,13 @@ case num : {\
 		return data;
 
 strip_end:
-		TaCmd=ta_main;
+		TaCmd = &TAParserTempl::ta_main;
 		if (data->pcw.EndOfStrip)
 			EndPolyStrip();
 		return data+poly_size;
 	}
 
-	static void TACALL AppendPolyParam2Full(void* vpp)
+	void AppendPolyParam2Full(void* vpp)
 	{
 		Ta_Dma* pp=(Ta_Dma*)vpp;
 
@@ -358,7 +404,7 @@ strip_end:
 		AppendPolyParam2B((TA_PolyParam2B*)&pp[1]);
 	}
 
-	static void TACALL AppendPolyParam4Full(void* vpp)
+	void AppendPolyParam4Full(void* vpp)
 	{
 		Ta_Dma* pp=(Ta_Dma*)vpp;
 
@@ -367,18 +413,18 @@ strip_end:
 	}
 	//Second part of poly data
 	template <int t>
-	static Ta_Dma* TACALL ta_poly_B_32(Ta_Dma* data,Ta_Dma* data_end)
+	Ta_Dma* ta_poly_B_32(Ta_Dma* data,Ta_Dma* data_end)
 	{
 		if constexpr (t == 2)
 			AppendPolyParam2B((TA_PolyParam2B*)data);
 		else
 			AppendPolyParam4B((TA_PolyParam4B*)data);
 	
-		TaCmd=ta_main;
+		TaCmd = &TAParserTempl::ta_main;
 		return data+SZ32;
 	}
 
-	static Ta_Dma* TACALL ta_main(Ta_Dma* data, Ta_Dma* data_end)
+	Ta_Dma* ta_main(Ta_Dma* data, Ta_Dma* data_end)
 	{
 		while (data < data_end)
 		{
@@ -426,7 +472,7 @@ strip_end:
 					{
 						//accept mod data
 						StartModVol((TA_ModVolParam*)data);
-						VertexDataFP = ta_mod_vol_data;
+						VertexDataFP = &TAParserTempl::ta_mod_vol_data;
 						data += SZ32;
 					}
 					else
@@ -448,13 +494,13 @@ strip_end:
 							if (data <= data_end - psz)
 							{
 								// Full poly, 32B or 64B
-								ta_poly_param_lut[ppid](data);
+								(this->*ta_poly_param_lut[ppid])(data);
 								data += psz;
 							}
 							else
 							{
 								// 64B, first part
-								ta_poly_param_a_lut[ppid](data);
+								(this->*ta_poly_param_a_lut[ppid])(data);
 								// Handle next 32B
 								TaCmd = ta_poly_param_b_lut[ppid];
 								data += SZ32;
@@ -469,7 +515,7 @@ strip_end:
 				TileClipMode(data->pcw.User_Clip);
 				if (CurrentList != ListType_None || startList(data->pcw.ListType))
 				{
-					VertexDataFP = ta_sprite_data;
+					VertexDataFP = &TAParserTempl::ta_sprite_data;
 					AppendSpriteParam((TA_SpriteParam*)data);
 				}
 				data += SZ32;
@@ -477,7 +523,7 @@ strip_end:
 
 				//Variable size
 			case ParamType_Vertex_Parameter:
-				data = VertexDataFP(data, data_end);
+				data = (this->*VertexDataFP)(data, data_end);
 				break;
 
 				//not handled
@@ -495,17 +541,19 @@ strip_end:
 		return data;
 	}
 
-	TAParserTempl();
-
 public:
-	static void reset()
+	Ta_Dma *parse(Ta_Dma *data, Ta_Dma *data_end) override {
+		return (this->*TaCmd)(data, data_end);
+	}
+
+	void endList() override
 	{
-		TaCmd = ta_main;
-		BaseTAParser::reset();
+		BaseTAParser::endList();
+		VertexDataFP = &TAParserTempl::NullVertexData;
 	}
 
 private:
-	static void SetTileClip(u32 xmin,u32 ymin,u32 xmax,u32 ymax)
+	void SetTileClip(u32 xmin,u32 ymin,u32 xmax,u32 ymax)
 	{
 		u32 rv=tileclip_val & 0xF0000000;
 		rv|=xmin; //6 bits
@@ -515,7 +563,7 @@ private:
 		tileclip_val=rv;
 	}
 
-	static void TileClipMode(u32 mode)
+	void TileClipMode(u32 mode)
 	{
 		//Group_En bit seems ignored, thanks p1pkin
 		tileclip_val=(tileclip_val&(~0xF0000000)) | (mode<<28);
@@ -523,7 +571,7 @@ private:
 
 	//Polys  -- update code on sprites if that gets updated too --
 	template<class T>
-	static void glob_param_bdc_(T* pp)
+	void glob_param_bdc_(T* pp)
 	{
 		PolyParam* d_pp = CurrentPP;
 		if (d_pp == NULL || d_pp->count != 0)
@@ -560,7 +608,7 @@ private:
 	// Poly param handling
 
 	// Packed/Floating Color
-	static void TACALL AppendPolyParam0(void* vpp)
+	void AppendPolyParam0(void* vpp)
 	{
 		TA_PolyParam0* pp=(TA_PolyParam0*)vpp;
 
@@ -568,7 +616,7 @@ private:
 	}
 
 	// Intensity, no Offset Color
-	static void TACALL AppendPolyParam1(void* vpp)
+	void AppendPolyParam1(void* vpp)
 	{
 		TA_PolyParam1* pp=(TA_PolyParam1*)vpp;
 
@@ -577,14 +625,14 @@ private:
 	}
 
 	// Intensity, use Offset Color
-	static void TACALL AppendPolyParam2A(void* vpp)
+	void AppendPolyParam2A(void* vpp)
 	{
 		TA_PolyParam2A* pp=(TA_PolyParam2A*)vpp;
 
 		glob_param_bdc(pp);
 	}
 
-	static void TACALL AppendPolyParam2B(void* vpp)
+	void AppendPolyParam2B(void* vpp)
 	{
 		TA_PolyParam2B* pp=(TA_PolyParam2B*)vpp;
 
@@ -593,7 +641,7 @@ private:
 	}
 
 	// Packed Color, with Two Volumes
-	static void TACALL AppendPolyParam3(void* vpp)
+	void AppendPolyParam3(void* vpp)
 	{
 		TA_PolyParam3* pp=(TA_PolyParam3*)vpp;
 
@@ -606,7 +654,7 @@ private:
 	}
 
 	// Intensity, with Two Volumes
-	static void TACALL AppendPolyParam4A(void* vpp)
+	void AppendPolyParam4A(void* vpp)
 	{
 		TA_PolyParam4A* pp=(TA_PolyParam4A*)vpp;
 
@@ -618,7 +666,7 @@ private:
 			CurrentPP->texture1 = renderer->GetTexture(pp->tsp1, pp->tcw1);
 	}
 
-	static void TACALL AppendPolyParam4B(void* vpp)
+	void AppendPolyParam4B(void* vpp)
 	{
 		TA_PolyParam4B* pp=(TA_PolyParam4B*)vpp;
 
@@ -627,7 +675,7 @@ private:
 	}
 
 	//Poly Strip handling
-	static void EndPolyStrip()
+	void EndPolyStrip()
 	{
 		CurrentPP->count = vd_rc.verts.size() - CurrentPP->first;
 
@@ -640,7 +688,7 @@ private:
 		}
 	}
 	
-	static inline void update_fz(float z)
+	void update_fz(float z)
 	{
 		if ((s32&)vd_rc.fZ_max<(s32&)z && (s32&)z<0x49800000)
 			vd_rc.fZ_max=z;
@@ -649,7 +697,7 @@ private:
 		//Poly Vertex handlers
 		//Append vertex base
 	template<class T>
-	static Vertex* vert_cvt_base_(T* vtx)
+	Vertex* vert_cvt_base_(T* vtx)
 	{
 		f32 invW = vtx->xyz[2];
 		vd_rc.verts.emplace_back();
@@ -743,7 +791,7 @@ private:
 
 
 	//(Non-Textured, Packed Color)
-	static void AppendPolyVertex0(TA_Vertex0* vtx)
+	void AppendPolyVertex0(TA_Vertex0* vtx)
 	{
 		vert_cvt_base;
 
@@ -751,7 +799,7 @@ private:
 	}
 
 	//(Non-Textured, Floating Color)
-	static void AppendPolyVertex1(TA_Vertex1* vtx)
+	void AppendPolyVertex1(TA_Vertex1* vtx)
 	{
 		vert_cvt_base;
 
@@ -759,7 +807,7 @@ private:
 	}
 
 	//(Non-Textured, Intensity)
-	static void AppendPolyVertex2(TA_Vertex2* vtx)
+	void AppendPolyVertex2(TA_Vertex2* vtx)
 	{
 		vert_cvt_base;
 
@@ -767,7 +815,7 @@ private:
 	}
 
 	//(Textured, Packed Color)
-	static void AppendPolyVertex3(TA_Vertex3* vtx)
+	void AppendPolyVertex3(TA_Vertex3* vtx)
 	{
 		vert_cvt_base;
 
@@ -778,7 +826,7 @@ private:
 	}
 
 	//(Textured, Packed Color, 16bit UV)
-	static void AppendPolyVertex4(TA_Vertex4* vtx)
+	void AppendPolyVertex4(TA_Vertex4* vtx)
 	{
 		vert_cvt_base;
 
@@ -789,7 +837,7 @@ private:
 	}
 
 	//(Textured, Floating Color)
-	static void AppendPolyVertex5A(TA_Vertex5A* vtx)
+	void AppendPolyVertex5A(TA_Vertex5A* vtx)
 	{
 		vert_cvt_base;
 
@@ -798,7 +846,7 @@ private:
 		vert_uv_32(u,v);
 	}
 
-	static void AppendPolyVertex5B(TA_Vertex5B* vtx)
+	void AppendPolyVertex5B(TA_Vertex5B* vtx)
 	{
 		vert_res_base;
 
@@ -807,7 +855,7 @@ private:
 	}
 
 	//(Textured, Floating Color, 16bit UV)
-	static void AppendPolyVertex6A(TA_Vertex6A* vtx)
+	void AppendPolyVertex6A(TA_Vertex6A* vtx)
 	{
 		vert_cvt_base;
 
@@ -816,7 +864,7 @@ private:
 		vert_uv_16(u,v);
 	}
 
-	static void AppendPolyVertex6B(TA_Vertex6B* vtx)
+	void AppendPolyVertex6B(TA_Vertex6B* vtx)
 	{
 		vert_res_base;
 
@@ -824,8 +872,85 @@ private:
 		vert_float_color(spc,Offs);
 	}
 
+	//Batched conversion of the most common vertex types
+	static constexpr bool isBatchedVertex(u32 poly_type) {
+		return poly_type <= 1 || (poly_type >= 3 && poly_type <= 6);
+	}
+
+	static u32 packedColor(u32 argb)
+	{
+		return (((argb >> 16) & 0xff) << (Red * 8)) | (((argb >> 8) & 0xff) << (Green * 8))
+				| ((argb & 0xff) << (Blue * 8)) | ((argb >> 24) << (Alpha * 8));
+	}
+
+	static u32 floatColor(const f32 *argb)
+	{
+		const u32 c = float4_to_satu8(argb);
+		return (((c >> 8) & 0xff) << (Red * 8)) | (((c >> 16) & 0xff) << (Green * 8))
+				| ((c >> 24) << (Blue * 8)) | ((c & 0xff) << (Alpha * 8));
+	}
+
+	template <u32 poly_type, u32 poly_size>
+	void AppendPolyVertices(Ta_Dma* data, u32 count)
+	{
+		const size_t first = vd_rc.verts.size();
+		vd_rc.verts.resize(first + count);
+		Vertex *cv = &vd_rc.verts[first];
+
+		for (u32 i = 0; i < count; i++, cv++, data += poly_size)
+		{
+			const TA_VertexParam *vp = (const TA_VertexParam *)data;
+			const f32 *xyz = vp->vtx0.xyz;
+			cv->x = xyz[0];
+			cv->y = xyz[1];
+			cv->z = xyz[2];
+			update_fz(xyz[2]);
+
+			u32 col, spc = 0;
+			if constexpr (poly_type == 0)
+			{
+				col = packedColor(vp->vtx0.BaseCol);
+			}
+			else if constexpr (poly_type == 1)
+			{
+				col = floatColor(&vp->vtx1.BaseA);
+			}
+			else if constexpr (poly_type == 3)
+			{
+				col = packedColor(vp->vtx3.BaseCol);
+				spc = packedColor(vp->vtx3.OffsCol);
+				cv->u = vp->vtx3.u;
+				cv->v = vp->vtx3.v;
+			}
+			else if constexpr (poly_type == 4)
+			{
+				col = packedColor(vp->vtx4.BaseCol);
+				spc = packedColor(vp->vtx4.OffsCol);
+				cv->u = f16(vp->vtx4.u);
+				cv->v = f16(vp->vtx4.v);
+			}
+			else if constexpr (poly_type == 5)
+			{
+				col = floatColor(&vp->vtx5B.BaseA);
+				spc = floatColor(&vp->vtx5B.OffsA);
+				cv->u = vp->vtx5A.u;
+				cv->v = vp->vtx5A.v;
+			}
+			else
+			{
+				static_assert(poly_type == 6, "Unsupported vertex type");
+				col = floatColor(&vp->vtx6B.BaseA);
+				spc = floatColor(&vp->vtx6B.OffsA);
+				cv->u = f16(vp->vtx6A.u);
+				cv->v = f16(vp->vtx6A.v);
+			}
+			memcpy(cv->col, &col, sizeof(col));
+			memcpy(cv->spc, &spc, sizeof(spc));
+		}
+	}
+
 	//(Textured, Intensity)
-	static void AppendPolyVertex7(TA_Vertex7* vtx)
+	void AppendPolyVertex7(TA_Vertex7* vtx)
 	{
 		vert_cvt_base;
 
@@ -836,7 +961,7 @@ private:
 	}
 
 	//(Textured, Intensity, 16bit UV)
-	static void AppendPolyVertex8(TA_Vertex8* vtx)
+	void AppendPolyVertex8(TA_Vertex8* vtx)
 	{
 		vert_cvt_base;
 
@@ -848,7 +973,7 @@ private:
 	}
 
 	//(Non-Textured, Packed Color, with Two Volumes)
-	static void AppendPolyVertex9(TA_Vertex9* vtx)
+	void AppendPolyVertex9(TA_Vertex9* vtx)
 	{
 		vert_cvt_base;
 
@@ -857,7 +982,7 @@ private:
 	}
 
 	//(Non-Textured, Intensity,	with Two Volumes)
-	static void AppendPolyVertex10(TA_Vertex10* vtx)
+	void AppendPolyVertex10(TA_Vertex10* vtx)
 	{
 		vert_cvt_base;
 
@@ -866,7 +991,7 @@ private:
 	}
 
 	//(Textured, Packed Color,	with Two Volumes)	
-	static void AppendPolyVertex11A(TA_Vertex11A* vtx)
+	void AppendPolyVertex11A(TA_Vertex11A* vtx)
 	{
 		vert_cvt_base;
 
@@ -876,7 +1001,7 @@ private:
 		vert_uv_32(u0,v0);
 	}
 
-	static void AppendPolyVertex11B(TA_Vertex11B* vtx)
+	void AppendPolyVertex11B(TA_Vertex11B* vtx)
 	{
 		vert_res_base;
 
@@ -887,7 +1012,7 @@ private:
 	}
 
 	//(Textured, Packed Color, 16bit UV, with Two Volumes)
-	static void AppendPolyVertex12A(TA_Vertex12A* vtx)
+	void AppendPolyVertex12A(TA_Vertex12A* vtx)
 	{
 		vert_cvt_base;
 
@@ -897,7 +1022,7 @@ private:
 		vert_uv_16(u0,v0);
 	}
 
-	static void AppendPolyVertex12B(TA_Vertex12B* vtx)
+	void AppendPolyVertex12B(TA_Vertex12B* vtx)
 	{
 		vert_res_base;
 
@@ -908,7 +1033,7 @@ private:
 	}
 
 	//(Textured, Intensity,	with Two Volumes)
-	static void AppendPolyVertex13A(TA_Vertex13A* vtx)
+	void AppendPolyVertex13A(TA_Vertex13A* vtx)
 	{
 		vert_cvt_base;
 
@@ -918,7 +1043,7 @@ private:
 		vert_uv_32(u0,v0);
 	}
 
-	static void AppendPolyVertex13B(TA_Vertex13B* vtx)
+	void AppendPolyVertex13B(TA_Vertex13B* vtx)
 	{
 		vert_res_base;
 
@@ -929,7 +1054,7 @@ private:
 	}
 
 	//(Textured, Intensity, 16bit UV, with Two Volumes)
-	static void AppendPolyVertex14A(TA_Vertex14A* vtx)
+	void AppendPolyVertex14A(TA_Vertex14A* vtx)
 	{
 		vert_cvt_base;
 
@@ -939,7 +1064,7 @@ private:
 		vert_uv_16(u0,v0);
 	}
 
-	static void AppendPolyVertex14B(TA_Vertex14B* vtx)
+	void AppendPolyVertex14B(TA_Vertex14B* vtx)
 	{
 		vert_res_base;
 
@@ -950,7 +1075,7 @@ private:
 	}
 
 	//Sprites
-	static void AppendSpriteParam(TA_SpriteParam* spr)
+	void AppendSpriteParam(TA_SpriteParam* spr)
 	{
 		PolyParam* d_pp = CurrentPP;
 		if (CurrentPP == NULL || CurrentPP->count != 0)
@@ -987,7 +1112,7 @@ private:
 		cv[indx].v = f16(sv->v_name);
 
 	//Sprite Vertex Handlers
-	static void AppendSpriteVertexA(TA_Sprite1A* sv)
+	void AppendSpriteVertexA(TA_Sprite1A* sv)
 	{
 		if (CurrentPP == nullptr)
 			return;
@@ -1064,7 +1189,7 @@ private:
 		P.v = A_v + k1 * AB_v + k2 * AC_v;
 	}
 
-	static void AppendSpriteVertexB(TA_Sprite1B* sv)
+	void AppendSpriteVertexB(TA_Sprite1B* sv)
 	{
 		if (CurrentPP == nullptr)
 			return;
@@ -1097,7 +1222,7 @@ private:
 
 	// Modifier Volumes Vertex handlers
 	
-	static void StartModVol(TA_ModVolParam* param)
+	void StartModVol(TA_ModVolParam* param)
 	{
 		endModVol();
 
@@ -1120,7 +1245,7 @@ private:
 		p->first = vd_rc.modtrig.size();
 	}
 
-	static void AppendModVolVertexA(TA_ModVolA* mvv)
+	void AppendModVolVertexA(TA_ModVolA* mvv)
 	{
 		if (CurrentList != ListType_Opaque_Modifier_Volume && CurrentList != ListType_Translucent_Modifier_Volume)
 			return;
@@ -1140,7 +1265,7 @@ private:
 		lmr->x2=mvv->x2;
 	}
 
-	static void AppendModVolVertexB(TA_ModVolB* mvv)
+	void AppendModVolVertexB(TA_ModVolB* mvv)
 	{
 		if (CurrentList != ListType_Opaque_Modifier_Volume && CurrentList != ListType_Translucent_Modifier_Volume)
 			return;
@@ -1150,6 +1275,14 @@ private:
 	}
 };
 
+std::unique_ptr<BaseTAParser> BaseTAParser::create()
+{
+	if (isDirectX(config::RendererType))
+		return std::make_unique<TAParserTempl<2, 1, 0, 3>>();
+	else
+		return std::make_unique<TAParserTempl<>>();
+}
+
 static void getRegionTileClipping(u32& xmin, u32& xmax, u32& ymin, u32& ymax);
 static void getRegionSettings(int passNumber, RenderPass& pass);
 
@@ -1194,14 +1327,23 @@ static void parseRenderPass(RenderPass& pass, const RenderPass& previousPass, re
 	}
 }
 
-static void ta_parse_vdrc(TA_context* ctx, bool primRestart)
+static void clipToRegionTiles(rend_context& rc)
 {
-	verify(vd_ctx == nullptr);
-	vd_ctx = ctx;
+	u32 xmin, xmax, ymin, ymax;
+	getRegionTileClipping(xmin, xmax, ymin, ymax);
+	rc.fb_X_CLIP.min = std::max(rc.fb_X_CLIP.min, xmin);
+	rc.fb_X_CLIP.max = std::min(rc.fb_X_CLIP.max, xmax + 31);
+	rc.fb_Y_CLIP.min = std::max(rc.fb_Y_CLIP.min, ymin);
+	rc.fb_Y_CLIP.max = std::min(rc.fb_Y_CLIP.max, ymax + 31);
+}
 
-	ta_parse_reset();
+static void ta_parse_vdrc(TA_context* ctx, bool primRestart)
+{
+	BENCH_SCOPE(Ta);
+	std::unique_ptr<BaseTAParser> parser = BaseTAParser::create();
+	parser->vd_ctx = ctx;
 
-	PolyParam *bgpp = &vd_rc.global_param_op.front();
+	PolyParam *bgpp = &ctx->rend.global_param_op.front();
 	if (bgpp->pcw.Texture)
 		bgpp->texture = renderer->GetTexture(bgpp->tsp, bgpp->tcw);
 
@@ -1216,7 +1358,7 @@ static void ta_parse_vdrc(TA_context* ctx, bool primRestart)
 
 		while (ta_data < ta_data_end)
 			try {
-				ta_data = BaseTAParser::TaCmd(ta_data, ta_data_end);
+				ta_data = parser->parse(ta_data, ta_data_end);
 			} catch (const TAParserException& e) {
 				break;
 			}
@@ -1224,43 +1366,36 @@ static void ta_parse_vdrc(TA_context* ctx, bool primRestart)
 		// Disable blending for opaque polys of the first pass
 		if (pass == 0)
 		{
-			for (PolyParam& pp : vd_rc.global_param_op) {
+			for (PolyParam& pp : ctx->rend.global_param_op) {
 				pp.tsp.DstInstr = 0;
 				pp.tsp.SrcInstr = 1;
 			}
 		}
 
-		bool empty_pass = vd_rc.global_param_op.size() == (pass == 0 ? 0u : (int)vd_rc.render_passes.back().op_count)
-				&& vd_rc.global_param_pt.size() == (pass == 0 ? 0u : (int)vd_rc.render_passes.back().pt_count)
-				&& vd_rc.global_param_tr.size() == (pass == 0 ? 0u : (int)vd_rc.render_passes.back().tr_count);
+		bool empty_pass = ctx->rend.global_param_op.size() == (pass == 0 ? 0u : (int)ctx->rend.render_passes.back().op_count)
+				&& ctx->rend.global_param_pt.size() == (pass == 0 ? 0u : (int)ctx->rend.render_passes.back().pt_count)
+				&& ctx->rend.global_param_tr.size() == (pass == 0 ? 0u : (int)ctx->rend.render_passes.back().tr_count);
 
 		if (pass == 0 || !empty_pass)
 		{
-			vd_rc.render_passes.emplace_back();
-			RenderPass& render_pass = vd_rc.render_passes.back();
+			ctx->rend.render_passes.emplace_back();
+			RenderPass& render_pass = ctx->rend.render_passes.back();
 			getRegionSettings(pass, render_pass);
-			render_pass.op_count = vd_rc.global_param_op.size();
-			render_pass.pt_count = vd_rc.global_param_pt.size();
-			render_pass.tr_count = vd_rc.global_param_tr.size();
+			render_pass.op_count = ctx->rend.global_param_op.size();
+			render_pass.pt_count = ctx->rend.global_param_pt.size();
+			render_pass.tr_count = ctx->rend.global_param_tr.size();
 			render_pass.sorted_tr_count = 0;
-			render_pass.mvo_count = vd_rc.global_param_mvo.size();
-			render_pass.mvo_tr_count = vd_rc.global_param_mvo_tr.size();
+			render_pass.mvo_count = ctx->rend.global_param_mvo.size();
+			render_pass.mvo_tr_count = ctx->rend.global_param_mvo_tr.size();
 
-			parseRenderPass(render_pass, previousPass, vd_rc, primRestart);
+			parseRenderPass(render_pass, previousPass, ctx->rend, primRestart);
 			previousPass = render_pass;
 		}
 		childCtx = childCtx->nextContext;
 		pass++;
 	}
 
-	u32 xmin, xmax, ymin, ymax;
-	getRegionTileClipping(xmin, xmax, ymin, ymax);
-	vd_rc.fb_X_CLIP.min = std::max(vd_rc.fb_X_CLIP.min, xmin);
-	vd_rc.fb_X_CLIP.max = std::min(vd_rc.fb_X_CLIP.max, xmax + 31);
-	vd_rc.fb_Y_CLIP.min = std::max(vd_rc.fb_Y_CLIP.min, ymin);
-	vd_rc.fb_Y_CLIP.max = std::min(vd_rc.fb_Y_CLIP.max, ymax + 31);
-
-	vd_ctx = nullptr;
+	clipToRegionTiles(ctx->rend);
 }
 
 static void ta_parse_naomi2(TA_context* ctx, bool primRestart)
@@ -1304,25 +1439,182 @@ static void ta_parse_naomi2(TA_context* ctx, bool primRestart)
 		previousPass = pass;
 	}
 
-	u32 xmin, xmax, ymin, ymax;
-	getRegionTileClipping(xmin, xmax, ymin, ymax);
-	ctx->rend.fb_X_CLIP.min = std::max(ctx->rend.fb_X_CLIP.min, xmin);
-	ctx->rend.fb_X_CLIP.max = std::min(ctx->rend.fb_X_CLIP.max, xmax + 31);
-	ctx->rend.fb_Y_CLIP.min = std::max(ctx->rend.fb_Y_CLIP.min, ymin);
-	ctx->rend.fb_Y_CLIP.max = std::min(ctx->rend.fb_Y_CLIP.max, ymax + 31);
+	clipToRegionTiles(ctx->rend);
+}
+
+static void getTextures(std::vector<PolyParam>& polys)
+{
+	for (PolyParam& pp : polys)
+	{
+		if (!pp.pcw.Texture)
+			continue;
+		pp.texture = renderer->GetTexture(pp.tsp, pp.tcw);
+		if (pp.tsp1.full != (u32)-1)
+			pp.texture1 = renderer->GetTexture(pp.tsp1, pp.tcw1);
+	}
+}
+
+// Finish a single pass context whose TA data has already been parsed by the TA pipeline
+static void ta_parse_preparsed(TA_context* ctx, bool primRestart)
+{
+	rend_context& rc = ctx->rend;
+	getTextures(rc.global_param_op);
+	getTextures(rc.global_param_pt);
+	getTextures(rc.global_param_tr);
+
+	// Disable blending for opaque polys of the first pass
+	for (PolyParam& pp : rc.global_param_op) {
+		pp.tsp.DstInstr = 0;
+		pp.tsp.SrcInstr = 1;
+	}
+	rc.newRenderPass();
+	parseRenderPass(rc.render_passes[0], RenderPass{}, rc, primRestart);
+
+	clipToRegionTiles(rc);
 }
 
 void ta_parse(TA_context *ctx, bool primRestart)
 {
-	if (settings.platform.isNaomi2())
+	if (ctx->preparsed)
+		ta_parse_preparsed(ctx, primRestart);
+	else if (settings.platform.isNaomi2())
 		ta_parse_naomi2(ctx, primRestart);
 	else
 		ta_parse_vdrc(ctx, primRestart);
 }
 
+//
+// Pipelined TA parsing.
+// The TA data of the current context is parsed on a worker thread while the game is still sending it,
+// so that the display lists are ready when the render starts.
+// The emulator thread only publishes the end of the data written so far and never waits for
+// the renderer, since the worker has its own parser. Textures are fetched later by the render thread.
+// Only single pass frames are supported. Other contexts are parsed by the renderer as usual.
+//
+bool ta_pipeline_active;
+
+class TAPipeline
+{
+public:
+	void begin(TA_context *ctx)
+	{
+		stop();
+		this->ctx = ctx;
+		parsed = ctx->tad.thd_root;
+		dataEnd = parsed;
+		notifiedEnd = parsed;
+		failed = false;
+		ctx->rend.Clear();
+		// The worker is idle so the parser can be replaced
+		parser = BaseTAParser::create();
+		parser->vd_ctx = ctx;
+		parser->fetchTextures = false;
+		ta_pipeline_active = true;
+	}
+
+	void push(u8 *end)
+	{
+		dataEnd.store(end, std::memory_order_release);
+		if (end - notifiedEnd >= (ptrdiff_t)ChunkSize)
+		{
+			notifiedEnd = end;
+			worker.run([this]() { parse(); });
+		}
+	}
+
+	bool finish(TA_context *renderCtx)
+	{
+		if (!ta_pipeline_active)
+			return false;
+		// Keep going if the game is already sending the next frame
+		bool inFrame = false;
+		for (TA_context *c = renderCtx; c != nullptr; c = c->nextContext)
+			inFrame = inFrame || c == ctx;
+		if (!inFrame)
+			return false;
+		ta_pipeline_active = false;
+		worker.run([this]() { parse(); });
+		worker.flush();
+
+		TA_context *parsedCtx = ctx;
+		ctx = nullptr;
+		// The renderer will parse the old data if no new list has been sent
+		if (parsedCtx == renderCtx && renderCtx->nextContext == nullptr
+				&& renderCtx->tad.thd_data != renderCtx->tad.thd_root
+				&& (failed || parsed == renderCtx->tad.thd_data))
+			return true;
+		parsedCtx->rend.Clear();
+		return false;
+	}
+
+	void stop()
+	{
+		if (!ta_pipeline_active)
+			return;
+		ta_pipeline_active = false;
+		worker.flush();
+		ctx->rend.Clear();
+		ctx = nullptr;
+	}
+
+private:
+	void parse()
+	{
+		u8 *end = dataEnd.load(std::memory_order_acquire);
+		if (failed || parsed == end)
+			return;
+		BENCH_SCOPE(Ta);
+
+		Ta_Dma *ta_data = (Ta_Dma *)parsed;
+		Ta_Dma *ta_data_end = (Ta_Dma *)end;
+		try {
+			while (ta_data < ta_data_end)
+				ta_data = parser->parse(ta_data, ta_data_end);
+		} catch (const TAParserException& e) {
+			// Ignore the rest of the list like ta_parse does
+			failed = true;
+		}
+		parsed = (u8 *)ta_data;
+	}
+
+	// Amount of new data that wakes up the parser
+	static constexpr u32 ChunkSize = 8_KB;
+
+	WorkerThread worker { "TAParser" };
+	TA_context *ctx = nullptr;
+	// Only used by the worker once the pipeline is started
+	std::unique_ptr<BaseTAParser> parser;
+	// Written by the emulator thread
+	std::atomic<u8 *> dataEnd { nullptr };
+	u8 *notifiedEnd = nullptr;
+	// Written by the parser thread
+	u8 *parsed = nullptr;
+	bool failed = false;
+};
+static TAPipeline taPipeline;
+
+void ta_pipeline_begin(TA_context *ctx) {
+	taPipeline.begin(ctx);
+}
+
+void ta_pipeline_push(u8 *dataEnd) {
+	taPipeline.push(dataEnd);
+}
+
+bool ta_pipeline_finish(TA_context *ctx) {
+	return taPipeline.finish(ctx);
+}
+
+void ta_pipeline_stop() {
+	taPipeline.stop();
+}
+
 //
 // Naomi 2 stuff
 //
+// Parser of the elan display lists. It belongs to the emulator and is only used by the
+// thread running it, or while the emulator is stopped.
+static std::unique_ptr<BaseTAParser> n2Parser;
 static PolyParam *n2CurrentPP;
 static ModifierVolumeParam *n2CurrentMVP;
 
@@ -1351,16 +1643,15 @@ static void setDefaultLight()
 void ta_add_poly(const PolyParam& pp)
 {
 	verify(ta_ctx != nullptr);
-	verify(vd_ctx == nullptr);
-	vd_ctx = ta_ctx;
-	BaseTAParser::startList(pp.pcw.ListType);
+	n2Parser->vd_ctx = ta_ctx;
+	n2Parser->startList(pp.pcw.ListType);
 
-	BaseTAParser::CurrentPPlist->push_back(pp);
-	BaseTAParser::CurrentPP = nullptr; // might be invalidated
-	n2CurrentPP = &BaseTAParser::CurrentPPlist->back();
+	n2Parser->CurrentPPlist->push_back(pp);
+	n2Parser->CurrentPP = nullptr; // might be invalidated
+	n2CurrentPP = &n2Parser->CurrentPPlist->back();
 	n2CurrentPP->first = ta_ctx->rend.verts.size();
 	n2CurrentPP->count = 0;
-	n2CurrentPP->tileclip = BaseTAParser::getTileClip();
+	n2CurrentPP->tileclip = n2Parser->getTileClip();
 	setDefaultMatrices();
 	if (n2CurrentPP->mvMatrix == -1)
 		n2CurrentPP->mvMatrix = IdentityMatIndex;
@@ -1369,17 +1660,15 @@ void ta_add_poly(const PolyParam& pp)
 	setDefaultLight();
 	if (n2CurrentPP->lightModel == -1)
 		n2CurrentPP->lightModel = NoLightIndex;
-	vd_ctx = nullptr;
 }
 
 void ta_add_poly(int listType, const ModifierVolumeParam& mvp)
 {
 	verify(ta_ctx != nullptr);
-	verify(vd_ctx == nullptr);
-	vd_ctx = ta_ctx;
-	BaseTAParser::startList(listType);
+	n2Parser->vd_ctx = ta_ctx;
+	n2Parser->startList(listType);
 
-	switch (BaseTAParser::getCurrentList())
+	switch (n2Parser->getCurrentList())
 	{
 	case ListType_Opaque_Modifier_Volume:
 		ta_ctx->rend.global_param_mvo.push_back(mvp);
@@ -1398,7 +1687,6 @@ void ta_add_poly(int listType, const ModifierVolumeParam& mvp)
 	setDefaultMatrices();
 	if (n2CurrentMVP->mvMatrix == -1)
 		n2CurrentMVP->mvMatrix = IdentityMatIndex;
-	vd_ctx = nullptr;
 }
 
 void ta_add_vertex(const Vertex& vtx)
@@ -1429,46 +1717,33 @@ int ta_add_light(const N2LightModel& light)
 
 u32 ta_add_ta_data(u32 *data, u32 size)
 {
-	verify(vd_ctx == nullptr);
-	vd_ctx = ta_ctx;
-	BaseTAParser::fetchTextures = false;
+	n2Parser->vd_ctx = ta_ctx;
 
 	Ta_Dma *ta_data = (Ta_Dma *)data;
 	Ta_Dma *ta_data_end = (Ta_Dma *)(data + size / 4);
-	try {
-		ta_data = BaseTAParser::TaCmd(ta_data, ta_data_end);
-	} catch (const FlycastException& e) {
-		vd_ctx = nullptr;
-		BaseTAParser::fetchTextures = true;
-		throw;
-	}
-
-	vd_ctx = nullptr;
-	BaseTAParser::fetchTextures = true;
+	ta_data = n2Parser->parse(ta_data, ta_data_end);
 
 	return (u8 *)ta_data - (u8 *)data;
 }
 
 u32 ta_get_tileclip() {
-	return BaseTAParser::getTileClip();
+	return n2Parser->getTileClip();
 }
 
 void ta_set_tileclip(u32 tileclip) {
-	BaseTAParser::setTileClip(tileclip);
+	n2Parser->setTileClip(tileclip);
 }
 
 u32 ta_get_list_type() {
-	return BaseTAParser::getCurrentList();
+	return n2Parser->getCurrentList();
 }
 
 void ta_set_list_type(u32 listType)
 {
-	verify(vd_ctx == nullptr);
-	vd_ctx = ta_ctx;
-	BaseTAParser::endList();
+	n2Parser->vd_ctx = ta_ctx;
+	n2Parser->endList();
 	if (listType != ListType_None)
-		BaseTAParser::startList(listType);
-	vd_ctx = nullptr;
+		n2Parser->startList(listType);
 }
 
 //
@@ -1477,13 +1752,9 @@ void ta_set_list_type(u32 listType)
 
 void ta_parse_reset()
 {
-	using TAParser = TAParserTempl<>;
-	using TAParserDX = TAParserTempl<2, 1, 0, 3>;
-
-	if (isDirectX(config::RendererType))
-		TAParserDX::reset();
-	else
-		TAParser::reset();
+	n2Parser = BaseTAParser::create();
+	// Textures are fetched by the renderer
+	n2Parser->fetchTextures = false;
 }
 
 //decode a vertex in the native pvr format
@@ -0,0 +1,349 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "blockcache.h"
+#include "blockmanager.h"
+#include "hw/sh4/sh4_core.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/modules/mmu.h"
+#include "cfg/option.h"
+#include "stdclass.h"
+#include "version.h"
+#define XXH_STATIC_LINKING_ONLY
+#include <xxhash.h>
+#include <unordered_map>
+
+#if FEAT_SHREC != DYNAREC_NONE
+
+namespace blockcache
+{
+
+constexpr u32 FORMAT_VERSION = 2;
+// Number of new blocks that triggers a background write
+constexpr u32 FLUSH_THRESHOLD = 512;
+constexpr u32 MAX_BLOCK_OPS = 512;
+
+struct FileHeader
+{
+	char magic[8];
+	u32 version;
+	u32 hostCpu;
+	u32 opcodeSize;
+	u32 opcodeCount;
+	u32 pageSize;
+	u32 sh4Clock;
+	u32 superblocks;	// blocks are formed differently
+	char buildHash[16];
+	char gameId[128];
+
+	bool operator==(const FileHeader& other) const {
+		return memcmp(this, &other, sizeof(FileHeader)) == 0;
+	}
+};
+
+struct BlockHeader
+{
+	u32 addr;
+	u32 fpuMode;
+	u64 hash;
+	u32 sh4_code_size;
+	u32 guest_cycles;
+	u32 guest_opcodes;
+	u32 BranchBlock;
+	u32 NextBlock;
+	u32 BlockType;
+	u8 has_fpu_op;
+	u8 has_jcond;
+	u8 read_only;
+	u8 reserved;
+	u32 opcodeCount;
+};
+
+struct CachedBlock
+{
+	BlockHeader header;
+	std::vector<shil_opcode> oplist;
+};
+
+static std::unordered_map<u64, CachedBlock> blocks;
+// serialized blocks not written to disk yet
+static std::vector<u8> pending;
+static u32 pendingCount;
+static bool headerWritten;
+static std::string filePath;
+static FileHeader fileHeader;
+static bool enabled;
+static WorkerThread writer("Flycast-blkcache");
+
+static struct {
+	u32 hits;
+	u32 misses;
+	u32 invalid;
+	u32 stored;
+} stats;
+
+static const char *hostArchName()
+{
+#if HOST_CPU == CPU_X64
+	return "x64";
+#elif HOST_CPU == CPU_ARM64
+	return "arm64";
+#elif HOST_CPU == CPU_X86
+	return "x86";
+#elif HOST_CPU == CPU_ARM
+	return "arm";
+#else
+	return "generic";
+#endif
+}
+
+// Only the fpscr bits used by the decoder
+static u32 getFpuMode(fpscr_t fpu_cfg)
+{
+	return fpu_cfg.PR | (fpu_cfg.SZ << 1) | ((fpu_cfg.RM == 1) << 2);
+}
+
+static u64 makeKey(u32 addr, u32 fpuMode)
+{
+	return ((u64)fpuMode << 32) | addr;
+}
+
+// Protected blocks may have been optimized using constants read in the pages they span
+// so the whole pages are hashed. Only the code is hashed otherwise.
+static bool hashGuestMemory(u32 addr, u32 size, bool read_only, u64& hash)
+{
+	if (size == 0)
+		return false;
+	if (read_only)
+	{
+		u32 end = ((addr + size - 1) | PAGE_MASK) + 1;
+		addr &= ~PAGE_MASK;
+		size = end - addr;
+	}
+	const u8 *p = GetMemPtr(addr, size);
+	if (p == nullptr)
+		return false;
+	hash = XXH3_64bits(p, size);
+	return true;
+}
+
+static void serializeBlock(const CachedBlock& block, std::vector<u8>& out)
+{
+	size_t offset = out.size();
+	size_t opsize = block.oplist.size() * sizeof(shil_opcode);
+	out.resize(offset + sizeof(BlockHeader) + opsize);
+	memcpy(&out[offset], &block.header, sizeof(BlockHeader));
+	memcpy(&out[offset + sizeof(BlockHeader)], block.oplist.data(), opsize);
+}
+
+static void writeFile(const std::string& path, const FileHeader& header, bool truncate, const std::vector<u8>& data)
+{
+	FILE *f = nowide::fopen(path.c_str(), truncate ? "wb" : "ab");
+	if (f == nullptr)
+	{
+		WARN_LOG(DYNAREC, "Can't open block cache %s: errno %d", path.c_str(), errno);
+		return;
+	}
+	bool rc = true;
+	if (truncate)
+		rc = std::fwrite(&header, sizeof(header), 1, f) == 1;
+	if (rc && !data.empty())
+		rc = std::fwrite(data.data(), data.size(), 1, f) == 1;
+	std::fclose(f);
+	if (!rc)
+		WARN_LOG(DYNAREC, "Error writing block cache %s", path.c_str());
+}
+
+static u32 readFile(FILE *f)
+{
+	FileHeader header;
+	if (std::fread(&header, sizeof(header), 1, f) != 1 || !(header == fileHeader))
+		return 0;
+
+	u32 records = 0;
+	for (;;)
+	{
+		CachedBlock block;
+		if (std::fread(&block.header, sizeof(BlockHeader), 1, f) != 1)
+			break;
+		if (block.header.opcodeCount == 0 || block.header.opcodeCount > MAX_BLOCK_OPS)
+			break;
+		block.oplist.resize(block.header.opcodeCount);
+		if (std::fread(block.oplist.data(), sizeof(shil_opcode), block.oplist.size(), f) != block.oplist.size())
+			break;
+		bool valid = true;
+		for (const shil_opcode& op : block.oplist)
+			valid = valid && op.op < shop_max;
+		if (!valid)
+			break;
+		blocks[makeKey(block.header.addr, block.header.fpuMode)] = std::move(block);
+		records++;
+	}
+	return records;
+}
+
+void load()
+{
+	term();
+	enabled = config::DynarecBlockCache && config::DynarecEnabled
+			&& !settings.content.fileName.empty() && !settings.content.gameId.empty();
+	if (!enabled)
+		return;
+
+	memset(&fileHeader, 0, sizeof(fileHeader));
+	memcpy(fileHeader.magic, "FCBLKCHE", sizeof(fileHeader.magic));
+	fileHeader.version = FORMAT_VERSION;
+	fileHeader.hostCpu = HOST_CPU;
+	fileHeader.opcodeSize = sizeof(shil_opcode);
+	fileHeader.opcodeCount = shop_max;
+	fileHeader.pageSize = PAGE_SIZE;
+	fileHeader.sh4Clock = config::Sh4Clock;
+	fileHeader.superblocks = config::DynarecSuperblocks;
+	strncpy(fileHeader.buildHash, GIT_HASH, sizeof(fileHeader.buildHash) - 1);
+	strncpy(fileHeader.gameId, settings.content.gameId.c_str(), sizeof(fileHeader.gameId) - 1);
+
+	filePath = get_game_save_prefix() + "." + hostArchName() + ".blk";
+	u32 records = 0;
+	FILE *f = nowide::fopen(filePath.c_str(), "rb");
+	if (f != nullptr)
+	{
+		records = readFile(f);
+		std::fclose(f);
+	}
+	if (records == 0)
+	{
+		// missing or incompatible file
+		blocks.clear();
+		headerWritten = false;
+	}
+	else if (records > blocks.size() * 2)
+	{
+		// too many stale records: rewrite the file with the live ones only
+		for (const auto& [key, block] : blocks)
+			serializeBlock(block, pending);
+		pendingCount = blocks.size();
+		headerWritten = false;
+	}
+	else
+	{
+		headerWritten = true;
+	}
+	INFO_LOG(DYNAREC, "Block cache %s: %d blocks loaded", filePath.c_str(), (int)blocks.size());
+}
+
+void flush()
+{
+	if (!enabled || (pending.empty() && headerWritten))
+		return;
+	writer.run([path = filePath, header = fileHeader, truncate = !headerWritten, data = std::move(pending)]() {
+		writeFile(path, header, truncate, data);
+	});
+	pending = std::vector<u8>();
+	pendingCount = 0;
+	headerWritten = true;
+}
+
+void term()
+{
+	flush();
+	writer.stop();
+	if (enabled)
+		INFO_LOG(DYNAREC, "Block cache: %d hits, %d misses, %d invalidated, %d stored",
+				stats.hits, stats.misses, stats.invalid, stats.stored);
+	blocks.clear();
+	pending.clear();
+	pendingCount = 0;
+	stats = {};
+	enabled = false;
+}
+
+bool restore(RuntimeBlockInfo *block)
+{
+	if (!enabled || mmu_enabled() || !IsOnRam(block->addr))
+		return false;
+	auto it = blocks.find(makeKey(block->addr, getFpuMode(block->fpu_cfg)));
+	if (it == blocks.end())
+	{
+		stats.misses++;
+		return false;
+	}
+	const CachedBlock& cached = it->second;
+	const BlockHeader& header = cached.header;
+	if (header.has_fpu_op && sr.FD == 1)
+		// Let the decoder raise the exception
+		return false;
+
+	block->sh4_code_size = header.sh4_code_size;
+	u64 hash;
+	if ((header.read_only && !block->CanProtect())
+			|| !hashGuestMemory(block->addr, header.sh4_code_size, header.read_only, hash)
+			|| hash != header.hash)
+	{
+		block->sh4_code_size = 0;
+		blocks.erase(it);
+		stats.invalid++;
+		return false;
+	}
+	block->guest_cycles = header.guest_cycles;
+	block->guest_opcodes = header.guest_opcodes;
+	block->BranchBlock = header.BranchBlock;
+	block->NextBlock = header.NextBlock;
+	block->BlockType = (BlockEndType)header.BlockType;
+	block->has_fpu_op = header.has_fpu_op;
+	block->has_jcond = header.has_jcond;
+	block->oplist = cached.oplist;
+	stats.hits++;
+
+	return true;
+}
+
+void store(const RuntimeBlockInfo *block)
+{
+	if (!enabled || mmu_enabled() || block->temp_block || !IsOnRam(block->addr)
+			|| block->oplist.empty() || block->oplist.size() > MAX_BLOCK_OPS)
+		return;
+
+	CachedBlock cached;
+	BlockHeader& header = cached.header;
+	memset(&header, 0, sizeof(header));
+	if (!hashGuestMemory(block->addr, block->sh4_code_size, block->read_only, header.hash))
+		return;
+	header.addr = block->addr;
+	header.fpuMode = getFpuMode(block->fpu_cfg);
+	header.sh4_code_size = block->sh4_code_size;
+	header.guest_cycles = block->guest_cycles;
+	header.guest_opcodes = block->guest_opcodes;
+	header.BranchBlock = block->BranchBlock;
+	header.NextBlock = block->NextBlock;
+	header.BlockType = block->BlockType;
+	header.has_fpu_op = block->has_fpu_op;
+	header.has_jcond = block->has_jcond;
+	header.read_only = block->read_only;
+	header.opcodeCount = block->oplist.size();
+	cached.oplist = block->oplist;
+
+	serializeBlock(cached, pending);
+	blocks[makeKey(header.addr, header.fpuMode)] = std::move(cached);
+	stats.stored++;
+	if (++pendingCount >= FLUSH_THRESHOLD)
+		flush();
+}
+
+}	// namespace blockcache
+
+#endif	// FEAT_SHREC != DYNAREC_NONE
@@ -0,0 +1,46 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "types.h"
+
+struct RuntimeBlockInfo;
+
+//
+// Persistent cache of decoded and optimized SH4 blocks.
+// Blocks are keyed by physical address and fpscr config, and validated against
+// a hash of the guest memory they were built from.
+// The cache file is per game and per host architecture.
+//
+namespace blockcache
+{
+
+// Load the cache of the current game, if enabled
+void load();
+// Write the pending blocks to disk and close the cache
+void term();
+// Queue new blocks to be written to disk in the background
+void flush();
+
+// Fill the block from the cache. Returns false if not found or no longer valid.
+// Must be called after vaddr, addr and fpu_cfg have been set.
+bool restore(RuntimeBlockInfo *block);
+// Add a freshly decoded and optimized block to the cache
+void store(const RuntimeBlockInfo *block);
+
+}
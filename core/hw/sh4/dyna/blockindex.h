@@ -0,0 +1,134 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <algorithm>
+#include <vector>
+
+//
+// Sorted array of host code address -> block.
+// Blocks are mostly added in increasing code address order so insertions are usually appends.
+// Removed entries are left empty and skipped by find(). The array is compacted once they represent
+// an eighth of it, so that lookups don't degrade after many invalidations.
+//
+template<typename T>
+class CodeIndex
+{
+	struct Entry
+	{
+		const void *code;
+		T value;
+	};
+
+public:
+	// Add a new block. Returns false if a block already exists at this address.
+	bool add(const void *code, const T& value)
+	{
+		auto it = upperBound(code);
+		if (it != entries.begin())
+		{
+			auto prev = it - 1;
+			if (prev->code == code)
+			{
+				if (prev->value)
+					return false;
+				// reuse the empty entry
+				prev->value = value;
+				removed--;
+				return true;
+			}
+		}
+		entries.insert(it, { code, value });
+		return true;
+	}
+
+	// Remove the block at this exact code address. Returns false if not found.
+	bool remove(const void *code)
+	{
+		auto it = upperBound(code);
+		if (it == entries.begin())
+			return false;
+		--it;
+		if (it->code != code || !it->value)
+			return false;
+		it->value = T();
+		if (++removed > MinRemoved && removed * 8 > entries.size())
+			compact();
+		return true;
+	}
+
+	// Find the block with the highest code address lower or equal to 'code'.
+	// The caller must check that 'code' actually belongs to the returned block.
+	T find(const void *code) const
+	{
+		auto it = std::upper_bound(entries.begin(), entries.end(), code,
+				[](const void *code, const Entry& entry) { return code < entry.code; });
+		// skip removed entries
+		while (it != entries.begin())
+		{
+			--it;
+			if (it->value)
+				return it->value;
+		}
+		return T();
+	}
+
+	template<typename F>
+	void forEach(F func) const
+	{
+		for (const Entry& entry : entries)
+			if (entry.value)
+				func(entry.value);
+	}
+
+	void clear() {
+		entries.clear();
+		removed = 0;
+	}
+
+	size_t size() const {
+		return entries.size() - removed;
+	}
+
+	bool empty() const {
+		return size() == 0;
+	}
+
+private:
+	typename std::vector<Entry>::iterator upperBound(const void *code)
+	{
+		// Fast path for appends
+		if (entries.empty() || code > entries.back().code)
+			return entries.end();
+		return std::upper_bound(entries.begin(), entries.end(), code,
+				[](const void *code, const Entry& entry) { return code < entry.code; });
+	}
+
+	void compact()
+	{
+		entries.erase(std::remove_if(entries.begin(), entries.end(),
+				[](const Entry& entry) { return !entry.value; }), entries.end());
+		removed = 0;
+	}
+
+	// Below this number of removed entries, the array is never compacted
+	static constexpr size_t MinRemoved = 16;
+
+	std::vector<Entry> entries;
+	size_t removed = 0;
+};
@@ -5,8 +5,9 @@
 
 #include <algorithm>
 #include <set>
-#include <map>
 #include "blockmanager.h"
+#include "blockcache.h"
+#include "blockindex.h"
 #include "ngen.h"
 
 #include "hw/sh4/sh4_core.h"
@@ -16,6 +17,7 @@
 #include "hw/sh4/sh4_sched.h"
 #include "hw/sh4/modules/mmu.h"
 #include "oslib/virtmem.h"
+#include "hw/sh4/interpr/sh4_opcache.h"
 
 #if defined(__unix__) && defined(DYNA_OPROF)
 #include <opagent.h>
@@ -27,13 +29,14 @@ op_agent_t          oprofHandle;
 
 typedef std::vector<RuntimeBlockInfoPtr> bm_List;
 typedef std::set<RuntimeBlockInfoPtr> bm_Set;
-typedef std::map<void*, RuntimeBlockInfoPtr> bm_Map;
+typedef CodeIndex<RuntimeBlockInfoPtr> bm_Map;
 
 static bm_Set all_temp_blocks;
 static bm_List del_blocks;
 
 bool unprotected_pages[RAM_SIZE_MAX/PAGE_SIZE];
-static std::set<RuntimeBlockInfo*> blocks_per_page[RAM_SIZE_MAX/PAGE_SIZE];
+// Few blocks per page so a vector is faster than a set
+static std::vector<RuntimeBlockInfo*> blocks_per_page[RAM_SIZE_MAX/PAGE_SIZE];
 
 static bm_Map blkmap;
 // Stats
@@ -127,17 +130,14 @@ RuntimeBlockInfoPtr bm_GetBlock(void* dynarec_code)
 		return NULL;
 
 	void *dynarecrw = CC_RX2RW(dynarec_code);
-	// Returns a block who's code addr is bigger than dynarec_code (or end)
-	auto iter = blkmap.upper_bound(dynarecrw);
-	if (iter == blkmap.begin())
-		return NULL;
-	iter--;  // Need to go back to find the potential candidate
+	// Returns the block with the highest code addr lower or equal to dynarec_code
+	RuntimeBlockInfoPtr block = blkmap.find(dynarecrw);
 
 	// However it might be out of bounds, check for that
-	if (!iter->second->containsCode(dynarecrw))
+	if (!block || !block->containsCode(dynarecrw))
 		return NULL;
 
-	return iter->second;
+	return block;
 }
 
 static void bm_CleanupDeletedBlocks()
@@ -168,12 +168,11 @@ void bm_AddBlock(RuntimeBlockInfo* blk)
 	RuntimeBlockInfoPtr block(blk);
 	if (block->temp_block)
 		all_temp_blocks.insert(block);
-	auto iter = blkmap.find((void*)blk->code);
-	if (iter != blkmap.end()) {
-		ERROR_LOG(DYNAREC, "DUP: %08X %p %08X %p", iter->second->addr, iter->second->code, block->addr, block->code);
+	if (!blkmap.add((void*)blk->code, block)) {
+		RuntimeBlockInfoPtr dup = blkmap.find((void*)blk->code);
+		ERROR_LOG(DYNAREC, "DUP: %08X %p %08X %p", dup->addr, dup->code, block->addr, block->code);
 		die("Duplicated block");
 	}
-	blkmap[(void*)block->code] = block;
 
 	verify((void*)bm_GetCode(block->addr) == (void*)ngen_FailedToFindBlock);
 	FPCA(block->addr) = (DynarecCodeEntryPtr)CC_RW2RX(block->code);
@@ -197,11 +196,10 @@ void bm_AddBlock(RuntimeBlockInfo* blk)
 void bm_DiscardBlock(RuntimeBlockInfo* block)
 {
 	// Remove from block map
-	auto it = blkmap.find((void*)block->code);
-	verify(it != blkmap.end());
-	RuntimeBlockInfoPtr block_ptr = it->second;
+	RuntimeBlockInfoPtr block_ptr = blkmap.find((void*)block->code);
+	verify(block_ptr.get() == block);
 
-	blkmap.erase(it);
+	blkmap.remove((void*)block->code);
 
 	block_ptr->pNextBlock = NULL;
 	block_ptr->pBranchBlock = NULL;
@@ -260,6 +258,7 @@ void bm_Reset()
 	{
 		virtmem::region_unlock(&mem_b[0], RAM_SIZE);
 	}
+	addrspace::mmuMirrorProtect(0, RAM_SIZE, false);
 }
 
 void bm_LockPage(u32 addr, u32 size)
@@ -269,6 +268,7 @@ void bm_LockPage(u32 addr, u32 size)
 		virtmem::region_lock(addrspace::ram_base + 0x0C000000 + addr, size);
 	else
 		virtmem::region_lock(&mem_b[addr], size);
+	addrspace::mmuMirrorProtect(addr, size, true);
 }
 
 void bm_UnlockPage(u32 addr, u32 size)
@@ -278,6 +278,7 @@ void bm_UnlockPage(u32 addr, u32 size)
 		virtmem::region_unlock(addrspace::ram_base + 0x0C000000 + addr, size);
 	else
 		virtmem::region_unlock(&mem_b[addr], size);
+	addrspace::mmuMirrorProtect(addr, size, false);
 }
 
 void bm_ResetCache()
@@ -285,9 +286,7 @@ void bm_ResetCache()
 	sh4Dynarec->reset();
 	addrspace::bm_reset();
 
-	for (const auto& it : blkmap)
-	{
-		RuntimeBlockInfoPtr block = it.second;
+	blkmap.forEach([](const RuntimeBlockInfoPtr& block) {
 		block->relink_data = 0;
 		block->pNextBlock = NULL;
 		block->pBranchBlock = NULL;
@@ -296,7 +295,7 @@ void bm_ResetCache()
 		// Avoid circular references
 		block->Discard();
 		del_blocks.push_back(block);
-	}
+	});
 
 	blkmap.clear();
 	// blkmap includes temp blocks as well
@@ -328,7 +327,7 @@ void bm_ResetTempCache(bool full)
 		for (const auto& block : all_temp_blocks)
 		{
 			FPCA(block->addr) = ngen_FailedToFindBlock;
-			blkmap.erase((void*)block->code);
+			blkmap.remove((void*)block->code);
 		}
 	}
 	del_blocks.insert(del_blocks.begin(),all_temp_blocks.begin(),all_temp_blocks.end());
@@ -362,12 +361,11 @@ void bm_WriteBlockMap(const std::string& file)
 	if (f)
 	{
 		INFO_LOG(DYNAREC, "Writing block map !");
-		for (const auto& [_, block] : blkmap)
-		{
+		blkmap.forEach([f](const RuntimeBlockInfoPtr& block) {
 			fprintf(f, "block: %d:%08X:%p:%d:%d:%d\n", block->BlockType, block->addr, block->code, block->host_code_size, block->guest_cycles, block->guest_opcodes);
 			for(size_t j = 0; j < block->oplist.size(); j++)
 				fprintf(f,"\top: %zd:%d:%s\n", j, block->oplist[j].guest_offs, block->oplist[j].dissasm().c_str());
-		}
+		});
 		fclose(f);
 		INFO_LOG(DYNAREC, "Finished writing block map");
 	}
@@ -375,10 +373,9 @@ void bm_WriteBlockMap(const std::string& file)
 
 void sh4_jitsym(FILE* out)
 {
-	for (const auto& [_, block] : blkmap)
-	{
+	blkmap.forEach([out](const RuntimeBlockInfoPtr& block) {
 		fprintf(out, "%p %d %08X\n", block->code, block->host_code_size, block->addr);
-	}
+	});
 }
 
 RuntimeBlockInfo::~RuntimeBlockInfo()
@@ -424,33 +421,38 @@ void RuntimeBlockInfo::Discard()
 		for (u32 addr = this->addr & ~PAGE_MASK; addr < this->addr + this->sh4_code_size; addr += PAGE_SIZE)
 		{
 			auto& block_list = blocks_per_page[(addr & RAM_MASK) / PAGE_SIZE];
-			block_list.erase(this);
+			auto it = std::find(block_list.begin(), block_list.end(), this);
+			if (it != block_list.end())
+			{
+				*it = block_list.back();
+				block_list.pop_back();
+			}
 		}
 	}
 }
 
-void RuntimeBlockInfo::SetProtectedFlags()
+bool RuntimeBlockInfo::CanProtect() const
 {
 #ifdef TARGET_NO_EXCEPTIONS
-	this->read_only = false;
-	return;
+	return false;
 #endif
 	// Don't write protect rom and BIOS/IP.BIN (Grandia II)
 	if (!IsOnRam(addr) || (addr & 0x1FFF0000) == 0x0c000000)
+		return false;
+	for (u32 addr = this->addr & ~PAGE_MASK; addr < this->addr + sh4_code_size; addr += PAGE_SIZE)
+		if (unprotected_pages[(addr & RAM_MASK) / PAGE_SIZE])
+			return false;
+	return true;
+}
+
+void RuntimeBlockInfo::SetProtectedFlags()
+{
+	if (!CanProtect())
 	{
 		this->read_only = false;
 		unprotected_blocks++;
 		return;
 	}
-	for (u32 addr = this->addr & ~PAGE_MASK; addr < this->addr + sh4_code_size; addr += PAGE_SIZE)
-	{
-		if (unprotected_pages[(addr & RAM_MASK) / PAGE_SIZE])
-		{
-			this->read_only = false;
-			unprotected_blocks++;
-			return;
-		}
-	}
 	this->read_only = true;
 	protected_blocks++;
 	for (u32 addr = this->addr & ~PAGE_MASK; addr < this->addr + sh4_code_size; addr += PAGE_SIZE)
@@ -458,23 +460,24 @@ void RuntimeBlockInfo::SetProtectedFlags()
 		auto& block_list = blocks_per_page[(addr & RAM_MASK) / PAGE_SIZE];
 		if (block_list.empty())
 			bm_LockPage(addr);
-		block_list.insert(this);
+		block_list.push_back(this);
 	}
 }
 
 void bm_RamWriteAccess(u32 addr)
 {
 	addr &= RAM_MASK;
+	// The page may also hold dynarec blocks
+	opcache::ramWriteAccess(addr);
 	if (unprotected_pages[addr / PAGE_SIZE])
 		return;
 
 	unprotected_pages[addr / PAGE_SIZE] = true;
 	bm_UnlockPage(addr);
-	std::set<RuntimeBlockInfo*>& block_list = blocks_per_page[addr / PAGE_SIZE];
+	std::vector<RuntimeBlockInfo*>& block_list = blocks_per_page[addr / PAGE_SIZE];
 	if (!block_list.empty())
 	{
-		std::vector<RuntimeBlockInfo*> list_copy;
-		list_copy.insert(list_copy.begin(), block_list.begin(), block_list.end());
+		std::vector<RuntimeBlockInfo*> list_copy(block_list);
 		if (!list_copy.empty())
 			DEBUG_LOG(DYNAREC, "bm_RamWriteAccess write access to %08x pc %08x", addr, next_pc);
 		for (auto& block : list_copy)
@@ -483,6 +486,11 @@ void bm_RamWriteAccess(u32 addr)
 	}
 }
 
+bool bm_RamPageHasBlocks(u32 addr)
+{
+	return !blocks_per_page[(addr & RAM_MASK) / PAGE_SIZE].empty();
+}
+
 u32 bm_getRamOffset(void *p)
 {
 #ifndef __SWITCH__
@@ -550,8 +558,7 @@ void print_blocks()
 		INFO_LOG(DYNAREC, "Writing blocks to %p", f);
 	}
 
-	for (const auto& [_, blk] : blkmap)
-	{
+	blkmap.forEach([f](const RuntimeBlockInfoPtr& blk) {
 		if (f)
 		{
 			fprintf(f,"block: %p\n",blk.get());
@@ -602,7 +609,7 @@ void print_blocks()
 
 			fprintf(f,"}\n");
 		}
-	}
+	});
 
 	if (f) fclose(f);
 }
@@ -13,7 +13,9 @@ typedef std::shared_ptr<RuntimeBlockInfo> RuntimeBlockInfoPtr;
 
 struct RuntimeBlockInfo
 {
-	bool Setup(u32 pc,fpscr_t fpu_cfg);
+	// If optimize is false, the SSA passes aren't run and the block is marked for
+	// promotion once it gets hot (tiered compilation).
+	bool Setup(u32 pc,fpscr_t fpu_cfg, bool optimize = true);
 
 	u32 addr;
 	DynarecCodeEntryPtr code;
@@ -29,6 +31,8 @@ struct RuntimeBlockInfo
 	bool has_fpu_op;
 	u32 blockcheck_failures;
 	bool temp_block;
+	// Unoptimized blocks only: executions left before the block is re-optimized. Decremented by the generated code.
+	u32 hot_counter;
 
 	u32 BranchBlock; //if not 0xFFFFFFFF then jump target
 	u32 NextBlock;   //if not 0xFFFFFFFF then next block (by position)
@@ -63,6 +67,7 @@ struct RuntimeBlockInfo
 	void RemRef(const RuntimeBlockInfoPtr& other);
 
 	void Discard();
+	bool CanProtect() const;
 	void SetProtectedFlags();
 
 	bool read_only;
@@ -94,6 +99,8 @@ static inline bool bm_IsRamPageProtected(u32 addr)
 	addr &= RAM_MASK;
 	return !unprotected_pages[addr / PAGE_SIZE];
 }
+// Returns true if protected blocks have been compiled from this ram page
+bool bm_RamPageHasBlocks(u32 addr);
 void bm_LockPage(u32 addr, u32 size = PAGE_SIZE);
 void bm_UnlockPage(u32 addr, u32 size = PAGE_SIZE);
 u32 bm_getRamOffset(void *p);
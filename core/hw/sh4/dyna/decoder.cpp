@@ -21,6 +21,8 @@
 
 #define BLOCK_MAX_SH_OPS_SOFT 500
 #define BLOCK_MAX_SH_OPS_HARD 511
+// Max distance between the start of a superblock and the target of a followed jump
+#define SUPERBLOCK_MAX_SPAN 4096
 
 static RuntimeBlockInfo* blk;
 static Sh4Cycles cycleCounter;
@@ -942,6 +944,33 @@ static void state_Setup(u32 rpc,fpscr_t fpu_cfg)
 	state.info.has_fpu=false;
 }
 
+// Superblocks: keep decoding at the target of a forward static jump instead of ending the block
+// so that the optimizer and register allocator see the code on both sides.
+// The skipped code becomes part of the block range, which must be write-protected to
+// avoid block checks on code that isn't executed.
+static bool dec_FollowJump(u32 max_cycles)
+{
+	if (!config::DynarecSuperblocks || mmu_enabled() || state.BlockType != BET_StaticJump)
+		return false;
+	if (state.JumpAddr <= state.cpu.rpc || state.JumpAddr - blk->vaddr > SUPERBLOCK_MAX_SPAN
+			|| blk->oplist.size() >= BLOCK_MAX_SH_OPS_SOFT || blk->guest_cycles >= max_cycles)
+		return false;
+	blk->sh4_code_size = state.JumpAddr + 2 - blk->vaddr;
+	bool canProtect = blk->CanProtect();
+	blk->sh4_code_size = 0;
+	if (!canProtect)
+		return false;
+
+	state.cpu.rpc = state.JumpAddr;
+	state.cpu.is_delayslot = false;
+	state.NextOp = NDO_NextOp;
+	state.BlockType = BET_SCL_Intr;
+	state.JumpAddr = NullAddress;
+	state.NextAddr = NullAddress;
+
+	return true;
+}
+
 void dec_updateBlockCycles(RuntimeBlockInfo *block, u16 op)
 {
 	block->guest_cycles += cycleCounter.countCycles(op);
@@ -1019,6 +1048,8 @@ bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 			break;
 
 		case NDO_End:
+			if (dec_FollowJump(max_cycles))
+				continue;
 			// Disabled for now since we need to know if the block is read-only,
 			// which isn't determined until after the decoding.
 			// This is a relatively rare optimization anyway
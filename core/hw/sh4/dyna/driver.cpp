@@ -2,6 +2,7 @@
 #include <unordered_set>
 
 #include "hw/sh4/sh4_interpreter.h"
+#include "hw/sh4/interpr/sh4_opcache.h"
 #include "hw/sh4/sh4_core.h"
 #include "hw/sh4/sh4_interrupts.h"
 
@@ -9,9 +10,16 @@
 #include "hw/sh4/modules/mmu.h"
 
 #include "blockmanager.h"
+#include "blockcache.h"
 #include "ngen.h"
 #include "decoder.h"
 #include "oslib/virtmem.h"
+#include "emulator.h"
+#include "cfg/option.h"
+#include "benchmark/benchmark.h"
+#define XXH_STATIC_LINKING_ONLY
+#include <xxhash.h>
+#include <mutex>
 
 #if FEAT_SHREC != DYNAREC_NONE
 
@@ -40,6 +48,24 @@ ptrdiff_t cc_rx_offset;
 
 static std::unordered_set<u32> smc_hotspots;
 
+// Tiered compilation
+// Number of executions of an unoptimized block before it's optimized
+constexpr u32 PROMOTION_THRESHOLD = 100;
+// Number of executions between two checks for the completion of the optimization
+constexpr u32 PROMOTION_POLL = 16;
+
+struct PromotionJob
+{
+	RuntimeBlockInfoPtr block;		// unoptimized block, kept alive until the job is installed or dropped
+	RuntimeBlockInfo *optimized;
+	u64 codeHash;
+};
+
+static WorkerThread optimizer("Flycast-optimizer");
+static std::mutex promotedMutex;
+static std::vector<PromotionJob> promotedBlocks;
+static std::unordered_set<RuntimeBlockInfo *> promotingBlocks;
+
 static sh4_if sh4Interp;
 static Sh4CodeBuffer codeBuffer;
 Sh4Dynarec *sh4Dynarec;
@@ -90,13 +116,36 @@ static void clear_temp_cache(bool full)
 	bm_ResetTempCache(full);
 }
 
+static void dropPromotion(PromotionJob& job)
+{
+	// Not accounted for as a protected or unprotected block
+	job.optimized->sh4_code_size = 0;
+	delete job.optimized;
+	promotingBlocks.erase(job.block.get());
+}
+
+static void cancelPromotions()
+{
+	std::vector<PromotionJob> jobs;
+	{
+		std::lock_guard<std::mutex> _(promotedMutex);
+		std::swap(jobs, promotedBlocks);
+	}
+	for (PromotionJob& job : jobs)
+		dropPromotion(job);
+	// Jobs still being optimized will be dropped when installed
+	promotingBlocks.clear();
+}
+
 static void recSh4_ClearCache()
 {
 	INFO_LOG(DYNAREC, "recSh4:Dynarec Cache clear at %08X free space %d", next_pc, codeBuffer.getFreeSpace());
+	BENCH_COUNT(CacheFlushes);
 	codeBuffer.reset(false);
 	bm_ResetCache();
 	smc_hotspots.clear();
 	clear_temp_cache(true);
+	cancelPromotions();
 }
 
 static void recSh4_Run()
@@ -113,8 +162,10 @@ static void recSh4_Run()
 }
 
 void AnalyseBlock(RuntimeBlockInfo* blk);
+void AnalyseBlockOps(RuntimeBlockInfo* blk);
+void AnalyseBlockBranchTargets(RuntimeBlockInfo* blk);
 
-bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg)
+bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg, bool optimize)
 {
 	addr = host_code_size = 0;
 	guest_cycles = guest_opcodes = host_opcodes = 0;
@@ -127,6 +178,7 @@ bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg)
 	BlockType = BET_SCL_Intr;
 	has_fpu_op = false;
 	temp_block = false;
+	hot_counter = 0;
 	
 	vaddr = rpc;
 	if (vaddr & 1)
@@ -152,6 +204,12 @@ bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg)
 	
 	oplist.clear();
 
+	if (blockcache::restore(this))
+	{
+		SetProtectedFlags();
+		return true;
+	}
+
 	try {
 		if (!dec_DecodeBlock(this, SH4_TIMESLICE / 2))
 			return false;
@@ -162,11 +220,109 @@ bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg)
 	}
 	SetProtectedFlags();
 
-	AnalyseBlock(this);
+	if (optimize)
+	{
+		AnalyseBlock(this);
+		blockcache::store(this);
+	}
+	else
+	{
+		hot_counter = PROMOTION_THRESHOLD;
+	}
+
+	return true;
+}
 
+static bool hashBlockCode(const RuntimeBlockInfo *block, u64& hash)
+{
+	const u8 *p = GetMemPtr(block->addr, block->sh4_code_size);
+	if (p == nullptr)
+		return false;
+	hash = XXH3_64bits(p, block->sh4_code_size);
 	return true;
 }
 
+// Replace the unoptimized blocks by their optimized version once available.
+// The unoptimized block might be executing so its code isn't reclaimed until the next cleanup.
+static void installPromotedBlocks()
+{
+	std::vector<PromotionJob> jobs;
+	{
+		std::lock_guard<std::mutex> _(promotedMutex);
+		if (promotedBlocks.empty())
+			return;
+		std::swap(jobs, promotedBlocks);
+	}
+	for (PromotionJob& job : jobs)
+	{
+		RuntimeBlockInfo *block = job.optimized;
+		u64 hash;
+		if (mmu_enabled() || codeBuffer.getFreeSpace() < 32_KB
+				|| bm_GetBlock(block->addr) != job.block
+				|| !hashBlockCode(block, hash) || hash != job.codeHash)
+		{
+			// The unoptimized block has been discarded or its code has changed
+			dropPromotion(job);
+			continue;
+		}
+		promotingBlocks.erase(job.block.get());
+		AnalyseBlockBranchTargets(block);
+		block->SetProtectedFlags();
+		bm_DiscardBlock(job.block.get());
+		sh4Dynarec->compile(block, !block->read_only, true);
+		verify(block->code != nullptr);
+		bm_AddBlock(block);
+		blockcache::store(block);
+	}
+}
+
+void DYNACALL rdv_BlockHot(RuntimeBlockInfo *block)
+{
+	// Poll again later whatever happens, so that the counter never wraps around.
+	// Discarded blocks are kept in del_blocks until the next cleanup so this is safe.
+	block->hot_counter = PROMOTION_POLL;
+	installPromotedBlocks();
+	if (bm_GetBlock(block->addr).get() != block)
+		// discarded or just promoted
+		return;
+	if (promotingBlocks.count(block) != 0)
+		// still being optimized
+		return;
+	PromotionJob job;
+	if (!hashBlockCode(block, job.codeHash))
+		return;
+	job.block = bm_GetBlock(block->addr);
+	RuntimeBlockInfo *optimized = sh4Dynarec->allocateBlock();
+	optimized->addr = block->addr;
+	optimized->vaddr = block->vaddr;
+	optimized->fpu_cfg = block->fpu_cfg;
+	optimized->code = nullptr;
+	optimized->host_code_size = 0;
+	optimized->host_opcodes = 0;
+	optimized->sh4_code_size = block->sh4_code_size;
+	optimized->guest_cycles = block->guest_cycles;
+	optimized->guest_opcodes = block->guest_opcodes;
+	optimized->has_fpu_op = block->has_fpu_op;
+	optimized->blockcheck_failures = 0;
+	optimized->temp_block = false;
+	optimized->hot_counter = 0;
+	optimized->BranchBlock = block->BranchBlock;
+	optimized->NextBlock = block->NextBlock;
+	optimized->pBranchBlock = optimized->pNextBlock = nullptr;
+	optimized->BlockType = block->BlockType;
+	optimized->has_jcond = block->has_jcond;
+	optimized->read_only = block->read_only;
+	optimized->oplist = block->oplist;
+	job.optimized = optimized;
+
+	promotingBlocks.insert(block);
+	optimizer.run([job = std::move(job)]() mutable {
+		AnalyseBlockOps(job.optimized);
+		std::lock_guard<std::mutex> _(promotedMutex);
+		promotedBlocks.push_back(std::move(job));
+	});
+}
+
 DynarecCodeEntryPtr rdv_CompilePC(u32 blockcheck_failures)
 {
 	const u32 pc = next_pc;
@@ -175,8 +331,11 @@ DynarecCodeEntryPtr rdv_CompilePC(u32 blockcheck_failures)
 		recSh4_ClearCache();
 
 	RuntimeBlockInfo* rbi = sh4Dynarec->allocateBlock();
+	// Unoptimized blocks are optimized later if they get hot
+	const bool tiered = config::DynarecTieredCompilation && sh4Dynarec->supportsTiering()
+			&& !mmu_enabled() && smc_hotspots.count(pc) == 0;
 
-	if (!rbi->Setup(pc, fpscr))
+	if (!rbi->Setup(pc, fpscr, !tiered))
 	{
 		delete rbi;
 		return nullptr;
@@ -195,6 +354,7 @@ DynarecCodeEntryPtr rdv_CompilePC(u32 blockcheck_failures)
 	bool block_check = !rbi->read_only;
 	sh4Dynarec->compile(rbi, block_check, do_opts);
 	verify(rbi->code != nullptr);
+	BENCH_COUNT(BlocksCompiled);
 
 	bm_AddBlock(rbi);
 
@@ -212,6 +372,7 @@ DynarecCodeEntryPtr DYNACALL rdv_FailedToFindBlock(u32 pc)
 {
 	//DEBUG_LOG(DYNAREC, "rdv_FailedToFindBlock %08x", pc);
 	next_pc=pc;
+	installPromotedBlocks();
 	DynarecCodeEntryPtr code = rdv_CompilePC(0);
 	if (code == NULL)
 		code = bm_GetCodeByVAddr(next_pc);
@@ -353,15 +514,38 @@ static void recSh4_Step()
 
 static void recSh4_Reset(bool hard)
 {
+	// The interpreter cache may still be enabled if the interpreter was used before
+	opcache::enable(false);
 	sh4Interp.Reset(hard);
 	recSh4_ClearCache();
 	if (hard)
 		bm_Reset();
 }
 
+static void blockCacheEventCallback(Event event, void *)
+{
+	switch (event)
+	{
+	case Event::Start:
+		blockcache::load();
+		break;
+	case Event::Pause:
+		blockcache::flush();
+		break;
+	case Event::Terminate:
+		blockcache::term();
+		break;
+	default:
+		break;
+	}
+}
+
 static void recSh4_Init()
 {
 	INFO_LOG(DYNAREC, "recSh4 Init");
+	EventManager::listen(Event::Start, blockCacheEventCallback);
+	EventManager::listen(Event::Pause, blockCacheEventCallback);
+	EventManager::listen(Event::Terminate, blockCacheEventCallback);
 	Get_Sh4Interpreter(&sh4Interp);
 	sh4Interp.Init();
 	bm_Init();
@@ -397,6 +581,12 @@ static void recSh4_Term()
 #endif
 	CodeCache = nullptr;
 	TempCodeCache = nullptr;
+	EventManager::unlisten(Event::Start, blockCacheEventCallback);
+	EventManager::unlisten(Event::Pause, blockCacheEventCallback);
+	EventManager::unlisten(Event::Terminate, blockCacheEventCallback);
+	blockcache::term();
+	optimizer.stop();
+	cancelPromotions();
 	bm_Term();
 	sh4Interp.Term();
 }
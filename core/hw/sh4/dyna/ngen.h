@@ -30,6 +30,9 @@ DynarecCodeEntryPtr rdv_FindOrCompile();
 // Registers a custom FailedToFindBlock handler function
 void rdv_SetFailedToFindBlockHandler(void (*handler)());
 
+//Called when the hot_counter of an unoptimized block reaches zero
+void DYNACALL rdv_BlockHot(RuntimeBlockInfo *block);
+
 //code -> pointer to code of block, dpc -> if dynamic block, pc. if cond, 0 for next, 1 for branch
 void* DYNACALL rdv_LinkBlock(u8* code,u32 dpc);
 
@@ -105,6 +108,11 @@ public:
 	virtual RuntimeBlockInfo *allocateBlock() {
 		return new RuntimeBlockInfo();
 	}
+	// Return true if the generated code decrements the hot_counter of unoptimized blocks
+	// and calls rdv_BlockHot() when it reaches zero.
+	virtual bool supportsTiering() {
+		return false;
+	}
 
 	// Dynarec canonical implementation callback methods.
 	// Used to call default implementation of shil ops that the dynarec doesn't implement.
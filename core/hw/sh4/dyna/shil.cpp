@@ -29,6 +29,18 @@ void AnalyseBlock(RuntimeBlockInfo* blk)
 	optim.Optimize();
 }
 
+void AnalyseBlockOps(RuntimeBlockInfo* blk)
+{
+	SSAOptimizer optim(blk);
+	optim.OptimizeOps();
+}
+
+void AnalyseBlockBranchTargets(RuntimeBlockInfo* blk)
+{
+	SSAOptimizer optim(blk);
+	optim.OptimizeBranchTargets();
+}
+
 std::string name_reg(Sh4RegType reg)
 {
 	std::stringstream ss;
@@ -33,6 +33,14 @@ public:
 	SSAOptimizer(RuntimeBlockInfo* blk) : block(blk) {}
 
 	void Optimize()
+	{
+		OptimizeOps();
+		OptimizeBranchTargets();
+	}
+
+	// Passes that only transform the block oplist.
+	// Can run on a worker thread as long as the block isn't shared with the emulation thread.
+	void OptimizeOps()
 	{
 		AddVersionPass();
 #if DEBUG
@@ -49,7 +57,6 @@ public:
 		CombineShiftsPass();
 		DeadRegisterPass();
 		IdentityMovePass();
-		SingleBranchTargetPass();
 
 #if DEBUG
 		if (stats.prop_constants > 0 || stats.dead_code_ops > 0 || stats.constant_ops_replaced > 0
@@ -64,6 +71,13 @@ public:
 #endif
 	}
 
+	// Follows the block branch targets and updates the block cycles.
+	// Uses the decoder state so it must run on the emulation thread.
+	void OptimizeBranchTargets()
+	{
+		SingleBranchTargetPass();
+	}
+
 	void AddVersionPass()
 	{
 		memset(reg_versions, 0, sizeof(reg_versions));
@@ -292,7 +306,7 @@ private:
 				}
 				else if ((r2 & 0x1F) == 0)
 				{
-					if (op.op == shop_shl)
+					if (op.op == shop_shld)
 						// rd = 0
 						ReplaceByMov32(op, 0);
 					else
@@ -408,7 +422,8 @@ private:
 				}
 				dead_code = dead_code && unused_rd;
 			}
-			if (dead_code && op.op != shop_readm)	// memory read on registers can have side effects
+			// memory read on registers can have side effects, div1 also updates sr.Q
+			if (dead_code && op.op != shop_readm && op.op != shop_div1)
 			{
 				//printf("%08x DEAD %s\n", block->vaddr + op.guest_offs, op.dissasm().c_str());
 				block->oplist.erase(block->oplist.begin() + opnum);
@@ -475,8 +490,8 @@ private:
 					}
 				}
 				// a * 1 == a
-				else if (op.rs2.imm_value() == 1
-						&& (op.op == shop_mul_i32 || op.op == shop_mul_s16 || op.op == shop_mul_u16))
+				// Not true for 16-bit multiplications, which only use the low half of a
+				else if (op.rs2.imm_value() == 1 && op.op == shop_mul_i32)
 				{
 					//printf("%08x IDEN %s\n", block->vaddr + op.guest_offs, op.dissasm().c_str());
 					ReplaceByMov32(op);
@@ -529,6 +544,25 @@ private:
 				&& param.version[reg_ver.get_reg() - param._reg] > reg_ver.get_version();
 	}
 
+	// Interpreter fallbacks and some ops modify registers without defining a new version
+	bool ClobbersReg(const shil_opcode& op, Sh4RegType reg)
+	{
+		switch (op.op)
+		{
+		case shop_ifb:
+			return true;
+		case shop_sync_sr:
+			return reg == reg_sr_status || (reg >= reg_r0 && reg <= reg_r7)
+					|| (reg >= reg_r0_Bank && reg <= reg_r7_Bank);
+		case shop_sync_fpscr:
+			return reg == reg_fpscr || reg == reg_old_fpscr || (reg >= reg_fr_0 && reg <= reg_xf_15);
+		case shop_div1:
+			return reg == reg_sr_status;
+		default:
+			return false;
+		}
+	}
+
 	bool UsesRegValue(const shil_param& param, RegValue reg_ver)
 	{
 		return param.is_reg()
@@ -580,6 +614,7 @@ private:
 			size_t defnum = -1;
 			size_t usenum = -1;
 			size_t aliasdef = -1;
+			size_t aliasvaldef = -1;
 			for (size_t opnum = 0; opnum < block->oplist.size(); opnum++)
 			{
 				shil_opcode* op = &block->oplist[opnum];
@@ -594,6 +629,13 @@ private:
 					aliasdef = opnum;
 				else if (DefinesHigherVersion(op->rd2, alias.second) && aliasdef == (size_t)-1)
 					aliasdef = opnum;
+				// or alias modified after its definition
+				else if ((alias.second.get_version() == 0 || aliasvaldef != (size_t)-1)
+						&& ClobbersReg(*op, alias.second.get_reg()) && aliasdef == (size_t)-1)
+					aliasdef = opnum;
+				if ((op->rd.is_reg() && RegValue(op->rd) == alias.second)
+						|| (op->rd2.is_reg() && RegValue(op->rd2) == alias.second))
+					aliasvaldef = opnum;
 
 				// find last use
 				if (UsesRegValue(op->rs1, alias.first))
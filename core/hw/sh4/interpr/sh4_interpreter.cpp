@@ -13,8 +13,11 @@
 #include "../sh4_cache.h"
 #include "debug/gdb_server.h"
 #include "../sh4_cycles.h"
+#include "sh4_opcache.h"
+#include "cfg/option.h"
+#include <algorithm>
 
-// SH4 underclock factor when using the interpreter so that it's somewhat usable
+// Maximum SH4 underclock factor when using the interpreter so that it's somewhat usable
 #ifdef STRICT_MODE
 constexpr int CPU_RATIO = 1;
 #else
@@ -45,10 +48,32 @@ static u16 ReadNexOp()
 	return IReadMem16(addr);
 }
 
+static void ExecuteNextOpcode()
+{
+	const opcache::Op *entry = opcache::get(next_pc);
+	if (entry == nullptr)
+	{
+		ExecuteOpcode(ReadNexOp());
+		return;
+	}
+	// The entry may be invalidated while executing
+	const opcache::Op op = *entry;
+	next_pc += 2;
+	if (sr.FD == 1 && op.fpu)
+		RaiseFPUDisableException();
+	op.handler(op.op);
+	sh4cycles.executeCycles((sh4_eu)op.unit, op.issueCycles, op.memOp);
+}
+
 static void Sh4_int_Run()
 {
 	sh4_int_bCpuRun = true;
 	RestoreHostRoundingMode();
+#ifndef STRICT_MODE
+	sh4cycles.setCpuRatio(std::clamp<int>(config::InterpreterCpuRatio, 1, CPU_RATIO));
+#endif
+	// Rollback netplay write-protects ram pages itself
+	opcache::enable(!config::GGPOEnable);
 
 	try {
 		do
@@ -56,16 +81,14 @@ static void Sh4_int_Run()
 			try {
 				do
 				{
-					u32 op = ReadNexOp();
-
-					ExecuteOpcode(op);
+					ExecuteNextOpcode();
 				} while (p_sh4rcb->cntx.cycle_counter > 0);
 				p_sh4rcb->cntx.cycle_counter += SH4_TIMESLICE;
 				UpdateSystem_INTC();
 			} catch (const SH4ThrownException& ex) {
 				Do_Exception(ex.epc, ex.expEvn);
 				// an exception requires the instruction pipeline to drain, so approx 5 cycles
-				sh4cycles.addCycles(5 * CPU_RATIO);
+				sh4cycles.addCycles(5 * sh4cycles.getCpuRatio());
 			}
 		} while (sh4_int_bCpuRun);
 	} catch (const debugger::Stop&) {
@@ -85,12 +108,11 @@ static void Sh4_int_Step()
 
 	RestoreHostRoundingMode();
 	try {
-		u32 op = ReadNexOp();
-		ExecuteOpcode(op);
+		ExecuteNextOpcode();
 	} catch (const SH4ThrownException& ex) {
 		Do_Exception(ex.epc, ex.expEvn);
 		// an exception requires the instruction pipeline to drain, so approx 5 cycles
-		sh4cycles.addCycles(5 * CPU_RATIO);
+		sh4cycles.addCycles(5 * sh4cycles.getCpuRatio());
 	} catch (const debugger::Stop&) {
 	}
 }
@@ -123,6 +145,7 @@ static void Sh4_int_Reset(bool hard)
 	icache.Reset(hard);
 	ocache.Reset(hard);
 	sh4cycles.reset();
+	opcache::reset();
 	p_sh4rcb->cntx.cycle_counter = SH4_TIMESLICE;
 
 	INFO_LOG(INTERPRETER, "Sh4 Reset");
@@ -137,9 +160,7 @@ static bool Sh4_int_IsCpuRunning()
 void ExecuteDelayslot()
 {
 	try {
-		u32 op = ReadNexOp();
-
-		ExecuteOpcode(op);
+		ExecuteNextOpcode();
 	} catch (SH4ThrownException& ex) {
 		AdjustDelaySlotException(ex);
 		throw ex;
@@ -189,6 +210,7 @@ int UpdateSystem_INTC()
 }
 
 static void sh4_int_resetcache() {
+	opcache::reset();
 }
 
 static void Sh4_int_Init()
@@ -201,6 +223,8 @@ static void Sh4_int_Init()
 static void Sh4_int_Term()
 {
 	Sh4_int_Stop();
+	// The dynarec uses the interpreter for fallbacks but doesn't protect pages for it
+	opcache::enable(false);
 	INFO_LOG(INTERPRETER, "Sh4 Term");
 }
 
@@ -0,0 +1,118 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "sh4_opcache.h"
+#include "hw/sh4/sh4_core.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_cycles.h"
+#include "hw/sh4/dyna/blockmanager.h"
+
+namespace opcache
+{
+
+constexpr u32 PageCount = RAM_SIZE_MAX / PAGE_SIZE;
+constexpr u32 OpsPerPage = PAGE_SIZE / 2;
+// Pages written to more often than this are considered data and no longer cached
+constexpr u8 MaxInvalidations = 64;
+
+bool enabled;
+std::unique_ptr<Op[]> pages[PageCount];
+static bool locked[PageCount];
+static u8 invalidations[PageCount];
+
+void enable(bool value)
+{
+#if defined(STRICT_MODE) || defined(TARGET_NO_EXCEPTIONS) || FEAT_SHREC == DYNAREC_NONE
+	// strict mode emulates the instruction cache, and write protection needs a fault handler
+	// and the dynarec block manager
+	value = false;
+#endif
+	if (enabled && !value)
+		reset();
+	enabled = value;
+}
+
+void reset()
+{
+	for (u32 i = 0; i < PageCount; i++)
+	{
+#if FEAT_SHREC != DYNAREC_NONE
+		// Dynarec blocks may still depend on the page protection
+		if (locked[i] && !bm_RamPageHasBlocks(i * PAGE_SIZE))
+			bm_UnlockPage(i * PAGE_SIZE);
+#endif
+		locked[i] = false;
+		invalidations[i] = 0;
+		pages[i].reset();
+	}
+}
+
+const Op *decode(u32 pc)
+{
+	// Don't write protect rom and BIOS/IP.BIN, same as the dynarec
+	if ((pc & 0x1FFF0000) == 0x0c000000)
+		return nullptr;
+	const u32 offset = pc & RAM_MASK;
+	const u32 pageNum = offset / PAGE_SIZE;
+	if (invalidations[pageNum] >= MaxInvalidations)
+		return nullptr;
+
+	std::unique_ptr<Op[]>& page = pages[pageNum];
+	if (page == nullptr)
+		page = std::make_unique<Op[]>(OpsPerPage);
+	if (!locked[pageNum])
+	{
+#if FEAT_SHREC != DYNAREC_NONE
+		// Protect the page before reading it so that no write can be missed
+		bm_LockPage(offset);
+#endif
+		locked[pageNum] = true;
+	}
+	const u16 op = *(const u16 *)&mem_b[offset];
+	const sh4_opcodelistentry *desc = OpDesc[op];
+
+	Op& entry = page[(offset & PAGE_MASK) / 2];
+	entry.op = op;
+	entry.unit = desc->unit;
+	entry.issueCycles = desc->IssueCycles;
+	entry.fpu = desc->IsFloatingPoint();
+	entry.memOp = Sh4Cycles::isMemOp(desc);
+	entry.handler = OpPtr[op];
+
+	return &entry;
+}
+
+bool ramWriteAccess(u32 ramOffset)
+{
+	const u32 pageNum = ramOffset / PAGE_SIZE;
+	if (!locked[pageNum])
+		return false;
+	DEBUG_LOG(INTERPRETER, "opcache: write access to %08x pc %08x", ramOffset, next_pc);
+	locked[pageNum] = false;
+#if FEAT_SHREC != DYNAREC_NONE
+	bm_UnlockPage(ramOffset);
+#endif
+	if (invalidations[pageNum] < MaxInvalidations)
+		invalidations[pageNum]++;
+	// The page array isn't freed since the write may come from the instruction being executed
+	memset(pages[pageNum].get(), 0, OpsPerPage * sizeof(Op));
+
+	return true;
+}
+
+}	// namespace opcache
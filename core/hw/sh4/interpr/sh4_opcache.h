@@ -0,0 +1,75 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "types.h"
+#include "hw/sh4/sh4_interpreter.h"
+#include "hw/sh4/sh4_opcode_list.h"
+#include "hw/sh4/modules/mmu.h"
+#include <memory>
+
+//
+// Pre-decoded instruction cache for the interpreter.
+// Instructions in system RAM are decoded on first execution into per-page arrays
+// holding the handler and the cycle accounting info, so that the interpreter loop
+// doesn't need to fetch and look up each opcode again.
+// Pages are write-protected like dynarec blocks and flushed when written to.
+//
+namespace opcache
+{
+
+struct Op
+{
+	OpCallFP *handler;
+	u16 op;
+	u8 unit;		// sh4_eu
+	u8 issueCycles;
+	bool fpu;
+	bool memOp;
+};
+
+// Enable or disable the cache. Must be called when the cpu isn't running.
+void enable(bool value);
+// Unprotect all pages and discard all decoded instructions
+void reset();
+// Called when a write to a protected page is detected. Returns true if the page was cached.
+bool ramWriteAccess(u32 ramOffset);
+
+const Op *decode(u32 pc);
+
+extern bool enabled;
+extern std::unique_ptr<Op[]> pages[RAM_SIZE_MAX / PAGE_SIZE];
+
+// Returns the decoded instruction at the given address, or nullptr if it can't be cached
+static inline const Op *get(u32 pc)
+{
+	if (!enabled || mmu_enabled() || (pc & 1) != 0
+			|| pc >= 0xE0000000 || (pc & 0x1C000000) != 0x0C000000)
+		return nullptr;
+	u32 offset = pc & RAM_MASK;
+	Op *page = pages[offset / PAGE_SIZE].get();
+	if (page != nullptr)
+	{
+		Op *entry = &page[(offset & PAGE_MASK) / 2];
+		if (entry->handler != nullptr)
+			return entry;
+	}
+	return decode(pc);
+}
+
+}	// namespace opcache
@@ -1448,6 +1448,8 @@ sh4op(i0011_nnnn_mmmm_0100)
 
 	const u8 old_q = sr.Q;
 	sr.Q = (u8)((0x80000000 & r[n]) != 0);
+	// read before the shift in case n == m
+	const u32 rm = r[m];
 
 	r[n] <<= 1;
 	r[n] |= sr.T;
@@ -1458,13 +1460,13 @@ sh4op(i0011_nnnn_mmmm_0100)
 	{
 		if (sr.M == 0)
 		{
-			r[n] -= r[m];
+			r[n] -= rm;
 			bool tmp1 = r[n] > old_rn;
 			sr.Q = sr.Q ^ tmp1;
 		}
 		else
 		{
-			r[n] += r[m];
+			r[n] += rm;
 			bool tmp1 = r[n] < old_rn;
 			sr.Q = !sr.Q ^ tmp1;
 		}
@@ -1473,13 +1475,13 @@ sh4op(i0011_nnnn_mmmm_0100)
 	{
 		if (sr.M == 0)
 		{
-			r[n] += r[m];
+			r[n] += rm;
 			bool tmp1 = r[n] < old_rn;
 			sr.Q = sr.Q ^ tmp1;
 		}
 		else
 		{
-			r[n] -= r[m];
+			r[n] -= rm;
 			bool tmp1 = r[n] > old_rn;
 			sr.Q = !sr.Q ^ tmp1;
 		}
@@ -189,6 +189,8 @@ bool UTLB_Sync(u32 entry)
 	lru_address = tlb_entry.Address.VPN << 10;
 
 	cache_entry(tlb_entry);
+	// the page may have been mapped to a different physical address
+	addrspace::mmuMirrorUnmap(lru_address, ~lru_mask + 1);
 
 	if (!mmu_enabled() && (tlb_entry.Address.VPN & (0xFC000000 >> 10)) == (0xE0000000 >> 10))
 	{
@@ -5,6 +5,8 @@
 #include "hw/sh4/sh4_core.h"
 #include "debug/gdb_server.h"
 #include "serialize.h"
+#include "cfg/option.h"
+#include "network/ggpo.h"
 
 TLB_Entry UTLB[64];
 TLB_Entry ITLB[4];
@@ -454,6 +456,8 @@ void mmu_set_state()
 	{
 		mmuOn = false;
 	}
+	// Writes through the mirror would bypass the net rollback RAM watcher
+	addrspace::mmuMirrorEnable(mmuOn && config::DynarecEnabled && config::DynarecHostMmu && !ggpo::active());
 
 	SetMemoryHandlers();
 	setSqwHandler();
@@ -557,6 +561,62 @@ template void mmu_WriteMem(u32 adr, u16 data);
 template void mmu_WriteMem(u32 adr, u32 data);
 template void mmu_WriteMem(u32 adr, u64 data);
 
+#if FEAT_SHREC == DYNAREC_JIT && defined(FAST_MMU)
+bool mmuMirrorMappable(u32 vaddr)
+{
+	u32 paddr = vaddr;
+	if (mmu_is_translated(vaddr, 1))
+	{
+		const TLB_Entry *entry;
+		if (mmu_full_lookup(vaddr, &entry, paddr) != MmuError::NONE)
+			// the mapping may be added later
+			return true;
+	}
+	return addrspace::mmuMirrorCanMap(vaddr, paddr);
+}
+
+static void mmuMirrorMapPage(u32 vaddr, u32 paddr)
+{
+	if (!addrspace::mmuMirrorCanMap(vaddr, paddr))
+		return;
+	u32 pageSize = 0x20000000;
+	if (mmu_is_translated(vaddr, 1))
+	{
+		const TLB_Entry *entry;
+		u32 rv;
+		if (mmu_full_lookup(vaddr, &entry, rv) != MmuError::NONE)
+			return;
+		pageSize = ~mmu_mask[entry->Data.SZ1 * 2 + entry->Data.SZ0] + 1;
+	}
+	addrspace::mmuMirrorMap(vaddr, paddr, pageSize);
+}
+
+template<typename T>
+T DYNACALL mmuMirrorRead(u32 vaddr, u32, u32 pc)
+{
+	u32 paddr = mmuDynarecLookup(vaddr, 0, pc);
+	mmuMirrorMapPage(vaddr, paddr);
+	return addrspace::readt<T>(paddr);
+}
+template u8 mmuMirrorRead(u32 vaddr, u32, u32 pc);
+template u16 mmuMirrorRead(u32 vaddr, u32, u32 pc);
+template u32 mmuMirrorRead(u32 vaddr, u32, u32 pc);
+template u64 mmuMirrorRead(u32 vaddr, u32, u32 pc);
+
+template<typename T>
+void DYNACALL mmuMirrorWrite(u32 vaddr, T data, u32 pc)
+{
+	u32 paddr = mmuDynarecLookup(vaddr, 1, pc);
+	// Write first so that a protected code page is unlocked before being mapped
+	addrspace::writet<T>(paddr, data);
+	mmuMirrorMapPage(vaddr, paddr);
+}
+template void mmuMirrorWrite(u32 vaddr, u8 data, u32 pc);
+template void mmuMirrorWrite(u32 vaddr, u16 data, u32 pc);
+template void mmuMirrorWrite(u32 vaddr, u32 data, u32 pc);
+template void mmuMirrorWrite(u32 vaddr, u64 data, u32 pc);
+#endif
+
 void mmu_TranslateSQW(u32 adr, u32 *out)
 {
 	if (!mmuOn)
@@ -2,6 +2,7 @@
 #include "types.h"
 #include "hw/sh4/sh4_mmr.h"
 #include "hw/sh4/dyna/ngen.h"
+#include "hw/mem/addrspace.h"
 
 //Translation Types
 //Opcode read
@@ -123,11 +124,15 @@ extern u32 mmuAddressLUT[0x100000];
 static inline void mmuAddressLUTFlush(bool full)
 {
 	if (full)
+	{
 		memset(mmuAddressLUT, 0, sizeof(mmuAddressLUT) / 2);	// flush user memory
+		addrspace::mmuMirrorUnmap(0, 0x80000000);
+	}
 	else
 	{
 		constexpr u32 slotPages = (32 * 1024 * 1024) >> 12;
 		memset(mmuAddressLUT, 0, slotPages * sizeof(u32));		// flush slot 0
+		addrspace::mmuMirrorUnmap(0, 32 * 1024 * 1024);
 	}
 }
 #endif
@@ -159,6 +164,14 @@ static inline u32 DYNACALL mmuDynarecLookup(u32 vaddr, u32 write, u32 pc)
 
 	return paddr;
 }
+
+#ifdef FAST_MMU
+// Slow path of the dynarec accesses through the host MMU mirror
+template<typename T> T DYNACALL mmuMirrorRead(u32 vaddr, u32, u32 pc);
+template<typename T> void DYNACALL mmuMirrorWrite(u32 vaddr, T data, u32 pc);
+// Returns false if accesses to this address never go through the host MMU mirror
+bool mmuMirrorMappable(u32 vaddr);
+#endif
 #endif
 
 void MMU_init();
@@ -33,6 +33,11 @@ public:
 		Sh4cntx.cycle_counter -= countCycles(op);
 	}
 
+	void executeCycles(sh4_eu unit, int issueCycles, bool memOp)
+	{
+		Sh4cntx.cycle_counter -= countCycles(unit, issueCycles, memOp);
+	}
+
 	void addCycles(int cycles) const
 	{
 		Sh4cntx.cycle_counter -= cycles;
@@ -50,10 +55,42 @@ public:
 
 	int countCycles(u16 op)
 	{
-		sh4_opcodelistentry *opcode = OpDesc[op];
+		const sh4_opcodelistentry *opcode = OpDesc[op];
+		return countCycles(opcode->unit, opcode->IssueCycles, isMemOp(opcode));
+	}
+
+	int countCycles(sh4_eu unit, int issueCycles, bool memOp)
+	{
 		int cycles = 0;
 #ifndef STRICT_MODE
-		static const bool isMemOp[45] {
+		if (memOp)
+		{
+			if (++memOps < 4)
+				cycles = mmu_enabled() ? 5 : 2;
+		}
+		// TODO only for mem read?
+#endif
+
+		if (lastUnit == CO
+				|| unit == CO
+				|| (lastUnit == unit && lastUnit != MT))
+		{
+			// cannot run in parallel
+			lastUnit = unit;
+			cycles += issueCycles;
+		}
+		else
+		{
+			// can run in parallel
+			lastUnit = CO;
+		}
+		return cycles * cpuRatio;
+	}
+
+	static bool isMemOp(const sh4_opcodelistentry *opcode)
+	{
+#ifndef STRICT_MODE
+		static const bool memOps[45] {
 			false,
 			false,
 			true,	// all mem moves, ldtlb, sts.l FPUL/FPSCR, @-Rn, lds.l @Rn+,FPUL
@@ -91,28 +128,10 @@ public:
 			false,
 			true,	// mac.wl @Rm+,@Rn+
 		};
-		if (isMemOp[opcode->ex_type])
-		{
-			if (++memOps < 4)
-				cycles = mmu_enabled() ? 5 : 2;
-		}
-		// TODO only for mem read?
+		return memOps[opcode->ex_type];
+#else
+		return false;
 #endif
-
-		if (lastUnit == CO
-				|| opcode->unit == CO
-				|| (lastUnit == opcode->unit && lastUnit != MT))
-		{
-			// cannot run in parallel
-			lastUnit = opcode->unit;
-			cycles += opcode->IssueCycles;
-		}
-		else
-		{
-			// can run in parallel
-			lastUnit = CO;
-		}
-		return cycles * cpuRatio;
 	}
 
 	void reset()
@@ -133,6 +152,14 @@ public:
 		return writeExternalAccessCycles(addr, size) * 2 * cpuRatio;
 	}
 
+	int getCpuRatio() const {
+		return cpuRatio;
+	}
+
+	void setCpuRatio(int ratio) {
+		cpuRatio = ratio;
+	}
+
 private:
 	// Returns the number of external cycles (100 MHz) needed for a sized read at the given address
 	static int readExternalAccessCycles(u32 addr, u32 size);
@@ -140,7 +167,7 @@ private:
 	static int writeExternalAccessCycles(u32 addr, u32 size);
 
 	sh4_eu lastUnit = CO;
-	const int cpuRatio;
+	int cpuRatio;
 	int memOps = 0;
 };
 
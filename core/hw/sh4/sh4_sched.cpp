@@ -20,6 +20,13 @@
 
 	sh4_sched_now()
 
+	Scheduled callbacks are kept in a binary min-heap ordered by end time,
+	so that the next event is always at the top.
+	End times are 32-bit and wrap, but they are always less than 2^31 cycles
+	apart, so they are compared using their signed difference.
+	Events whose end time has passed without being handled are moved to an
+	overdue list and handled like the linear scan did: they're only called when
+	their remaining time wraps around into the current tick.
 */
 struct sched_list
 {
@@ -33,6 +40,15 @@ struct sched_list
 static u64 sh4_sched_ffb;
 static std::vector<sched_list> sch_list;
 static int sh4_sched_next_id = -1;
+// heap of scheduled ids
+static std::vector<int> sch_heap;
+// position of each id in the heap, -1 if not scheduled or Overdue
+static std::vector<int> sch_heap_pos;
+constexpr int Overdue = -2;
+// scheduled ids whose end time has passed
+static std::vector<int> sch_overdue;
+// set while deserializing, when end times of different states may be mixed
+static bool sch_heap_dirty;
 
 static u32 sh4_sched_now();
 
@@ -44,18 +60,154 @@ static u32 sh4_sched_remaining(const sched_list& sched, u32 reference)
 		return -1;
 }
 
+static bool heap_before(int id1, int id2)
+{
+	return (int)(sch_list[id1].end - sch_list[id2].end) < 0;
+}
+
+static void heap_set(size_t pos, int id)
+{
+	sch_heap[pos] = id;
+	sch_heap_pos[id] = pos;
+}
+
+static void heap_up(size_t pos)
+{
+	int id = sch_heap[pos];
+	while (pos > 0)
+	{
+		size_t parent = (pos - 1) / 2;
+		if (!heap_before(id, sch_heap[parent]))
+			break;
+		heap_set(pos, sch_heap[parent]);
+		pos = parent;
+	}
+	heap_set(pos, id);
+}
+
+static void heap_down(size_t pos)
+{
+	int id = sch_heap[pos];
+	for (;;)
+	{
+		size_t child = pos * 2 + 1;
+		if (child >= sch_heap.size())
+			break;
+		if (child + 1 < sch_heap.size() && heap_before(sch_heap[child + 1], sch_heap[child]))
+			child++;
+		if (!heap_before(sch_heap[child], id))
+			break;
+		heap_set(pos, sch_heap[child]);
+		pos = child;
+	}
+	heap_set(pos, id);
+}
+
+static void heap_remove(int id)
+{
+	if (sch_heap_dirty)
+		return;
+	int pos = sch_heap_pos[id];
+	if (pos == -1)
+		return;
+	sch_heap_pos[id] = -1;
+	if (pos == Overdue)
+	{
+		sch_overdue.erase(std::find(sch_overdue.begin(), sch_overdue.end(), id));
+		return;
+	}
+	int last = sch_heap.back();
+	sch_heap.pop_back();
+	if (last == id)
+		return;
+	heap_set(pos, last);
+	heap_up(pos);
+	heap_down(sch_heap_pos[last]);
+}
+
+// Insert, move or remove the id according to its end time
+static void heap_update(int id)
+{
+	if (sch_heap_dirty)
+		return;
+	if (sch_list[id].end == -1)
+	{
+		heap_remove(id);
+		return;
+	}
+	if (sch_heap_pos[id] == Overdue)
+		heap_remove(id);
+	int pos = sch_heap_pos[id];
+	if (pos == -1)
+	{
+		sch_heap.push_back(id);
+		pos = sch_heap.size() - 1;
+	}
+	heap_up(pos);
+	heap_down(sch_heap_pos[id]);
+}
+
+static void heap_rebuild()
+{
+	sch_heap_dirty = false;
+	sch_heap.clear();
+	sch_overdue.clear();
+	std::fill(sch_heap_pos.begin(), sch_heap_pos.end(), -1);
+	for (size_t id = 0; id < sch_list.size(); id++)
+		if (sch_list[id].end != -1)
+		{
+			sch_heap.push_back(id);
+			heap_up(sch_heap.size() - 1);
+		}
+}
+
+// Move the events whose end time is before 'now' to the overdue list
+static void heap_move_overdue(u32 now)
+{
+	while (!sch_heap.empty() && (int)(sch_list[sch_heap[0]].end - now) < 0)
+	{
+		int id = sch_heap[0];
+		heap_remove(id);
+		sch_heap_pos[id] = Overdue;
+		sch_overdue.push_back(id);
+	}
+}
+
+// Collect the ids whose end time is before or at 'now'
+static void heap_expired(size_t pos, u32 now, std::vector<int>& expired)
+{
+	if (pos >= sch_heap.size())
+		return;
+	int id = sch_heap[pos];
+	if ((int)(sch_list[id].end - now) > 0)
+		return;
+	expired.push_back(id);
+	heap_expired(pos * 2 + 1, now, expired);
+	heap_expired(pos * 2 + 2, now, expired);
+}
+
 void sh4_sched_ffts()
 {
 	u32 diff = -1;
 	int slot = -1;
 
+	if (sch_heap_dirty)
+		heap_rebuild();
+
 	u32 now = sh4_sched_now();
-	for (const sched_list& sched : sch_list)
+	heap_move_overdue(now);
+	if (!sch_heap.empty())
+	{
+		slot = sch_heap[0];
+		diff = sh4_sched_remaining(sch_list[slot], now);
+	}
+	// The remaining time of overdue events is only less than the others' once it has wrapped around
+	for (int id : sch_overdue)
 	{
-		u32 remaining = sh4_sched_remaining(sched, now);
+		u32 remaining = sh4_sched_remaining(sch_list[id], now);
 		if (remaining < diff)
 		{
-			slot = &sched - &sch_list[0];
+			slot = id;
 			diff = remaining;
 		}
 	}
@@ -82,6 +234,7 @@ int sh4_sched_register(int tag, sh4_sched_callback* ssc, void *arg)
 		}
 
 	sch_list.push_back(t);
+	sch_heap_pos.push_back(-1);
 
 	return sch_list.size() - 1;
 }
@@ -91,8 +244,12 @@ void sh4_sched_unregister(int id)
 	if (id == -1)
 		return;
 	verify(id < (int)sch_list.size());
+	heap_remove(id);
 	if (id == (int)sch_list.size() - 1)
+	{
 		sch_list.resize(sch_list.size() - 1);
+		sch_heap_pos.resize(sch_list.size());
+	}
 	else
 	{
 		sch_list[id].cb = nullptr;
@@ -134,6 +291,7 @@ void sh4_sched_request(int id, int cycles)
 		if (sched.end == -1)
 			sched.end++;
 	}
+	heap_update(id);
 
 	sh4_sched_ffts();
 }
@@ -163,6 +321,7 @@ static void handle_cb(sched_list& sched)
 	int jitter = elapsd - remain;
 
 	sched.end = -1;
+	heap_remove(&sched - &sch_list[0]);
 	int re_sch = sched.cb(sched.tag, remain, jitter, sched.arg);
 
 	if (re_sch > 0)
@@ -174,14 +333,38 @@ void sh4_sched_tick(int cycles)
 	if (Sh4cntx.sh4_sched_next >= 0)
 		return;
 
-	u32 fztime = sh4_sched_now() - cycles;
+	const u32 now = sh4_sched_now();
+	const u32 fztime = now - cycles;
 	if (sh4_sched_next_id != -1)
 	{
-		for (sched_list& sched : sch_list)
+		// Callbacks are called in id order. They may schedule, reschedule or cancel other events,
+		// including ones with a higher id that are then due in this tick,
+		// so the candidates are collected again after each call.
+		static std::vector<int> expired;
+		if (sch_heap_dirty)
+			heap_rebuild();
+		int lastId = -1;
+		for (bool collect = true; ; )
 		{
+			if (collect)
+			{
+				expired.clear();
+				heap_expired(0, now, expired);
+				expired.insert(expired.end(), sch_overdue.begin(), sch_overdue.end());
+				std::sort(expired.begin(), expired.end());
+				collect = false;
+			}
+			auto it = std::upper_bound(expired.begin(), expired.end(), lastId);
+			if (it == expired.end())
+				break;
+			lastId = *it;
+			sched_list& sched = sch_list[lastId];
 			int remaining = sh4_sched_remaining(sched, fztime);
 			if (remaining >= 0 && remaining <= (int)cycles)
+			{
 				handle_cb(sched);
+				collect = true;
+			}
 		}
 	}
 	sh4_sched_ffts();
@@ -195,6 +378,7 @@ void sh4_sched_reset(bool hard)
 		sh4_sched_next_id = -1;
 		for (sched_list& sched : sch_list)
 			sched.start = sched.end = -1;
+		heap_rebuild();
 		Sh4cntx.sh4_sched_next = 0;
 	}
 }
@@ -211,6 +395,8 @@ void sh4_sched_deserialize(Deserializer& deser, int id)
 	deser >> sch_list[id].tag;
 	deser >> sch_list[id].start;
 	deser >> sch_list[id].end;
+	// rebuilt by the next sh4_sched_ffts() call
+	sch_heap_dirty = true;
 }
 
 // FIXME modules should save their scheduling data so that it doesn't depend on their scheduler id
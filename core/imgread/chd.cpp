@@ -1,8 +1,13 @@
 #include "common.h"
 #include "stdclass.h"
 #include "oslib/storage.h"
+#include "cfg/option.h"
 
 #include <libchdr/chd.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
 
 struct CHDDisc : Disc
 {
@@ -10,28 +15,139 @@ struct CHDDisc : Disc
 	static constexpr u32 CD_TRACK_PADDING = 4;
 	// lead out, lead in and pregap between 2 sessions of MIL-CDs
 	static constexpr u32 SESSION_GAP = 11400;
+	// number of hunks decompressed ahead of the last one read
+	static constexpr u32 PREFETCH_HUNKS = 2;
 
 	chd_file *chd = nullptr;
 	FILE *fp = nullptr;
-	u8* hunk_mem = nullptr;
-	u32 old_hunk = 0;
 
 	u32 hunkbytes = 0;
+	u32 hunkCount = 0;
 	u32 sph = 0;
 
 	void tryOpen(const char* file);
+	bool readHunk(u32 hunk, u32 offset, u8 *dst, u32 size);
 
 	~CHDDisc() override
 	{
-		delete[] hunk_mem;
+		terminating = true;
+		prefetcher.stop();
+		INFO_LOG(GDROM, "chd: hunk cache hits %d misses %d prefetched %d", hits, misses, prefetched);
 
 		if (chd)
 			chd_close(chd);
 		if (fp)
 			std::fclose(fp);
 	}
+
+private:
+	struct CachedHunk
+	{
+		u32 hunk = ~0u;
+		u64 lastUse = 0;
+		std::unique_ptr<u8[]> data;
+	};
+	CachedHunk *findHunk(u32 hunk);
+	bool decompressHunk(u32 hunk);
+	void prefetch(u32 hunk);
+
+	// Decompressed hunks, least recently used is evicted first
+	std::vector<CachedHunk> cache;
+	u64 useCounter = 0;
+	std::set<u32> prefetchQueue;
+	u32 hits = 0;
+	u32 misses = 0;
+	u32 prefetched = 0;
+	std::mutex cacheMutex;
+
+	// chd_read isn't thread safe
+	std::mutex chdMutex;
+	std::unique_ptr<u8[]> hunkBuffer;
+
+	WorkerThread prefetcher { "CHD prefetch" };
+	std::atomic<bool> terminating { false };
 };
 
+CHDDisc::CachedHunk *CHDDisc::findHunk(u32 hunk)
+{
+	for (CachedHunk& entry : cache)
+		if (entry.hunk == hunk)
+			return &entry;
+	return nullptr;
+}
+
+// Decompress a hunk and add it to the cache
+bool CHDDisc::decompressHunk(u32 hunk)
+{
+	std::lock_guard<std::mutex> chdLock(chdMutex);
+	{
+		std::lock_guard<std::mutex> _(cacheMutex);
+		// may have been decompressed by the prefetcher in the meantime
+		if (findHunk(hunk) != nullptr)
+			return true;
+	}
+	if (chd_read(chd, hunk, hunkBuffer.get()) != CHDERR_NONE)
+		return false;
+
+	std::lock_guard<std::mutex> cacheLock(cacheMutex);
+	CachedHunk *victim = &cache[0];
+	for (CachedHunk& entry : cache)
+		if (entry.lastUse < victim->lastUse)
+			victim = &entry;
+	victim->hunk = hunk;
+	victim->lastUse = ++useCounter;
+	std::swap(victim->data, hunkBuffer);
+
+	return true;
+}
+
+void CHDDisc::prefetch(u32 hunk)
+{
+	// The hunk just read must not be evicted by the prefetched ones
+	if (cache.size() <= PREFETCH_HUNKS + 1)
+		return;
+	for (u32 next = hunk + 1; next <= hunk + PREFETCH_HUNKS && next < hunkCount; next++)
+	{
+		if (findHunk(next) != nullptr || !prefetchQueue.insert(next).second)
+			continue;
+		prefetcher.run([this, next]() {
+			const bool done = !terminating && decompressHunk(next);
+			std::lock_guard<std::mutex> _(cacheMutex);
+			if (done)
+				prefetched++;
+			prefetchQueue.erase(next);
+		});
+	}
+}
+
+bool CHDDisc::readHunk(u32 hunk, u32 offset, u8 *dst, u32 size)
+{
+	std::unique_lock<std::mutex> lock(cacheMutex);
+	CachedHunk *entry = findHunk(hunk);
+	if (entry != nullptr)
+	{
+		hits++;
+	}
+	else
+	{
+		misses++;
+		// Queued prefetches may still evict the hunk before the lock is taken again
+		while (entry == nullptr)
+		{
+			lock.unlock();
+			if (!decompressHunk(hunk))
+				return false;
+			lock.lock();
+			entry = findHunk(hunk);
+		}
+	}
+	entry->lastUse = ++useCounter;
+	memcpy(dst, &entry->data[offset], size);
+	prefetch(hunk);
+
+	return true;
+}
+
 struct CHDTrack : TrackFile
 {
 	CHDDisc* disc;
@@ -51,16 +167,10 @@ struct CHDTrack : TrackFile
 	{
 		u32 fad_offs = FAD + Offset;
 		u32 hunk=(fad_offs)/disc->sph;
-		if (disc->old_hunk!=hunk)
-		{
-			if (chd_read(disc->chd,hunk,disc->hunk_mem) != CHDERR_NONE)
-				return false;
-			disc->old_hunk = hunk;
-		}
-
 		u32 hunk_ofs = fad_offs%disc->sph;
 
-		memcpy(dst, disc->hunk_mem + hunk_ofs * (2352+96), fmt);
+		if (!disc->readHunk(hunk, hunk_ofs * (2352+96), dst, fmt))
+			return false;
 
 		if (swap_bytes)
 		{
@@ -91,6 +201,33 @@ struct CHDTrack : TrackFile
 
 		return true;
 	}
+
+	// Copies the requested sectors of one hunk at a time
+	u32 ReadSectors(u32 FAD, u32 count, u8 *dst, u32 outFmt) override
+	{
+		if (swap_bytes || (outFmt != fmt && (outFmt != 2048 || fmt != 2352)))
+			return 0;
+		u32 fad_offs = FAD + Offset;
+		u32 hunk = fad_offs / disc->sph;
+		u32 hunk_ofs = fad_offs % disc->sph;
+		count = std::min(count, disc->sph - hunk_ofs);
+
+		buffer.resize(disc->hunkbytes);
+		if (!disc->readHunk(hunk, hunk_ofs * (2352+96), buffer.data(), (count - 1) * (2352+96) + fmt))
+			return 0;
+		for (u32 i = 0; i < count; i++)
+		{
+			const u8 *sector = &buffer[i * (2352+96)];
+			if (outFmt == fmt)
+				memcpy(dst + i * outFmt, sector, fmt);
+			else
+				copyUserData(sector, dst + i * outFmt);
+		}
+		return count;
+	}
+
+private:
+	std::vector<u8> buffer;
 };
 
 static u32 getSectorSize(const std::string& type)
@@ -128,8 +265,11 @@ void CHDDisc::tryOpen(const char* file)
 	const chd_header* head = chd_get_header(chd);
 
 	hunkbytes = head->hunkbytes;
-	hunk_mem = new u8[hunkbytes];
-	old_hunk=0xFFFFFFF;
+	hunkCount = head->totalhunks;
+	cache.resize(std::max(1, (int)config::ChdCacheSize));
+	for (CachedHunk& entry : cache)
+		entry.data.reset(new u8[hunkbytes]);
+	hunkBuffer.reset(new u8[hunkbytes]);
 
 	sph = hunkbytes/(2352+96);
 
@@ -4,6 +4,8 @@
 #include "stdclass.h"
 #include "hw/sh4/sh4_sched.h"
 #include "serialize.h"
+#include <algorithm>
+#include <numeric>
 
 Disc* chd_parse(const char* file, std::vector<u8> *digest);
 Disc* gdi_parse(const char* file, std::vector<u8> *digest);
@@ -62,12 +64,7 @@ static bool convertSector(u8* in_buff , u8* out_buff , int from , int to,int sec
 	case 2048:
 		verify(from == 2448 || from == 2352 || from == 2336);
 		if (from == 2352 || from == 2448)
-		{
-			if (in_buff[15] == 1)
-				memcpy(out_buff, &in_buff[0x10], 2048); //0x10 -> mode1
-			else
-				memcpy(out_buff, &in_buff[0x18], 2048); //0x18 -> mode2 (all forms ?)
-		}
+			copyUserData(in_buff, out_buff);
 		else
 			memcpy(out_buff, &in_buff[0x8], 2048);	//hmm only possible on mode2.Skip the mode2 header
 		break;
@@ -251,69 +248,121 @@ DiscType GuessDiscType(bool m1, bool m2, bool da)
 		return CdRom;
 }
 
+const Track *Disc::findTrack(u32 FAD)
+{
+	if (trackIndex.size() != tracks.size())
+	{
+		trackIndex.resize(tracks.size());
+		std::iota(trackIndex.begin(), trackIndex.end(), 0);
+		std::stable_sort(trackIndex.begin(), trackIndex.end(), [this](u32 a, u32 b) {
+			return tracks[a].StartFAD < tracks[b].StartFAD;
+		});
+	}
+	// Last track starting at or before FAD
+	auto it = std::upper_bound(trackIndex.begin(), trackIndex.end(), FAD, [this](u32 fad, u32 i) {
+		return fad < tracks[i].StartFAD;
+	});
+	while (it != trackIndex.begin())
+	{
+		const Track& track = tracks[*--it];
+		if ((FAD <= track.EndFAD || track.EndFAD == 0) && track.file != nullptr)
+			return &track;
+	}
+	return nullptr;
+}
+
 bool Disc::readSector(u32 FAD, u8 *dst, SectorFormat *sector_type, u8 *subcode, SubcodeFormat *subcode_type)
 {
+	*subcode_type = SUBFMT_NONE;
+	const Track *track = findTrack(FAD);
+	if (track != nullptr && track->file->Read(FAD, dst, sector_type, subcode, subcode_type))
+		return true;
+	// Try the other tracks containing this FAD, if any
 	for (size_t i = tracks.size(); i-- > 0; )
 	{
+		if (&tracks[i] == track)
+			continue;
 		*subcode_type = SUBFMT_NONE;
 		if (tracks[i].Read(FAD, dst, sector_type, subcode, subcode_type))
 			return true;
 	}
-
 	return false;
 }
 
-void Disc::ReadSectors(u32 FAD, u32 count, u8* dst, u32 fmt, LoadProgress *progress)
+void Disc::readSectorConverted(u32 FAD, u8 *dst, u32 fmt)
 {
 	u8 temp[2448];
 	SectorFormat secfmt;
 	SubcodeFormat subfmt;
 
-	for (u32 i = 1; i <= count; i++)
+	if (readSector(FAD, temp, &secfmt, q_subchannel, &subfmt))
+	{
+		//TODO: Proper sector conversions
+		if (secfmt==SECFMT_2352)
+		{
+			convertSector(temp,dst,2352,fmt,FAD);
+		}
+		else if (fmt == 2048 && secfmt==SECFMT_2336_MODE2)
+			memcpy(dst,temp+8,2048);
+		else if (fmt==2048 && (secfmt==SECFMT_2048_MODE1 || secfmt==SECFMT_2048_MODE2_FORM1 ))
+		{
+			memcpy(dst,temp,2048);
+		}
+		else if (fmt==2352 && (secfmt==SECFMT_2048_MODE1 || secfmt==SECFMT_2048_MODE2_FORM1 ))
+		{
+			INFO_LOG(GDROM, "GDR:fmt=2352;secfmt=2048");
+			memcpy(dst,temp,2048);
+		}
+		else if (fmt==2048 && secfmt==SECFMT_2448_MODE2)
+		{
+			// Pier Solar and the Great Architects
+			convertSector(temp, dst, 2448, fmt, FAD);
+		}
+		else
+		{
+			WARN_LOG(GDROM, "ERROR: UNABLE TO CONVERT SECTOR. THIS IS FATAL. Format: %d Sector format: %d", fmt, secfmt);
+			//verify(false);
+		}
+	}
+	else
+	{
+		WARN_LOG(GDROM, "Sector Read miss FAD: %d", FAD);
+		memset(dst, 0, fmt);
+	}
+}
+
+void Disc::ReadSectors(u32 FAD, u32 count, u8* dst, u32 fmt, LoadProgress *progress)
+{
+	// Limit the size of bulk reads to update the progress regularly
+	constexpr u32 MaxBulkSectors = 512;
+
+	for (u32 i = 0; i < count; )
 	{
 		if (progress != nullptr)
 		{
 			if (progress->cancelled)
 				throw LoadCancelledException();
 			progress->label = "Loading...";
-			progress->progress = (float)i / count;
+			progress->progress = (float)(i + 1) / count;
 		}
-		if (readSector(FAD, temp, &secfmt, q_subchannel, &subfmt))
+		// Read as many sectors as possible from the same track in one go
+		u32 read = 0;
+		const Track *track = findTrack(FAD);
+		if (track != nullptr && (fmt == 2048 || fmt == 2352))
 		{
-			//TODO: Proper sector conversions
-			if (secfmt==SECFMT_2352)
-			{
-				convertSector(temp,dst,2352,fmt,FAD);
-			}
-			else if (fmt == 2048 && secfmt==SECFMT_2336_MODE2)
-				memcpy(dst,temp+8,2048);
-			else if (fmt==2048 && (secfmt==SECFMT_2048_MODE1 || secfmt==SECFMT_2048_MODE2_FORM1 ))
-			{
-				memcpy(dst,temp,2048);
-			}
-			else if (fmt==2352 && (secfmt==SECFMT_2048_MODE1 || secfmt==SECFMT_2048_MODE2_FORM1 ))
-			{
-				INFO_LOG(GDROM, "GDR:fmt=2352;secfmt=2048");
-				memcpy(dst,temp,2048);
-			}
-			else if (fmt==2048 && secfmt==SECFMT_2448_MODE2)
-			{
-				// Pier Solar and the Great Architects
-				convertSector(temp, dst, 2448, fmt, FAD);
-			}
-			else
-			{
-				WARN_LOG(GDROM, "ERROR: UNABLE TO CONVERT SECTOR. THIS IS FATAL. Format: %d Sector format: %d", fmt, secfmt);
-				//verify(false);
-			}
+			u32 bulkCount = std::min(count - i, MaxBulkSectors);
+			if (track->EndFAD != 0)
+				bulkCount = std::min(bulkCount, track->EndFAD - FAD + 1);
+			read = track->file->ReadSectors(FAD, bulkCount, dst, fmt);
 		}
-		else
+		if (read == 0)
 		{
-			WARN_LOG(GDROM, "Sector Read miss FAD: %d", FAD);
-			memset(dst, 0, fmt);
+			readSectorConverted(FAD, dst, fmt);
+			read = 1;
 		}
-		dst+=fmt;
-		FAD++;
+		dst += read * fmt;
+		FAD += read;
+		i += read;
 	}
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "types.h"
 #include <vector>
+#include <cstring>
 
 #include "emulator.h"
 #include "hw/gdrom/gdrom_if.h"
@@ -74,6 +75,12 @@ struct Session
 struct TrackFile
 {
 	virtual bool Read(u32 FAD, u8 *dst, SectorFormat *sector_type, u8 *subcode, SubcodeFormat *subcode_type) = 0;
+	// Read up to count consecutive sectors converted to the given format (2048 or 2352) into dst.
+	// Returns the number of sectors read, or 0 if the conversion isn't supported.
+	// Only implemented by track files without subcode data, since the Q subchannel isn't updated.
+	virtual u32 ReadSectors(u32 FAD, u32 count, u8 *dst, u32 fmt) {
+		return 0;
+	}
 	virtual ~TrackFile() = default;
 };
 
@@ -201,9 +208,23 @@ struct Disc
 	}
 
 private:
+	const Track *findTrack(u32 FAD);
 	bool readSector(u32 FAD, u8 *dst, SectorFormat *sector_type, u8 *subcode, SubcodeFormat *subcode_type);
+	void readSectorConverted(u32 FAD, u8 *dst, u32 fmt);
+
+	// track indices sorted by start FAD
+	std::vector<u32> trackIndex;
 };
 
+// Copy the user data of a raw mode 1 or mode 2 form 1 sector
+static inline void copyUserData(const u8 *rawSector, u8 *dst)
+{
+	if (rawSector[15] == 1)
+		memcpy(dst, &rawSector[0x10], 2048);	// mode 1
+	else
+		memcpy(dst, &rawSector[0x18], 2048);	// mode 2 (all forms ?)
+}
+
 Disc* OpenDisc(const std::string& path, std::vector<u8> *digest = nullptr);
 
 struct RawTrackFile : TrackFile
@@ -211,6 +232,7 @@ struct RawTrackFile : TrackFile
 	FILE *file;
 	s32 offset;
 	u32 fmt;
+	std::vector<u8> buffer;
 
 	RawTrackFile(FILE *file, u32 file_offs, u32 first_fad, u32 secfmt)
 	{
@@ -245,6 +267,22 @@ struct RawTrackFile : TrackFile
 		return true;
 	}
 
+	u32 ReadSectors(u32 FAD, u32 count, u8 *dst, u32 outFmt) override
+	{
+		std::fseek(file, offset + FAD * fmt, SEEK_SET);
+		if (fmt == outFmt)
+			return (u32)std::fread(dst, fmt, count, file);
+		if (fmt != 2352 || outFmt != 2048)
+			return 0;
+
+		count = std::min<u32>(count, 64);
+		buffer.resize(count * fmt);
+		count = (u32)std::fread(buffer.data(), fmt, count, file);
+		for (u32 i = 0; i < count; i++)
+			copyUserData(&buffer[i * fmt], dst + i * outFmt);
+		return count;
+	}
+
 	~RawTrackFile() override
 	{
 		std::fclose(file);
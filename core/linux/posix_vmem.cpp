@@ -245,6 +245,30 @@ void create_mappings(const Mapping *vmem_maps, unsigned nummaps) {
 	}
 }
 
+void *reserve_mirror(size_t size)
+{
+	if (vmem_fd < 0)
+		return nullptr;
+	return mem_region_reserve(nullptr, size);
+}
+
+void release_mirror(void *base, size_t size)
+{
+	mem_region_release(base, size);
+}
+
+bool map_mirror(void *dest, size_t memoffset, size_t size, bool allow_writes)
+{
+	return mem_region_map_file((void*)(uintptr_t)vmem_fd, dest, size, memoffset, allow_writes) != nullptr;
+}
+
+void unmap_mirror(void *dest, size_t size)
+{
+	// Replacing the mappings is cheaper than unmapping and reserving again
+	void *p = mmap(dest, size, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_FIXED, -1, 0);
+	verify(p == dest);
+}
+
 // Prepares the code region for JIT operations, thus marking it as RWX
 bool prepare_jit_block(void *code_area, size_t size, void **code_area_rwx)
 {
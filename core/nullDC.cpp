@@ -16,6 +16,8 @@
 #include "stdclass.h"
 #include "serialize.h"
 #include <time.h>
+#include <map>
+#include <mutex>
 
 struct SavestateHeader
 {
@@ -40,6 +42,33 @@ struct SavestateHeader
 	static constexpr const char *MAGIC = "FLYSAVE1";
 };
 
+// Savestates are compressed and written to disk in the background
+static WorkerThread savestateThread("Savestate");
+// Creation date of the savestates being written, by slot
+static std::map<int, u64> pendingSavestates;
+// Notifications from the savestate thread, shown by the UI thread
+static std::vector<std::pair<std::string, int>> savestateMessages;
+static std::mutex pendingMutex;
+
+static void savestateNotify(const char *msg, int durationMs)
+{
+	std::lock_guard<std::mutex> _(pendingMutex);
+	savestateMessages.emplace_back(msg, durationMs);
+}
+
+void dc_savestateNotify()
+{
+	std::vector<std::pair<std::string, int>> messages;
+	{
+		std::lock_guard<std::mutex> _(pendingMutex);
+		if (savestateMessages.empty())
+			return;
+		std::swap(messages, savestateMessages);
+	}
+	for (const auto& msg : messages)
+		os_notify(msg.first.c_str(), msg.second);
+}
+
 int flycast_init(int argc, char* argv[])
 {
 #if defined(TEST_AUTOMATION)
@@ -108,6 +137,7 @@ void SaveSettings()
 
 void flycast_term()
 {
+	savestateThread.stop();
 	gui_cancel_load();
 	lua::term();
 	emu.term();
@@ -116,64 +146,43 @@ void flycast_term()
 	os_TermInput();
 }
 
-void dc_savestate(int index, const u8 *pngData, u32 pngSize)
+static void writeSavestate(const std::string& filename, const SavestateHeader& header, const std::vector<u8>& pngData, void *data, u32 size)
 {
-	if (settings.network.online)
-		return;
-
-	Serializer ser;
-	dc_serialize(ser);
-
-	void *data = malloc(ser.size());
-	if (data == nullptr)
-	{
-		WARN_LOG(SAVESTATE, "Failed to save state - could not malloc %d bytes", (int)ser.size());
-		os_notify("Save state failed - memory full", 5000);
-    	return;
-	}
-
-	ser = Serializer(data, ser.size());
-	dc_serialize(ser);
-
-	std::string filename = hostfs::getSavestatePath(index, true);
 	FILE *f = nowide::fopen(filename.c_str(), "wb");
 	if (f == nullptr)
 	{
 		WARN_LOG(SAVESTATE, "Failed to save state - could not open %s for writing", filename.c_str());
-		os_notify("Cannot open save file", 5000);
+		savestateNotify("Cannot open save file", 5000);
 		free(data);
     	return;
 	}
 
 	RZipFile zipFile;
-	SavestateHeader header;
-	header.init();
-	header.pngSize = pngSize;
 	if (std::fwrite(&header, sizeof(header), 1, f) != 1)
 		goto fail;
-	if (pngSize > 0 && std::fwrite(pngData, 1, pngSize, f) != pngSize)
+	if (!pngData.empty() && std::fwrite(pngData.data(), 1, pngData.size(), f) != pngData.size())
 		goto fail;
 
 #if 0
 	// Uncompressed savestate
-	std::fwrite(data, 1, ser.size(), f);
+	std::fwrite(data, 1, size, f);
 	std::fclose(f);
 #else
 	if (!zipFile.Open(f, true))
 		goto fail;
-	if (zipFile.Write(data, ser.size()) != ser.size())
+	if (zipFile.Write(data, size) != size)
 		goto fail;
 	zipFile.Close();
 #endif
 
 	free(data);
-	NOTICE_LOG(SAVESTATE, "Saved state to %s size %d", filename.c_str(), (int)ser.size());
-	os_notify("State saved", 2000);
+	NOTICE_LOG(SAVESTATE, "Saved state to %s size %d", filename.c_str(), size);
+	savestateNotify("State saved", 2000);
 	return;
 
 fail:
 	WARN_LOG(SAVESTATE, "Failed to save state - error writing %s", filename.c_str());
-	os_notify("Error saving state", 5000);
+	savestateNotify("Error saving state", 5000);
 	if (zipFile.rawFile() != nullptr)
 		zipFile.Close();
 	else
@@ -182,10 +191,51 @@ fail:
 	// delete failed savestate?
 }
 
+void dc_savestate(int index, const u8 *pngData, u32 pngSize)
+{
+	if (settings.network.online)
+		return;
+
+	Serializer ser;
+	dc_serialize(ser);
+
+	void *data = malloc(ser.size());
+	if (data == nullptr)
+	{
+		WARN_LOG(SAVESTATE, "Failed to save state - could not malloc %d bytes", (int)ser.size());
+		os_notify("Save state failed - memory full", 5000);
+    	return;
+	}
+
+	ser = Serializer(data, ser.size());
+	dc_serialize(ser);
+
+	// Only the serialization needs the emulator to be stopped
+	SavestateHeader header;
+	header.init();
+	header.pngSize = pngSize;
+	std::vector<u8> png(pngData, pngData + pngSize);
+	u32 size = (u32)ser.size();
+	// The game may be unloaded before the state is written
+	std::string filename = hostfs::getSavestatePath(index, true);
+	{
+		std::lock_guard<std::mutex> _(pendingMutex);
+		pendingSavestates[index] = header.creationDate;
+	}
+	savestateThread.run([index, filename, header, png = std::move(png), data, size]() {
+		writeSavestate(filename, header, png, data, size);
+		std::lock_guard<std::mutex> _(pendingMutex);
+		auto it = pendingSavestates.find(index);
+		if (it != pendingSavestates.end() && it->second == header.creationDate)
+			pendingSavestates.erase(it);
+	});
+}
+
 void dc_loadstate(int index)
 {
 	if (settings.raHardcoreMode)
 		return;
+	savestateThread.flush();
 	u32 total_size = 0;
 
 	std::string filename = hostfs::getSavestatePath(index, false);
@@ -277,6 +327,12 @@ void dc_loadstate(int index)
 
 time_t dc_getStateCreationDate(int index)
 {
+	{
+		std::lock_guard<std::mutex> _(pendingMutex);
+		auto it = pendingSavestates.find(index);
+		if (it != pendingSavestates.end())
+			return (time_t)it->second;
+	}
 	std::string filename = hostfs::getSavestatePath(index, false);
 	FILE *f = nowide::fopen(filename.c_str(), "rb");
 	if (f == nullptr)
@@ -297,6 +353,7 @@ time_t dc_getStateCreationDate(int index)
 
 void dc_getStateScreenshot(int index, std::vector<u8>& pngData)
 {
+	savestateThread.flush();
 	pngData.clear();
 	std::string filename = hostfs::getSavestatePath(index, false);
 	FILE *f = nowide::fopen(filename.c_str(), "rb");
@@ -19,6 +19,14 @@ void reset_mem(void *ptr, unsigned size_bytes);
 void ondemand_page(void *address, unsigned size_bytes);
 // To create the mappings in the address space.
 void create_mappings(const Mapping *vmem_maps, unsigned nummaps);
+// Reserves an inaccessible address range where parts of the memory file can be mapped individually.
+// Returns nullptr if not supported.
+void *reserve_mirror(size_t size);
+void release_mirror(void *base, size_t size);
+// Maps a page-aligned range of the memory file into a mirror
+bool map_mirror(void *dest, size_t memoffset, size_t size, bool allow_writes);
+// Makes a range of a mirror inaccessible again
+void unmap_mirror(void *dest, size_t size);
 // Just tries to wipe as much as possible in the relevant area.
 void destroy();
 // Given a block of data in the .text section, prepares it for JIT action.
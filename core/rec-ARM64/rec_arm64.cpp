@@ -262,6 +262,20 @@ public:
 		// run register allocator
 		regalloc.DoAlloc(block);
 
+		if (block->hot_counter != 0)
+		{
+			// Unoptimized block: count executions
+			Label not_hot;
+			Mov(x9, reinterpret_cast<uintptr_t>(&block->hot_counter));
+			Ldr(w10, MemOperand(x9));
+			Subs(w10, w10, 1);
+			Str(w10, MemOperand(x9));
+			B(&not_hot, ne);
+			Mov(x0, reinterpret_cast<uintptr_t>(block));
+			GenCallRuntime(rdv_BlockHot);
+			Bind(&not_hot);
+		}
+
 		// scheduler
 		Ldr(w1, sh4_context_mem_operand(&Sh4cntx.cycle_counter));
 		Cmp(w1, 0);
@@ -2272,6 +2286,10 @@ public:
 		return new DynaRBI(*codeBuffer);
 	}
 
+	bool supportsTiering() override {
+		return true;
+	}
+
 	void handleException(host_context_t &context) override
 	{
 		context.pc = (uintptr_t)::handleException;
@@ -47,11 +47,15 @@ namespace MemType {
 		Fast,
 		StoreQueue,
 		Slow,
+		Mmu,
+		MmuSlow,
 		Count
 	};
 }
 
 static const void *MemHandlers[MemType::Count][MemSize::Count][MemOp::Count];
+// Host instruction accessing the MMU mirror in each MemType::Mmu handler
+static const u8 *MmuAccessInsn[MemSize::Count][MemOp::Count];
 static const u8 *MemHandlerStart, *MemHandlerEnd;
 static UnwindInfo unwinder;
 #ifndef _WIN32
@@ -144,6 +148,17 @@ public:
 			jmp(exit_block, T_NEAR);
 			L(fpu_enabled);
 		}
+		if (block->hot_counter != 0)
+		{
+			// Unoptimized block: count executions
+			Xbyak::Label not_hot;
+			mov(rax, (uintptr_t)&block->hot_counter);
+			sub(dword[rax], 1);
+			jnz(not_hot);
+			mov(call_regs64[0], (uintptr_t)block);
+			GenCall(rdv_BlockHot, true);
+			L(not_hot);
+		}
 		mov(rax, (uintptr_t)&p_sh4rcb->cntx.cycle_counter);
 		sub(dword[rax], block->guest_cycles);
 
@@ -228,10 +243,17 @@ public:
 							add(call_regs[0], dword[rax]);
 						}
 					}
-					genMmuLookup(block, op, 0);
-
 					int size = op.size == 1 ? MemSize::S8 : op.size == 2 ? MemSize::S16 : op.size == 4 ? MemSize::S32 : MemSize::S64;
-					GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::R], mmu_enabled());
+					if (optimise && mmu_enabled() && addrspace::mmuMirrorEnabled())
+					{
+						mov(call_regs[2], block->vaddr + op.guest_offs - (op.delay_slot ? 2 : 0));	// pc
+						GenCall((void (*)())MemHandlers[MemType::Mmu][size][MemOp::R], true);
+					}
+					else
+					{
+						genMmuLookup(block, op, 0);
+						GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::R], mmu_enabled());
+					}
 
 #if ALLOC_F64 == false
 					if (size == MemSize::S64)
@@ -265,7 +287,9 @@ public:
 							add(call_regs[0], dword[rax]);
 						}
 					}
-					genMmuLookup(block, op, 1);
+					const bool mmuMirror = optimise && mmu_enabled() && addrspace::mmuMirrorEnabled();
+					if (!mmuMirror)
+						genMmuLookup(block, op, 1);
 
 #if ALLOC_F64 == false
 					if (op.size == 8)
@@ -278,7 +302,13 @@ public:
 						shil_param_to_host_reg(op.rs2, call_regs64[1]);
 
 					int size = op.size == 1 ? MemSize::S8 : op.size == 2 ? MemSize::S16 : op.size == 4 ? MemSize::S32 : MemSize::S64;
-					GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::W], mmu_enabled());
+					if (mmuMirror)
+					{
+						mov(call_regs[2], block->vaddr + op.guest_offs - (op.delay_slot ? 2 : 0));	// pc
+						GenCall((void (*)())MemHandlers[MemType::Mmu][size][MemOp::W], true);
+					}
+					else
+						GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::W], mmu_enabled());
 				}
 			}
 			break;
@@ -312,7 +342,8 @@ public:
 					Xbyak::Reg32 rd = regalloc.MapRegister(op.rd);
 					if (op.rs1.is_imm())
 						mov(rd, op.rs1.imm_value());
-					else if (regalloc.mapg(op.rd) != regalloc.mapg(op.rs1))
+					else
+						// also clears the upper 32 bits when rd and rs1 share the same host register
 						mov(rd, regalloc.MapRegister(op.rs1));
 					Xbyak::Reg64 rd64 = rd.cvt64();
 					neg(rd64);
@@ -1149,6 +1180,109 @@ private:
 							break;
 						}
 					}
+					else if (type == MemType::Mmu)
+					{
+#ifdef FAST_MMU
+						// Direct access through the host mirror of the guest virtual address space.
+						// Unmapped or protected pages fault and are redirected to the MmuSlow handler.
+						mov(rax, (uintptr_t)&addrspace::mmu_base);
+						mov(rax, qword[rax]);
+						MmuAccessInsn[size][op] = getCurr();
+
+						switch (size)
+						{
+						case MemSize::S8:
+							if (op == MemOp::R)
+								movsx(eax, byte[rax + call_regs64[0]]);
+							else
+								mov(byte[rax + call_regs64[0]], call_regs[1].cvt8());
+							break;
+
+						case MemSize::S16:
+							if (op == MemOp::R)
+								movsx(eax, word[rax + call_regs64[0]]);
+							else
+								mov(word[rax + call_regs64[0]], call_regs[1].cvt16());
+							break;
+
+						case MemSize::S32:
+							if (op == MemOp::R)
+								mov(eax, dword[rax + call_regs64[0]]);
+							else
+								mov(dword[rax + call_regs64[0]], call_regs[1]);
+							break;
+
+						case MemSize::S64:
+							if (op == MemOp::R)
+								mov(rax, qword[rax + call_regs64[0]]);
+							else
+								mov(qword[rax + call_regs64[0]], call_regs64[1]);
+							break;
+						}
+#endif
+					}
+					else if (type == MemType::MmuSlow)
+					{
+#ifdef FAST_MMU
+						if (op == MemOp::R)
+						{
+							switch (size) {
+							case MemSize::S8:
+								sub(rsp, STACK_ALIGN);
+								call((const void *)mmuMirrorRead<u8>);
+								movsx(eax, al);
+								add(rsp, STACK_ALIGN);
+								break;
+							case MemSize::S16:
+								sub(rsp, STACK_ALIGN);
+								call((const void *)mmuMirrorRead<u16>);
+								movsx(eax, ax);
+								add(rsp, STACK_ALIGN);
+								break;
+							case MemSize::S32:
+								jmp((const void *)mmuMirrorRead<u32>);	// tail call
+								continue;
+							case MemSize::S64:
+								jmp((const void *)mmuMirrorRead<u64>);	// tail call
+								continue;
+							}
+						}
+						else
+						{
+							if (size >= MemSize::S32)
+							{
+								// Store queue writes aren't translated
+								Xbyak::Label no_sqw;
+								mov(r9d, call_regs[0]);
+								shr(r9d, 26);
+								cmp(r9d, 0x38);
+								jne(no_sqw);
+								mov(rax, (uintptr_t)p_sh4rcb->sq_buffer);
+								and_(call_regs[0], 0x3F);
+								if (size == MemSize::S32)
+									mov(dword[rax + call_regs64[0]], call_regs[1]);
+								else
+									mov(qword[rax + call_regs64[0]], call_regs64[1]);
+								ret();
+								L(no_sqw);
+							}
+							switch (size) {
+							case MemSize::S8:
+								jmp((const void *)mmuMirrorWrite<u8>);	// tail call
+								continue;
+							case MemSize::S16:
+								jmp((const void *)mmuMirrorWrite<u16>);	// tail call
+								continue;
+							case MemSize::S32:
+								jmp((const void *)mmuMirrorWrite<u32>);	// tail call
+								continue;
+							case MemSize::S64:
+								jmp((const void *)mmuMirrorWrite<u64>);	// tail call
+								continue;
+							}
+						}
+#endif
+					}
 					else if (type == MemType::StoreQueue)
 					{
 						if (op != MemOp::W || size < MemSize::S32)
@@ -1363,6 +1497,25 @@ public:
 		if (codeBuffer == nullptr)
 			// init() not called yet
 			return false;
+		// MMU mirror access to an unmapped or protected page: continue in the slow handler
+		for (int size = 0; size < MemSize::Count; size++)
+			for (int op = 0; op < MemOp::Count; op++)
+				if (MmuAccessInsn[size][op] != nullptr && context.pc == (uintptr_t)MmuAccessInsn[size][op])
+				{
+#ifdef FAST_MMU
+#ifdef _WIN32
+					const u32 vaddr = context.rcx;
+#else
+					const u32 vaddr = context.rdi;
+#endif
+					// Areas that are never mirrored (store queue, MMIO...) would fault on each access,
+					// so the call site is rewritten to use the slow handler
+					if (!mmuMirrorMappable(vaddr) && !rewriteCall(*(u8 **)context.rsp - 5, MemHandlers[MemType::MmuSlow][size][op]))
+						return false;
+#endif
+					context.pc = (uintptr_t)MemHandlers[MemType::MmuSlow][size][op];
+					return true;
+				}
 		void* protStart = codeBuffer->get();
 		size_t protSize = codeBuffer->getFreeSpace();
 		virtmem::jit_set_exec(protStart, protSize, false);
@@ -1379,6 +1532,32 @@ public:
 		return rc;
 	}
 
+	// Replace the target of the call instruction at the given address
+	bool rewriteCall(u8 *callSite, const void *function)
+	{
+		void* protStart = codeBuffer->get();
+		size_t protSize = codeBuffer->getFreeSpace();
+		virtmem::jit_set_exec(protStart, protSize, false);
+
+		BlockCompiler compiler(*codeBuffer, callSite);
+		bool rc = false;
+		try {
+			const u8 *start = compiler.getCurr();
+			compiler.call(function);
+			verify(compiler.getCurr() - start == 5);
+			compiler.ready();
+			rc = true;
+		} catch (const Xbyak::Error& e) {
+			ERROR_LOG(DYNAREC, "Fatal xbyak error: %s", e.what());
+		}
+		virtmem::jit_set_exec(protStart, protSize, true);
+		return rc;
+	}
+
+	bool supportsTiering() override {
+		return true;
+	}
+
 	void handleException(host_context_t &context) override
 	{
 		context.pc = (uintptr_t)::handleException;
@@ -454,6 +454,11 @@ protected:
 					rs2 = mapRegister(op.rs2);
 				else
 					mov(rs2, op.rs2.imm_value());
+				if (rd == rs1 && rd == rs2)
+				{
+					rol(rd, 16);
+					break;
+				}
 				if (rd == rs2)
 				{
 					shl(rd, 16);
@@ -3,16 +3,21 @@
 #include "deps/xbrz/xbrz.h"
 #include "hw/pvr/pvr_mem.h"
 #include "hw/mem/addrspace.h"
+#include "stdclass.h"
 
 #include <algorithm>
+#include <deque>
 #include <mutex>
+#include <thread>
+#define XXH_STATIC_LINKING_ONLY
 #include <xxhash.h>
 
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
-const u8 *vq_codebook;
+// Thread local so that VQ textures can be decoded concurrently
+thread_local const u8 *vq_codebook;
 u32 palette_index;
 bool KillTex=false;
 u32 palette16_ram[1024];
@@ -165,6 +170,8 @@ void palette_update()
 }
 
 static std::vector<vram_block*> VramLocks[VRAM_SIZE_MAX / PAGE_SIZE];
+// Incremented each time a locked vram page is written
+static u32 VramPageGeneration[VRAM_SIZE_MAX / PAGE_SIZE];
 
 //List functions
 //
@@ -230,6 +237,7 @@ bool VramLockedWriteOffset(size_t offset)
 			}
 		}
 		list.clear();
+		VramPageGeneration[addr_hash]++;
 
 		addrspace::unprotectVram((u32)(offset & ~PAGE_MASK), PAGE_SIZE);
 	}
@@ -280,6 +288,41 @@ void parallelize(Func func, int start, int end)
 
 static struct xbrz::ScalerCfg xbrz_cfg;
 
+//
+// Pool of threads decoding textures when config::AsyncTextureDecode is enabled.
+// Tasks are dispatched round-robin.
+//
+class TextureDecoder
+{
+public:
+	TextureDecoder()
+	{
+		int count = std::clamp((int)std::thread::hardware_concurrency() / 2, 1, 4);
+		for (int i = 0; i < count; i++)
+			threads.emplace_back("TexDecoder");
+	}
+
+	void run(WorkerThread::Function&& task) {
+		threads[next++ % threads.size()].run(std::move(task));
+	}
+
+	void flush()
+	{
+		for (WorkerThread& thread : threads)
+			thread.flush();
+	}
+
+private:
+	std::deque<WorkerThread> threads;
+	u32 next = 0;
+};
+static TextureDecoder textureDecoder;
+
+// Limits the number of asynchronously decoded textures uploaded each frame
+constexpr int MaxAsyncUploadsPerFrame = 16;
+static u32 asyncUploadFrame;
+static int asyncUploads;
+
 void UpscalexBRZ(int factor, u32* source, u32* dest, int width, int height, bool has_alpha)
 {
 #ifdef _OPENMP
@@ -390,6 +433,12 @@ void BaseTextureCacheData::PrintTextureName()
 
 //true if : dirty or paletted texture and hashes don't match
 bool BaseTextureCacheData::NeedsUpdate() {
+	if (decode_in_progress > 0)
+		// Keep using the previous version if any
+		return !hasGpuTexture;
+	if (decoded != nullptr)
+		// Ready to be uploaded
+		return true;
 	bool rc = dirty != 0;
 	if (tex_type != TextureType::_8)
 	{
@@ -442,17 +491,56 @@ void BaseTextureCacheData::unprotectVRam()
 	if (lock_block)
 		libCore_vramlock_Unlock_block_wb(lock_block);
 	lock_block = nullptr;
+	// Changes are no longer tracked
+	dataHash = 0;
+}
+
+bool BaseTextureCacheData::DataChanged(u32 stride, u32 heightLimit)
+{
+	u32 end = std::min(mmStartAddress + size - 1, VRAM_SIZE - 1);
+	// Everything the decoded texture depends on besides vram.
+	// The palette hash is only meaningful for paletted textures.
+	const u32 params[] = {
+		IsPaletted() ? palette_hash : 0, (u32)tex_type, gpuPalette, stride, heightLimit,
+		(u32)config::TextureUpscale, (u32)config::MaxFilteredTextureSize, IsMipmapped()
+	};
+	u64 paramsHash = XXH3_64bits(params, sizeof(params));
+	u64 generation = 0;
+	{
+		std::lock_guard<std::mutex> lock(vramlist_lock);
+		if (lock_block != nullptr)
+			for (u32 page = startAddress / PAGE_SIZE; page <= end / PAGE_SIZE; page++)
+				generation += VramPageGeneration[page];
+		else
+			// Not protected so writes aren't tracked
+			dataHash = 0;
+	}
+	bool changed = paramsHash != this->paramsHash;
+	this->paramsHash = paramsHash;
+	if (dataHash != 0 && generation == pageGeneration)
+		// None of the texture pages has been written to
+		return changed;
+
+	u64 hash = XXH3_64bits(&vram[startAddress], end - startAddress + 1);
+	changed = changed || hash != dataHash;
+	dataHash = hash;
+	pageGeneration = generation;
+
+	return changed;
 }
 
 bool BaseTextureCacheData::Delete()
 {
 	unprotectVRam();
 
-	if (custom_load_in_progress > 0)
+	if (custom_load_in_progress > 0 || decode_in_progress > 0)
 		return false;
 
 	free(custom_image_data);
 	custom_image_data = nullptr;
+	decoded.reset();
+	hasGpuTexture = false;
+	gpuSize = 0;
 
 	return true;
 }
@@ -472,6 +560,13 @@ BaseTextureCacheData::BaseTextureCacheData(TSP tsp, TCW tcw)
 	custom_image_data = nullptr;
 	custom_load_in_progress = 0;
 	gpuPalette = false;
+	decode_in_progress = 0;
+	hasGpuTexture = false;
+	dataHash = 0;
+	paramsHash = 0;
+	pageGeneration = 0;
+	lastUsed = FrameCount;
+	gpuSize = 0;
 
 	//decode info from tsp/tcw into the texture struct
 	tex = &pvrTexInfo[tcw.PixelFmt == PixelReserved ? Pixel1555 : tcw.PixelFmt];	//texture format table entry
@@ -589,10 +684,16 @@ void BaseTextureCacheData::ComputeHash()
 
 bool BaseTextureCacheData::Update()
 {
+	if (decode_in_progress > 0)
+		return hasGpuTexture;
+	if (decoded != nullptr)
+		return InstallDecoded();
+
 	//texture state tracking stuff
 	Updates++;
 	dirty = 0;
 	gpuPalette = false;
+	const TextureType previousType = tex_type;
 	tex_type = tex->type;
 
 	bool has_alpha = false;
@@ -624,9 +725,6 @@ bool BaseTextureCacheData::Update()
 		}
 	}
 
-	if (tcw.VQ_Comp)
-		::vq_codebook = &vram[startAddress];
-
 	//texture conversion work
 	u32 stride = width;
 
@@ -658,16 +756,60 @@ bool BaseTextureCacheData::Update()
 			return false;
 		}
 	}
+	//lock the texture to detect changes in it
+	protectVRam();
+	if (!DataChanged(stride, heightLimit) && hasGpuTexture)
+	{
+		// Same data as the current version
+		tex_type = previousType;
+		size = originalSize;
+		return true;
+	}
+
 	if (config::CustomTextures)
 		custom_texture.LoadCustomTextureAsync(this);
 
-	void *temp_tex_buffer = NULL;
-	u32 upscaled_w = width;
-	u32 upscaled_h = height;
+	// Paletted textures are decoded with the current palette so they can't be deferred
+	if (config::AsyncTextureDecode && !IsPaletted() && !config::DumpTextures)
+	{
+		size = originalSize;
+
+		decoded = std::make_unique<DecodedTexture>();
+		DecodedTexture *image = decoded.get();
+		TextureType type = tex_type;
+		decode_in_progress++;
+		textureDecoder.run([this, image, type, stride, heightLimit, has_alpha]() {
+			Decode(*image, type, stride, heightLimit, has_alpha);
+			decode_in_progress--;
+		});
+		// Use the previous version until the new one is ready
+		return hasGpuTexture;
+	}
 
-	PixelBuffer<u16> pb16;
-	PixelBuffer<u32> pb32;
-	PixelBuffer<u8> pb8;
+	DecodedTexture image;
+	Decode(image, tex_type, stride, heightLimit, has_alpha);
+	Upload(image);
+	if (config::DumpTextures)
+	{
+		ComputeHash();
+		custom_texture.DumpTexture(texture_hash, image.width, image.height, tex_type, (void *)image.data);
+		NOTICE_LOG(RENDERER, "Dumped texture %x.png. Old hash %x", texture_hash, old_texture_hash);
+	}
+	PrintTextureName();
+	// Restore the original texture size if it was constrained to VRAM limits above
+	size = originalSize;
+
+	return true;
+}
+
+// Convert the texture from vram. Can be called by a decoder thread.
+void BaseTextureCacheData::Decode(DecodedTexture& image, TextureType type, u32 stride, u32 heightLimit, bool has_alpha)
+{
+	if (tcw.VQ_Comp)
+		::vq_codebook = &vram[startAddress];
+	image.type = type;
+	image.width = width;
+	image.height = height;
 
 	// Figure out if we really need to use a 32-bit pixel buffer
 	bool textureUpscaling = config::TextureUpscale > 1
@@ -677,28 +819,28 @@ bool BaseTextureCacheData::Update()
 			&& tcw.PixelFmt != PixelYUV;
 	bool need_32bit_buffer = true;
 	if (!textureUpscaling
-		&& (!IsPaletted() || tex_type != TextureType::_8888)
+		&& (!IsPaletted() || type != TextureType::_8888)
 		&& texconv != NULL
-		&& !Force32BitTexture(tex_type))
+		&& !Force32BitTexture(type))
 		need_32bit_buffer = false;
 	// TODO avoid upscaling/depost. textures that change too often
 
-	bool mipmapped = IsMipmapped() && !config::DumpTextures;
+	image.mipmapsIncluded = IsMipmapped() && !config::DumpTextures;
 
 	if (texconv32 != NULL && need_32bit_buffer)
 	{
 		if (textureUpscaling)
 			// don't use mipmaps if upscaling
-			mipmapped = false;
+			image.mipmapsIncluded = false;
 		// Force the texture type since that's the only 32-bit one we know
-		tex_type = TextureType::_8888;
+		image.type = TextureType::_8888;
 
-		if (mipmapped)
+		if (image.mipmapsIncluded)
 		{
-			pb32.init(width, height, true);
+			image.pb32.init(width, height, true);
 			for (u32 i = 0; i <= tsp.TexU + 3u; i++)
 			{
-				pb32.set_mipmap(i);
+				image.pb32.set_mipmap(i);
 				u32 vram_addr;
 				if (tcw.VQ_Comp)
 				{
@@ -708,7 +850,7 @@ bool BaseTextureCacheData::Update()
 						PixelBuffer<u32> pb0;
 						pb0.init(2, 2 ,false);
 						texconv32(&pb0, (u8*)&vram[vram_addr], 2, 2);
-						*pb32.data() = *pb0.data(1, 1);
+						*image.pb32.data() = *pb0.data(1, 1);
 						continue;
 					}
 				}
@@ -716,16 +858,16 @@ bool BaseTextureCacheData::Update()
 					vram_addr = startAddress + OtherMipPoint[i] * tex->bpp / 8;
 				if (tcw.PixelFmt == PixelYUV && i == 0)
 					// Special case for YUV at 1x1 LoD
-					pvrTexInfo[Pixel565].TW32(&pb32, &vram[vram_addr], 1, 1);
+					pvrTexInfo[Pixel565].TW32(&image.pb32, &vram[vram_addr], 1, 1);
 				else
-					texconv32(&pb32, &vram[vram_addr], 1 << i, 1 << i);
+					texconv32(&image.pb32, &vram[vram_addr], 1 << i, 1 << i);
 			}
-			pb32.set_mipmap(0);
+			image.pb32.set_mipmap(0);
 		}
 		else
 		{
-			pb32.init(width, height);
-			texconv32(&pb32, (u8*)&vram[mmStartAddress], stride, heightLimit);
+			image.pb32.init(width, height);
+			texconv32(&image.pb32, (u8*)&vram[mmStartAddress], stride, heightLimit);
 
 			// xBRZ scaling
 			if (textureUpscaling)
@@ -736,43 +878,43 @@ bool BaseTextureCacheData::Update()
 				if (tcw.PixelFmt == Pixel1555 || tcw.PixelFmt == Pixel4444)
 					// Alpha channel formats. Palettes with alpha are already handled
 					has_alpha = true;
-				UpscalexBRZ(config::TextureUpscale, pb32.data(), tmp_buf.data(), width, height, has_alpha);
-				pb32.steal_data(tmp_buf);
-				upscaled_w *= config::TextureUpscale;
-				upscaled_h *= config::TextureUpscale;
+				UpscalexBRZ(config::TextureUpscale, image.pb32.data(), tmp_buf.data(), width, height, has_alpha);
+				image.pb32.steal_data(tmp_buf);
+				image.width *= config::TextureUpscale;
+				image.height *= config::TextureUpscale;
 			}
 		}
-		temp_tex_buffer = pb32.data();
+		image.data = (const u8 *)image.pb32.data();
 	}
-	else if (texconv8 != NULL && tex_type == TextureType::_8)
+	else if (texconv8 != NULL && image.type == TextureType::_8)
 	{
-		if (mipmapped)
+		if (image.mipmapsIncluded)
 		{
 			// This shouldn't happen since mipmapped palette textures are converted to rgba
-			pb8.init(width, height, true);
+			image.pb8.init(width, height, true);
 			for (u32 i = 0; i <= tsp.TexU + 3u; i++)
 			{
-				pb8.set_mipmap(i);
+				image.pb8.set_mipmap(i);
 				u32 vram_addr = startAddress + OtherMipPoint[i] * tex->bpp / 8;
-				texconv8(&pb8, &vram[vram_addr], 1 << i, 1 << i);
+				texconv8(&image.pb8, &vram[vram_addr], 1 << i, 1 << i);
 			}
-			pb8.set_mipmap(0);
+			image.pb8.set_mipmap(0);
 		}
 		else
 		{
-			pb8.init(width, height);
-			texconv8(&pb8, &vram[mmStartAddress], stride, height);
+			image.pb8.init(width, height);
+			texconv8(&image.pb8, &vram[mmStartAddress], stride, height);
 		}
-		temp_tex_buffer = pb8.data();
+		image.data = image.pb8.data();
 	}
 	else if (texconv != NULL)
 	{
-		if (mipmapped)
+		if (image.mipmapsIncluded)
 		{
-			pb16.init(width, height, true);
+			image.pb16.init(width, height, true);
 			for (u32 i = 0; i <= tsp.TexU + 3u; i++)
 			{
-				pb16.set_mipmap(i);
+				image.pb16.set_mipmap(i);
 				u32 vram_addr;
 				if (tcw.VQ_Comp)
 				{
@@ -782,49 +924,79 @@ bool BaseTextureCacheData::Update()
 						PixelBuffer<u16> pb0;
 						pb0.init(2, 2 ,false);
 						texconv(&pb0, (u8*)&vram[vram_addr], 2, 2);
-						*pb16.data() = *pb0.data(1, 1);
+						*image.pb16.data() = *pb0.data(1, 1);
 						continue;
 					}
 				}
 				else
 					vram_addr = startAddress + OtherMipPoint[i] * tex->bpp / 8;
-				texconv(&pb16, (u8*)&vram[vram_addr], 1 << i, 1 << i);
+				texconv(&image.pb16, (u8*)&vram[vram_addr], 1 << i, 1 << i);
 			}
-			pb16.set_mipmap(0);
+			image.pb16.set_mipmap(0);
 		}
 		else
 		{
-			pb16.init(width, height);
-			texconv(&pb16, (u8*)&vram[mmStartAddress], stride, heightLimit);
+			image.pb16.init(width, height);
+			texconv(&image.pb16, (u8*)&vram[mmStartAddress], stride, heightLimit);
 		}
-		temp_tex_buffer = pb16.data();
+		image.data = (const u8 *)image.pb16.data();
 	}
 	else
 	{
 		//fill it in with a temp color
 		WARN_LOG(RENDERER, "UNHANDLED TEXTURE");
-		pb16.init(width, height);
-		memset(pb16.data(), 0x80, width * height * 2);
-		temp_tex_buffer = pb16.data();
-		mipmapped = false;
+		image.pb16.init(width, height);
+		memset(image.pb16.data(), 0x80, width * height * 2);
+		image.data = (const u8 *)image.pb16.data();
+		image.mipmapsIncluded = false;
 	}
-	//lock the texture to detect changes in it
-	protectVRam();
+}
 
-	UploadToGPU(upscaled_w, upscaled_h, (const u8 *)temp_tex_buffer, IsMipmapped(), mipmapped);
-	if (config::DumpTextures)
+void BaseTextureCacheData::Upload(const DecodedTexture& image)
+{
+	tex_type = image.type;
+	UploadToGPU(image.width, image.height, image.data, IsMipmapped(), image.mipmapsIncluded);
+	hasGpuTexture = true;
+	SetGpuSize(image.width, image.height, image.type == TextureType::_8888 ? 4 : image.type == TextureType::_8 ? 1 : 2);
+}
+
+void BaseTextureCacheData::SetGpuSize(u32 width, u32 height, u32 bytesPerPixel)
+{
+	gpuSize = width * height * bytesPerPixel;
+	if (IsMipmapped())
+		gpuSize += gpuSize / 3;
+}
+
+bool BaseTextureCacheData::InstallDecoded()
+{
+	if (asyncUploadFrame != FrameCount)
 	{
-		ComputeHash();
-		custom_texture.DumpTexture(texture_hash, upscaled_w, upscaled_h, tex_type, temp_tex_buffer);
-		NOTICE_LOG(RENDERER, "Dumped texture %x.png. Old hash %x", texture_hash, old_texture_hash);
+		asyncUploadFrame = FrameCount;
+		asyncUploads = 0;
 	}
+	if (asyncUploads >= MaxAsyncUploadsPerFrame)
+		// Over budget for this frame
+		return hasGpuTexture;
+
+	std::unique_ptr<DecodedTexture> image = std::move(decoded);
+	{
+		std::lock_guard<std::mutex> lock(vramlist_lock);
+		if (lock_block == nullptr && dirty == 0)
+			// Replaced by a render-to-texture while being decoded
+			return hasGpuTexture;
+	}
+	// If the texture has been modified during decoding, it will be updated again next time.
+	asyncUploads++;
+	Upload(*image);
 	PrintTextureName();
-	// Restore the original texture size if it was constrained to VRAM limits above
-	size = originalSize;
 
 	return true;
 }
 
+void BaseTextureCacheData::FlushDecodeQueue() {
+	textureDecoder.flush();
+}
+
 void BaseTextureCacheData::CheckCustomTexture()
 {
 	if (IsCustomTextureAvailable())
@@ -832,6 +1004,7 @@ void BaseTextureCacheData::CheckCustomTexture()
 		tex_type = TextureType::_8888;
 		gpuPalette = false;
 		UploadToGPU(custom_width, custom_height, custom_image_data, IsMipmapped(), false);
+		SetGpuSize(custom_width, custom_height, 4);
 		free(custom_image_data);
 		custom_image_data = nullptr;
 	}
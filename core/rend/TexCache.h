@@ -2,16 +2,19 @@
 #include "oslib/oslib.h"
 #include "hw/pvr/Renderer_if.h"
 #include "cfg/option.h"
+#include "texconv_simd.h"
 
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <cinttypes>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <utility>
 
-extern const u8 *vq_codebook;
+extern thread_local const u8 *vq_codebook;
 constexpr int VQ_CODEBOOK_SIZE = 256 * 8;
 extern u32 palette_index;
 extern u32 palette16_ram[1024];
@@ -98,6 +101,10 @@ public:
 		return p_current_mipmap + pixels_per_line * y + x;
 	}
 
+	u32 stride() const {
+		return pixels_per_line;
+	}
+
 	void prel(u32 x, pixel_type value)
 	{
 		p_current_pixel[x] = value;
@@ -132,12 +139,23 @@ struct RGBAPacker {
 	static u32 pack(u8 r, u8 g, u8 b, u8 a) {
 		return r | (g << 8) | (b << 16) | (a << 24);
 	}
+#ifdef TEXCONV_SIMD
+	// 8 pixels with one 8-bit component per 16-bit lane
+	static void pack(texconv::u16x8 r, texconv::u16x8 g, texconv::u16x8 b, texconv::u16x8 a, texconv::u32x4& lo, texconv::u32x4& hi) {
+		texconv::zip(texconv::or_(r, texconv::shl<8>(g)), texconv::or_(b, texconv::shl<8>(a)), lo, hi);
+	}
+#endif
 };
 // DirectX
 struct BGRAPacker {
 	static u32 pack(u8 r, u8 g, u8 b, u8 a) {
 		return b | (g << 8) | (r << 16) | (a << 24);
 	}
+#ifdef TEXCONV_SIMD
+	static void pack(texconv::u16x8 r, texconv::u16x8 g, texconv::u16x8 b, texconv::u16x8 a, texconv::u32x4& lo, texconv::u32x4& hi) {
+		texconv::zip(texconv::or_(b, texconv::shl<8>(g)), texconv::or_(r, texconv::shl<8>(a)), lo, hi);
+	}
+#endif
 };
 
 template<typename Packer>
@@ -153,6 +171,25 @@ inline static u32 YUV422(s32 Y, s32 Yu, s32 Yv)
 	return Packer::pack(std::clamp(R, 0, 255), std::clamp(G, 0, 255), std::clamp(B, 0, 255), 0xFF);
 }
 
+#ifdef TEXCONV_SIMD
+// 4 pairs of pixels. Even lanes hold Y and U, odd lanes Y and V.
+template<typename Packer>
+inline static void YUV422(texconv::u16x8 w, texconv::u32x4& lo, texconv::u32x4& hi)
+{
+	using namespace texconv;
+	u16x8 Y = shr<8>(w);
+	u16x8 c = sub(and_(w, set(0xFF)), set(128));
+	u16x8 Yu = dupEven(c);
+	u16x8 Yv = dupOdd(c);
+
+	u16x8 R = add(Y, divPow2<3>(mul(Yv, 11)));
+	u16x8 G = sub(Y, divPow2<5>(add(mul(Yu, 11), mul(Yv, 22))));
+	u16x8 B = add(Y, divPow2<6>(mul(Yu, 110)));
+
+	Packer::pack(clamp(R, 0, 255), clamp(G, 0, 255), clamp(B, 0, 255), set(0xFF), lo, hi);
+}
+#endif
+
 #define twop(x,y,bcx,bcy) (detwiddle[0][bcy][x]+detwiddle[1][bcx][y])
 
 template<typename Pixel>
@@ -161,6 +198,12 @@ struct UnpackerNop {
 	static Pixel unpack(Pixel word) {
 		return word;
 	}
+#ifdef TEXCONV_SIMD
+	static constexpr bool Simd = sizeof(Pixel) == 2;
+	static texconv::u16x8 unpack(texconv::u16x8 word) {
+		return word;
+	}
+#endif
 };
 
 // ARGB1555 to RGBA5551
@@ -169,6 +212,12 @@ struct Unpacker1555 {
 	static u16 unpack(u16 word) {
 		return ((word >> 15) & 1) | (((word >> 10) & 0x1F) << 11)  | (((word >> 5) & 0x1F) << 6)  | (((word >> 0) & 0x1F) << 1);
 	}
+#ifdef TEXCONV_SIMD
+	static constexpr bool Simd = true;
+	static texconv::u16x8 unpack(texconv::u16x8 word) {
+		return texconv::or_(texconv::shl<1>(word), texconv::shr<15>(word));
+	}
+#endif
 };
 
 // ARGB4444 to RGBA4444
@@ -177,6 +226,12 @@ struct Unpacker4444 {
 	static u16 unpack(u16 word) {
 		return (((word >> 0) & 0xF) << 4) | (((word >> 4) & 0xF) << 8) | (((word >> 8) & 0xF) << 12) | (((word >> 12) & 0xF) << 0);
 	}
+#ifdef TEXCONV_SIMD
+	static constexpr bool Simd = true;
+	static texconv::u16x8 unpack(texconv::u16x8 word) {
+		return texconv::or_(texconv::shl<4>(word), texconv::shr<12>(word));
+	}
+#endif
 };
 
 template <typename Packer>
@@ -189,6 +244,20 @@ struct Unpacker1555_32 {
 				(((word >> 0) & 0x1F) << 3) | ((word >> 2) & 7),
 				(word & 0x8000) ? 0xFF : 0);
 	}
+#ifdef TEXCONV_SIMD
+	static constexpr bool Simd = true;
+	static void unpack(texconv::u16x8 word, texconv::u32x4& lo, texconv::u32x4& hi)
+	{
+		using namespace texconv;
+		const u16x8 mask = set(0xF8);
+		Packer::pack(
+				or_(and_(shr<7>(word), mask), and_(shr<12>(word), set(7))),
+				or_(and_(shr<2>(word), mask), and_(shr<7>(word), set(7))),
+				or_(and_(shl<3>(word), mask), and_(shr<2>(word), set(7))),
+				and_(sar<15>(word), set(0xFF)),
+				lo, hi);
+	}
+#endif
 };
 
 template <typename Packer>
@@ -201,6 +270,19 @@ struct Unpacker565_32 {
 				(((word >> 0) & 0x1F) << 3) | ((word >> 2) & 7),
 				0xFF);
 	}
+#ifdef TEXCONV_SIMD
+	static constexpr bool Simd = true;
+	static void unpack(texconv::u16x8 word, texconv::u32x4& lo, texconv::u32x4& hi)
+	{
+		using namespace texconv;
+		Packer::pack(
+				or_(and_(shr<8>(word), set(0xF8)), shr<13>(word)),
+				or_(and_(shr<3>(word), set(0xFC)), and_(shr<9>(word), set(3))),
+				or_(and_(shl<3>(word), set(0xF8)), and_(shr<2>(word), set(7))),
+				set(0xFF),
+				lo, hi);
+	}
+#endif
 };
 
 template <typename Packer>
@@ -213,6 +295,19 @@ struct Unpacker4444_32 {
 				(((word >> 0) & 0xF) << 4) | ((word >> 0) & 0xF),
 				(((word >> 12) & 0xF) << 4) | ((word >> 12) & 0xF));
 	}
+#ifdef TEXCONV_SIMD
+	static constexpr bool Simd = true;
+	static void unpack(texconv::u16x8 word, texconv::u32x4& lo, texconv::u32x4& hi)
+	{
+		using namespace texconv;
+		const u16x8 mask = set(0xF);
+		u16x8 r = and_(shr<8>(word), mask);
+		u16x8 g = and_(shr<4>(word), mask);
+		u16x8 b = and_(word, mask);
+		u16x8 a = shr<12>(word);
+		Packer::pack(or_(r, shl<4>(r)), or_(g, shl<4>(g)), or_(b, shl<4>(b)), or_(a, shl<4>(a)), lo, hi);
+	}
+#endif
 };
 
 // ARGB8888 to whatever
@@ -242,6 +337,24 @@ struct ConvertPlanar
 		pb->prel(2, Unpacker::unpack(p_in[2]));
 		pb->prel(3, Unpacker::unpack(p_in[3]));
 	}
+#ifdef TEXCONV_SIMD
+	static constexpr bool Simd = texconv::IsSimd<Unpacker>::value;
+	// Convert 8 pixels
+	static void ConvertLine(unpacked_type *dst, const u8 *data)
+	{
+		texconv::u16x8 word = texconv::load((const u16 *)data);
+		if constexpr (sizeof(unpacked_type) == 2)
+		{
+			texconv::store(dst, Unpacker::unpack(word));
+		}
+		else
+		{
+			texconv::u32x4 lo, hi;
+			Unpacker::unpack(word, lo, hi);
+			texconv::store(dst, lo, hi);
+		}
+	}
+#endif
 };
 
 template<typename Packer>
@@ -279,6 +392,15 @@ struct ConvertPlanarYUV
 		//1,0
 		pb->prel(3, YUV422<Packer>(Y1, Yu, Yv));
 	}
+#ifdef TEXCONV_SIMD
+	static constexpr bool Simd = true;
+	static void ConvertLine(u32 *dst, const u8 *data)
+	{
+		texconv::u32x4 lo, hi;
+		YUV422<Packer>(texconv::load((const u16 *)data), lo, hi);
+		texconv::store(dst, lo, hi);
+	}
+#endif
 };
 
 template<typename Unpacker>
@@ -295,6 +417,35 @@ struct ConvertTwiddle
 		pb->prel(1, 0, Unpacker::unpack(p_in[2]));
 		pb->prel(1, 1, Unpacker::unpack(p_in[3]));
 	}
+#ifdef TEXCONV_SIMD
+	static constexpr bool Simd = texconv::IsSimd<Unpacker>::value;
+	// Convert a 4x4 tile. a and b hold its 16 pixels in twiddled order.
+	static void ConvertTile(unpacked_type *dst, u32 stride, texconv::u16x8 a, texconv::u16x8 b)
+	{
+		using namespace texconv;
+		u16x8 r02, r13;
+		detwiddle4x4(a, b, r02, r13);
+		if constexpr (sizeof(unpacked_type) == 2)
+		{
+			r02 = Unpacker::unpack(r02);
+			r13 = Unpacker::unpack(r13);
+			storeLow(dst, r02);
+			storeLow(dst + stride, r13);
+			storeHigh(dst + stride * 2, r02);
+			storeHigh(dst + stride * 3, r13);
+		}
+		else
+		{
+			u32x4 r0, r1, r2, r3;
+			Unpacker::unpack(r02, r0, r2);
+			Unpacker::unpack(r13, r1, r3);
+			store(dst, r0);
+			store(dst + stride, r1);
+			store(dst + stride * 2, r2);
+			store(dst + stride * 3, r3);
+		}
+	}
+#endif
 };
 
 template<typename Packer>
@@ -331,6 +482,23 @@ struct ConvertTwiddleYUV
 		//1,1
 		pb->prel(1, 1, YUV422<Packer>(Y1, Yu, Yv));
 	}
+#ifdef TEXCONV_SIMD
+	static constexpr bool Simd = true;
+	static void ConvertTile(u32 *dst, u32 stride, texconv::u16x8 a, texconv::u16x8 b)
+	{
+		using namespace texconv;
+		u16x8 r02, r13;
+		detwiddle4x4(a, b, r02, r13);
+		// once detwiddled, rows have the planar layout
+		u32x4 r0, r1, r2, r3;
+		YUV422<Packer>(r02, r0, r2);
+		YUV422<Packer>(r13, r1, r3);
+		store(dst, r0);
+		store(dst + stride, r1);
+		store(dst + stride * 2, r2);
+		store(dst + stride * 3, r3);
+	}
+#endif
 };
 
 template<typename Pixel>
@@ -399,7 +567,7 @@ struct ConvertTwiddlePal8
 
 //handler functions
 template<class PixelConvertor>
-void texture_PL(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
+void texture_PL_scalar(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
 {
 	pb->amove(0,0);
 
@@ -421,7 +589,7 @@ void texture_PL(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u
 }
 
 template<class PixelConvertor>
-void texture_TW(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
+void texture_TW_scalar(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
 {
 	pb->amove(0, 0);
 
@@ -444,7 +612,7 @@ void texture_TW(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u
 }
 
 template<class PixelConvertor>
-void texture_VQ(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
+void texture_VQ_scalar(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
 {
 	pb->amove(0, 0);
 
@@ -465,6 +633,106 @@ void texture_VQ(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u
 	}
 }
 
+#ifdef TEXCONV_SIMD
+template<class PixelConvertor>
+void texture_PL_simd(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
+{
+	for (u32 y = 0; y < Height; y++)
+	{
+		typename PixelConvertor::unpacked_type *dst = pb->data(0, y);
+		for (u32 x = 0; x < Width; x += 8, p_in += 16)
+			PixelConvertor::ConvertLine(dst + x, p_in);
+	}
+}
+
+// Twiddled textures are converted by 4x4 tiles, whose 16 pixels are contiguous
+template<class PixelConvertor>
+void texture_TW_simd(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
+{
+	const u32 bcx = bitscanrev(Width);
+	const u32 bcy = bitscanrev(Height);
+	const u32 stride = pb->stride();
+	const u16 *src = (const u16 *)p_in;
+
+	for (u32 y = 0; y < Height; y += 4)
+	{
+		for (u32 x = 0; x < Width; x += 4)
+		{
+			const u16 *tile = &src[twop(x, y, bcx, bcy)];
+			PixelConvertor::ConvertTile(pb->data(x, y), stride, texconv::load(tile), texconv::load(tile + 8));
+		}
+	}
+}
+
+// Each 4x4 tile uses 4 consecutive indices, each one selecting a 2x2 block in the codebook
+template<class PixelConvertor>
+void texture_VQ_simd(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
+{
+	const u32 bcx = bitscanrev(Width);
+	const u32 bcy = bitscanrev(Height);
+	const u32 stride = pb->stride();
+
+	for (u32 y = 0; y < Height; y += 4)
+	{
+		for (u32 x = 0; x < Width; x += 4)
+		{
+			const u8 *idx = &p_in[twop(x, y, bcx, bcy) / 4];
+			PixelConvertor::ConvertTile(pb->data(x, y), stride,
+					texconv::load(&vq_codebook[idx[0] * 8], &vq_codebook[idx[1] * 8]),
+					texconv::load(&vq_codebook[idx[2] * 8], &vq_codebook[idx[3] * 8]));
+		}
+	}
+}
+#endif
+
+template<class PixelConvertor>
+void texture_PL(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
+{
+#ifdef TEXCONV_SIMD
+	if constexpr (texconv::IsSimd<PixelConvertor>::value)
+	{
+		if (Width % 8 == 0)
+		{
+			texture_PL_simd<PixelConvertor>(pb, p_in, Width, Height);
+			return;
+		}
+	}
+#endif
+	texture_PL_scalar<PixelConvertor>(pb, p_in, Width, Height);
+}
+
+template<class PixelConvertor>
+void texture_TW(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
+{
+#ifdef TEXCONV_SIMD
+	if constexpr (texconv::IsSimd<PixelConvertor>::value)
+	{
+		if (Width % 4 == 0 && Height % 4 == 0)
+		{
+			texture_TW_simd<PixelConvertor>(pb, p_in, Width, Height);
+			return;
+		}
+	}
+#endif
+	texture_TW_scalar<PixelConvertor>(pb, p_in, Width, Height);
+}
+
+template<class PixelConvertor>
+void texture_VQ(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 Width, u32 Height)
+{
+#ifdef TEXCONV_SIMD
+	if constexpr (texconv::IsSimd<PixelConvertor>::value)
+	{
+		if (Width % 4 == 0 && Height % 4 == 0)
+		{
+			texture_VQ_simd<PixelConvertor>(pb, p_in, Width, Height);
+			return;
+		}
+	}
+#endif
+	texture_VQ_scalar<PixelConvertor>(pb, p_in, Width, Height);
+}
+
 typedef void (*TexConvFP)(PixelBuffer<u16> *pb, const u8 *p_in, u32 width, u32 height);
 typedef void (*TexConvFP8)(PixelBuffer<u8> *pb, const u8 *p_in, u32 width, u32 height);
 typedef void (*TexConvFP32)(PixelBuffer<u32> *pb, const u8 *p_in, u32 width, u32 height);
@@ -566,6 +834,19 @@ void UpscalexBRZ(int factor, u32* source, u32* dest, int width, int height, bool
 struct PvrTexInfo;
 enum class TextureType { _565, _5551, _4444, _8888, _8 };
 
+// Decoded texture ready to be uploaded
+struct DecodedTexture
+{
+	PixelBuffer<u16> pb16;
+	PixelBuffer<u32> pb32;
+	PixelBuffer<u8> pb8;
+	const u8 *data = nullptr;
+	u32 width = 0;
+	u32 height = 0;
+	TextureType type = TextureType::_565;
+	bool mipmapsIncluded = false;
+};
+
 class BaseTextureCacheData
 {
 protected:
@@ -574,6 +855,9 @@ protected:
 public:
 	BaseTextureCacheData(BaseTextureCacheData&& other)
 	{
+		// The decoder thread writes to the texture being decoded, which may be destroyed once moved
+		if (other.decode_in_progress > 0)
+			FlushDecodeQueue();
 		tsp = other.tsp;
 		tcw = other.tcw;
 		tex_type = other.tex_type;
@@ -598,6 +882,14 @@ public:
 		custom_height = other.custom_height;
 		custom_load_in_progress = 0;
 		gpuPalette = other.gpuPalette;
+		std::swap(decoded, other.decoded);
+		decode_in_progress = 0;
+		hasGpuTexture = other.hasGpuTexture;
+		dataHash = other.dataHash;
+		paramsHash = other.paramsHash;
+		pageGeneration = other.pageGeneration;
+		lastUsed = other.lastUsed;
+		gpuSize = other.gpuSize;
 	}
 
 	TSP tsp;        	//dreamcast texture parameters
@@ -631,6 +923,14 @@ public:
 	u32 custom_height;
 	std::atomic_int custom_load_in_progress;
 	bool gpuPalette;
+	std::unique_ptr<DecodedTexture> decoded;	// set when the texture is being or has been decoded asynchronously
+	std::atomic_int decode_in_progress;
+	bool hasGpuTexture;			// a previous version has been uploaded
+	u64 dataHash;				// xxh3 of the texture vram at last update
+	u64 paramsHash;				// hash of the decoding parameters at last update
+	u64 pageGeneration;			// sum of the vram page generations at last update
+	u32 lastUsed;				// frame number at which the texture was last looked up
+	u32 gpuSize;				// approximate size in bytes of the uploaded texture
 
 	void PrintTextureName();
 	virtual std::string GetId() = 0;
@@ -666,6 +966,7 @@ public:
 	}
 
 	void ComputeHash();
+	// Decode and upload the texture. Returns false if no valid texture is available yet
 	bool Update();
 	virtual void UploadToGPU(int width, int height, const u8 *temp_tex_buffer, bool mipmapped, bool mipmapsIncluded = false) = 0;
 	virtual bool Force32BitTexture(TextureType type) const { return false; }
@@ -691,11 +992,28 @@ public:
 				&& !tcw.VQ_Comp;
 	}
 	static void SetDirectXColorOrder(bool enabled);
+	// Wait for all pending asynchronous texture decodes
+	static void FlushDecodeQueue();
+
+private:
+	// Returns false if the texture data and decoding parameters haven't changed since the last update
+	bool DataChanged(u32 stride, u32 heightLimit);
+	void Decode(DecodedTexture& image, TextureType type, u32 stride, u32 heightLimit, bool has_alpha);
+	void Upload(const DecodedTexture& image);
+	bool InstallDecoded();
+	void SetGpuSize(u32 width, u32 height, u32 bytesPerPixel);
 };
 
 // TODO Split the texture cache in a separate header
 #include "CustomTexture.h"
 
+struct TextureCacheStats
+{
+	u64 hits = 0;
+	u64 misses = 0;
+	u64 evictions = 0;		// textures deleted to stay within config::TextureCacheSize
+};
+
 template<typename Texture>
 class BaseTextureCache
 {
@@ -726,11 +1044,14 @@ public:
 			texture = &it->second;
 			// Needed if the texture is updated
 			texture->tcw.StrideSel = tcw.StrideSel;
+			stats.hits++;
 		}
 		else //create if not existing
 		{
 			texture = &cache.emplace(std::make_pair(key, Texture(tsp, tcw))).first->second;
+			stats.misses++;
 		}
+		texture->lastUsed = FrameCount;
 
 		return texture;
 	}
@@ -759,41 +1080,84 @@ public:
 		return getTextureCacheData(tsp, tcw);
 	}
 
-	void CollectCleanup()
+	void CollectCleanup() {
+		CollectCleanup([](Texture& texture) { return texture.Delete(); });
+	}
+
+	// Delete textures that have been overwritten and not used for a while,
+	// then the least recently used ones until the cache fits in config::TextureCacheSize.
+	// deleteTexture returns false if the texture can't be deleted yet.
+	template<typename Deleter>
+	void CollectCleanup(Deleter deleteTexture)
 	{
 		std::vector<u64> list;
 
 		u32 TargetFrame = std::max((u32)120, FrameCount) - 120;
+		u64 residentBytes = 0;
 
 		for (const auto& [id, texture] : cache)
 		{
-			if (texture.dirty && texture.dirty < TargetFrame)
+			residentBytes += texture.gpuSize;
+			if (texture.dirty && texture.dirty < TargetFrame && list.size() <= 5)
 				list.push_back(id);
-
-			if (list.size() > 5)
-				break;
 		}
 
 		for (u64 id : list)
 		{
-			if (cache.find(id)->second.Delete())
-				cache.erase(id);
+			auto it = cache.find(id);
+			u32 size = it->second.gpuSize;
+			if (deleteTexture(it->second))
+			{
+				cache.erase(it);
+				residentBytes -= size;
+			}
+		}
+
+		const u64 budget = std::max<int64_t>(config::TextureCacheSize, 0);
+		if (budget != 0 && residentBytes > budget)
+		{
+			// Don't evict textures that might still be in use
+			u32 minFrame = std::max(MinEvictionAge, FrameCount) - MinEvictionAge;
+			std::vector<std::pair<u32, u64>> lru;
+			for (const auto& [id, texture] : cache)
+				if (texture.gpuSize != 0 && texture.lastUsed < minFrame)
+					lru.emplace_back(texture.lastUsed, id);
+			std::sort(lru.begin(), lru.end());
+
+			for (const auto& [lastUsed, id] : lru)
+			{
+				if (residentBytes <= budget)
+					break;
+				auto it = cache.find(id);
+				u32 size = it->second.gpuSize;
+				if (deleteTexture(it->second))
+				{
+					cache.erase(it);
+					residentBytes -= size;
+					stats.evictions++;
+				}
+			}
 		}
 	}
 
 	void Clear()
 	{
 		custom_texture.Terminate();
+		BaseTextureCacheData::FlushDecodeQueue();
 		for (auto& [id, texture] : cache)
 			texture.Delete();
 
 		cache.clear();
 		KillTex = false;
-		INFO_LOG(RENDERER, "Texture cache cleared");
+		INFO_LOG(RENDERER, "Texture cache cleared. Hits %" PRIu64 " misses %" PRIu64 " evictions %" PRIu64,
+				stats.hits, stats.misses, stats.evictions);
 	}
 
 protected:
 	std::unordered_map<u64, Texture> cache;
+	TextureCacheStats stats;
+	// Number of frames a texture must be unused before being evicted
+	static constexpr u32 MinEvictionAge = 10;
 	// Only use TexU and TexV from TSP in the cache key
 	//     TexV : 7, TexU : 7
 	const TSP TSPTextureCacheMask = { { 7, 7 } };
@@ -0,0 +1,824 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "sw_rasterizer.h"
+#include "sw_texture.h"
+#include "hw/pvr/pvr_regs.h"
+#include "cfg/option.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace software
+{
+
+enum : u8 { WrapRepeat, WrapMirror, WrapClamp };
+enum : u8 { ClipOff, ClipInside, ClipOutside };
+
+// Register values used while rendering tiles, captured at the beginning of the frame
+static struct FrameState
+{
+	bool fog;
+	bool colorClamp;
+	float fogDensity;
+	u8 fogTable0[128];
+	u8 fogTable1[128];
+	glm::vec3 fogColRam;
+	glm::vec3 fogColVert;
+	glm::vec4 clampMin;
+	glm::vec4 clampMax;
+	float ptAlphaRef;
+	float shadowScale;
+	u32 palette[1024];
+} state;
+
+static void captureState(const rend_context& ctx)
+{
+	state.fog = config::Fog;
+	state.colorClamp = ctx.fog_clamp_min.full != 0 || ctx.fog_clamp_max.full != 0xffffffff;
+	state.fogDensity = FOG_DENSITY.get() * config::ExtraDepthScale;
+	const u8 *fogTable = (const u8 *)FOG_TABLE;
+	for (int i = 0; i < 128; i++)
+	{
+		state.fogTable0[i] = fogTable[i * 4];
+		state.fogTable1[i] = fogTable[i * 4 + 1];
+	}
+	state.fogColRam = { FOG_COL_RAM.red(), FOG_COL_RAM.green(), FOG_COL_RAM.blue() };
+	state.fogColVert = { FOG_COL_VERT.red(), FOG_COL_VERT.green(), FOG_COL_VERT.blue() };
+	ctx.fog_clamp_min.getRGBAColor(&state.clampMin[0]);
+	ctx.fog_clamp_max.getRGBAColor(&state.clampMax[0]);
+	state.ptAlphaRef = (PT_ALPHA_REF & 0xFF) / 255.f;
+	state.shadowScale = FPU_SHAD_SCALE.scale_factor / 256.f;
+	memcpy(state.palette, palette32_ram, sizeof(state.palette));
+}
+
+static inline glm::vec4 unpackColor(u32 c)
+{
+	return glm::vec4(c & 0xff, (c >> 8) & 0xff, (c >> 16) & 0xff, c >> 24) * (1.f / 255.f);
+}
+
+static inline u32 packColor(const glm::vec4& c)
+{
+	return (u32)(c.r * 255.f + 0.5f)
+			| ((u32)(c.g * 255.f + 0.5f) << 8)
+			| ((u32)(c.b * 255.f + 0.5f) << 16)
+			| ((u32)(c.a * 255.f + 0.5f) << 24);
+}
+
+static float fogCoef(float z)
+{
+	float zz = state.fogDensity * z;
+	zz = zz >= 1.f ? std::min(zz, 255.9999f) : 1.f;
+	const float exp = std::floor(std::log2(zz));
+	const float m = zz * 16.f / std::exp2(exp) - 16.f;
+	const float fm = std::floor(m);
+	const int idx = std::clamp((int)fm + (int)exp * 16, 0, 127);
+	const float frac = m - fm;
+	return (state.fogTable1[idx] * (1.f - frac) + state.fogTable0[idx] * frac) / 255.f;
+}
+
+static inline int wrapCoord(int i, int size, u8 mode)
+{
+	switch (mode)
+	{
+	case WrapClamp:
+		return std::clamp(i, 0, size - 1);
+	case WrapMirror:
+		{
+			const int period = size * 2;
+			i %= period;
+			if (i < 0)
+				i += period;
+			return i < size ? i : period - 1 - i;
+		}
+	default:
+		i %= size;
+		return i < 0 ? i + size : i;
+	}
+}
+
+static inline glm::vec4 fetchTexel(const Rasterizer::Triangle& tri, int x, int y)
+{
+	x = wrapCoord(x, tri.texWidth, tri.wrapU);
+	y = wrapCoord(y, tri.texHeight, tri.wrapV);
+	const u32 idx = y * tri.texWidth + x;
+	if (tri.texels != nullptr)
+		return unpackColor(tri.texels[idx]);
+	else
+		return unpackColor(state.palette[(tri.paletteIndex + tri.indices[idx]) & 1023]);
+}
+
+static glm::vec4 sampleTexture(const Rasterizer::Triangle& tri, float u, float v)
+{
+	// Keep coordinates in the int range
+	float x = std::clamp(u * tri.texWidth, -16777216.f, 16777216.f);
+	float y = std::clamp(v * tri.texHeight, -16777216.f, 16777216.f);
+	if (tri.nearest)
+		return fetchTexel(tri, (int)std::floor(x), (int)std::floor(y));
+
+	x -= 0.5f;
+	y -= 0.5f;
+	const float x0 = std::floor(x);
+	const float y0 = std::floor(y);
+	const float wx = x - x0;
+	const float wy = y - y0;
+	const int ix = (int)x0;
+	const int iy = (int)y0;
+	const glm::vec4 top = glm::mix(fetchTexel(tri, ix, iy), fetchTexel(tri, ix + 1, iy), wx);
+	const glm::vec4 bottom = glm::mix(fetchTexel(tri, ix, iy + 1), fetchTexel(tri, ix + 1, iy + 1), wx);
+	return glm::mix(top, bottom, wy);
+}
+
+// Same pipeline as the gl fragment shader. Returns false if the fragment is discarded.
+static bool shadePixel(const Rasterizer::Triangle& tri, float x, float y, float z, glm::vec4& color)
+{
+	const PolyParam& pp = *tri.pp;
+	const float w = 1.f / z;
+	glm::vec4 offset;
+	if (tri.gouraud)
+	{
+		color = glm::vec4(tri.col[0].at(x, y), tri.col[1].at(x, y), tri.col[2].at(x, y), tri.col[3].at(x, y)) * w;
+		offset = glm::vec4(tri.spc[0].at(x, y), tri.spc[1].at(x, y), tri.spc[2].at(x, y), tri.spc[3].at(x, y)) * w;
+	}
+	else
+	{
+		color = glm::vec4(tri.col[0].c, tri.col[1].c, tri.col[2].c, tri.col[3].c);
+		offset = glm::vec4(tri.spc[0].c, tri.spc[1].c, tri.spc[2].c, tri.spc[3].c);
+	}
+	if (!pp.tsp.UseAlpha)
+		color.a = 1.f;
+	const u32 fogCtrl = state.fog ? pp.tsp.FogCtrl : 2;
+	if (fogCtrl == 3)
+		color = glm::vec4(state.fogColRam, fogCoef(z));
+
+	if (tri.texels != nullptr || tri.indices != nullptr)
+	{
+		glm::vec4 texcol = sampleTexture(tri, tri.u.at(x, y) * w, tri.v.at(x, y) * w);
+		if (pp.tsp.IgnoreTexA)
+			texcol.a = 1.f;
+		switch (pp.tsp.ShadInstr)
+		{
+		case 0:
+			color = texcol;
+			break;
+		case 1:
+			color = glm::vec4(glm::vec3(color) * glm::vec3(texcol), texcol.a);
+			break;
+		case 2:
+			color = glm::vec4(glm::mix(glm::vec3(color), glm::vec3(texcol), texcol.a), color.a);
+			break;
+		case 3:
+			color *= texcol;
+			break;
+		}
+		if (pp.pcw.Offset)
+			color += glm::vec4(glm::vec3(offset), 0.f);
+	}
+	if (state.colorClamp && pp.tsp.ColorClamp)
+		color = glm::clamp(color, state.clampMin, state.clampMax);
+
+	if (fogCtrl == 0)
+		color = glm::vec4(glm::mix(glm::vec3(color), state.fogColRam, fogCoef(z)), color.a);
+	else if (fogCtrl == 1 && pp.pcw.Offset)
+		color = glm::vec4(glm::mix(glm::vec3(color), state.fogColVert, offset.a), color.a);
+
+	if (tri.listType == ListType_Punch_Through)
+	{
+		color.a = std::floor(color.a * 255.f + 0.5f) / 255.f;
+		if (state.ptAlphaRef > color.a)
+			return false;
+		color.a = 1.f;
+	}
+	return true;
+}
+
+static inline glm::vec4 srcBlendFactor(u32 instr, const glm::vec4& src, const glm::vec4& dst)
+{
+	switch (instr)
+	{
+	case 0: return glm::vec4(0.f);
+	case 1: return glm::vec4(1.f);
+	case 2: return dst;
+	case 3: return glm::vec4(1.f) - dst;
+	case 4: return glm::vec4(src.a);
+	case 5: return glm::vec4(1.f - src.a);
+	case 6: return glm::vec4(dst.a);
+	default: return glm::vec4(1.f - dst.a);
+	}
+}
+
+static inline glm::vec4 dstBlendFactor(u32 instr, const glm::vec4& src, const glm::vec4& dst)
+{
+	switch (instr)
+	{
+	case 0: return glm::vec4(0.f);
+	case 1: return glm::vec4(1.f);
+	case 2: return src;
+	case 3: return glm::vec4(1.f) - src;
+	case 4: return glm::vec4(src.a);
+	case 5: return glm::vec4(1.f - src.a);
+	case 6: return glm::vec4(dst.a);
+	default: return glm::vec4(1.f - dst.a);
+	}
+}
+
+static inline u32 blend(const TSP& tsp, glm::vec4 src, u32 dstPixel)
+{
+	src = glm::clamp(src, 0.f, 1.f);
+	if (tsp.SrcInstr == 1 && tsp.DstInstr == 0)
+		return packColor(src);
+	const glm::vec4 dst = unpackColor(dstPixel);
+	const glm::vec4 result = src * srcBlendFactor(tsp.SrcInstr, src, dst) + dst * dstBlendFactor(tsp.DstInstr, src, dst);
+	return packColor(glm::clamp(result, 0.f, 1.f));
+}
+
+// Coverage mask and interpolated depth of a span of n pixels starting at (x, y), relative to the primitive origin.
+// Written as a simple loop over the span so that it can be vectorized.
+static void spanCoverage(const Rasterizer::Edges& e, float x, float y, int n, float *z, s32 *mask)
+{
+	const float w0 = e.a[0] * x + e.b[0] * y + e.c[0];
+	const float w1 = e.a[1] * x + e.b[1] * y + e.c[1];
+	const float w2 = e.a[2] * x + e.b[2] * y + e.c[2];
+	const float z0 = e.z.at(x, y);
+	const s32 tl0 = e.topLeft[0];
+	const s32 tl1 = e.topLeft[1];
+	const s32 tl2 = e.topLeft[2];
+	for (int i = 0; i < n; i++)
+	{
+		const float fi = (float)i;
+		const float e0 = w0 + e.a[0] * fi;
+		const float e1 = w1 + e.a[1] * fi;
+		const float e2 = w2 + e.a[2] * fi;
+		mask[i] = ((e0 > 0.f) | (tl0 & (e0 == 0.f)))
+				& ((e1 > 0.f) | (tl1 & (e1 == 0.f)))
+				& ((e2 > 0.f) | (tl2 & (e2 == 0.f)));
+		z[i] = z0 + e.z.dx * fi;
+	}
+}
+
+template<typename Compare>
+static void depthTest(const float *z, const float *depth, s32 *mask, int n, Compare compare)
+{
+	for (int i = 0; i < n; i++)
+		mask[i] &= compare(z[i], depth[i]);
+}
+
+// Returns false if no pixel can pass
+static bool depthTest(u32 func, const float *z, const float *depth, s32 *mask, int n)
+{
+	switch (func)
+	{
+	case 0:	// never
+		return false;
+	case 1:
+		depthTest(z, depth, mask, n, [](float a, float b) { return (s32)(a < b); });
+		break;
+	case 2:
+		depthTest(z, depth, mask, n, [](float a, float b) { return (s32)(a == b); });
+		break;
+	case 3:
+		depthTest(z, depth, mask, n, [](float a, float b) { return (s32)(a <= b); });
+		break;
+	case 4:
+		depthTest(z, depth, mask, n, [](float a, float b) { return (s32)(a > b); });
+		break;
+	case 5:
+		depthTest(z, depth, mask, n, [](float a, float b) { return (s32)(a != b); });
+		break;
+	case 6:
+		depthTest(z, depth, mask, n, [](float a, float b) { return (s32)(a >= b); });
+		break;
+	default: // always
+		break;
+	}
+	return true;
+}
+
+static inline Rasterizer::Plane makePlane(float dx1, float dy1, float dx2, float dy2, float invArea, float a0, float a1, float a2)
+{
+	const float d1 = a1 - a0;
+	const float d2 = a2 - a0;
+	return { (d1 * dy2 - d2 * dy1) * invArea, (d2 * dx1 - d1 * dx2) * invArea, a0 };
+}
+
+static inline Rasterizer::Plane constantPlane(float a) {
+	return { 0.f, 0.f, a };
+}
+
+Rasterizer::Rasterizer()
+{
+	// The calling thread renders tiles too
+	int count = std::clamp((int)std::thread::hardware_concurrency() - 1, 0, 7);
+	for (int i = 0; i < count; i++)
+		workers.emplace_back("SwRenderer");
+}
+
+void Rasterizer::render(const rend_context& ctx, u32 width, u32 height, u32 clearColor)
+{
+	captureState(ctx);
+	this->width = width;
+	this->height = height;
+	this->clearColor = clearColor;
+	tilesX = width / TileSize;
+	tilesY = height / TileSize;
+	frame.resize(width * height);
+
+	const u32 tileCount = tilesX * tilesY;
+	tileCommands.resize(tileCount);
+	for (auto& commands : tileCommands)
+		commands.clear();
+	volumeStamp.assign(tileCount, 0);
+	passStamp.assign(tileCount, 0);
+	volumeGroup = 0;
+	passNumber = 0;
+	triangles.clear();
+	volumes.clear();
+
+	// Base clipping
+	float minX, minY, maxX, maxY;
+	if (ctx.isRTT)
+	{
+		minX = (float)ctx.getFramebufferMinX();
+		minY = (float)ctx.getFramebufferMinY();
+		maxX = (float)ctx.getFramebufferWidth();
+		maxY = (float)ctx.getFramebufferHeight();
+	}
+	else
+	{
+		// Clip values are in framebuffer pixels
+		const float scaleX = ctx.scaler_ctl.hscale ? 2.f : 1.f;
+		const float scaleY = ctx.scaler_ctl.vscalefactor > 0x401 ? ctx.scaler_ctl.vscalefactor / 1024.f : 1.f;
+		minX = ctx.fb_X_CLIP.min * scaleX;
+		maxX = (ctx.fb_X_CLIP.max + 1) * scaleX;
+		minY = ctx.fb_Y_CLIP.min * scaleY;
+		maxY = (ctx.fb_Y_CLIP.max + 1) * scaleY;
+	}
+	baseClip[0] = std::clamp((int)lroundf(minX), 0, (int)width);
+	baseClip[1] = std::clamp((int)lroundf(minY), 0, (int)height);
+	baseClip[2] = std::clamp((int)lroundf(maxX), 0, (int)width);
+	baseClip[3] = std::clamp((int)lroundf(maxY), 0, (int)height);
+
+	RenderPass previousPass {};
+	for (const RenderPass& pass : ctx.render_passes)
+	{
+		passNumber++;
+		addPolys(ctx, ctx.global_param_op, previousPass.op_count, pass.op_count - previousPass.op_count, ListType_Opaque, false);
+		addPolys(ctx, ctx.global_param_pt, previousPass.pt_count, pass.pt_count - previousPass.pt_count, ListType_Punch_Through, false);
+		if (config::ModifierVolumes)
+			addVolumes(ctx, previousPass.mvo_count, pass.mvo_count - previousPass.mvo_count);
+		if (pass.autosort)
+		{
+			if (!config::PerStripSorting)
+				addSortedTriangles(ctx, previousPass.sorted_tr_count, pass.sorted_tr_count - previousPass.sorted_tr_count);
+			else
+				addPolys(ctx, ctx.global_param_tr, previousPass.tr_count, pass.tr_count - previousPass.tr_count, ListType_Translucent, true);
+		}
+		else
+		{
+			addPolys(ctx, ctx.global_param_tr, previousPass.tr_count, pass.tr_count - previousPass.tr_count, ListType_Translucent, false);
+		}
+		previousPass = pass;
+	}
+	renderTiles();
+}
+
+void Rasterizer::addPolys(const rend_context& ctx, const std::vector<PolyParam>& polys, u32 first, u32 count, u32 listType, bool sorted)
+{
+	for (u32 i = first; i < first + count; i++)
+	{
+		const PolyParam& pp = polys[i];
+		if (pp.count < 3 || pp.isNaomi2())
+			continue;
+		if ((listType == ListType_Opaque || (listType == ListType_Translucent && !sorted))
+				&& pp.isp.DepthMode == 0)
+			// depth func = never
+			continue;
+		const u32 *idx = &ctx.idx[pp.first];
+		for (u32 j = 0; j + 2 < pp.count; j++)
+			addTriangle(ctx, pp, listType, sorted, &ctx.verts[idx[j]], &ctx.verts[idx[j + 1]], &ctx.verts[idx[j + 2]], j & 1);
+	}
+}
+
+void Rasterizer::addSortedTriangles(const rend_context& ctx, u32 first, u32 count)
+{
+	for (u32 i = first; i < first + count; i++)
+	{
+		const SortedTriangle& st = ctx.sortedTriangles[i];
+		const PolyParam& pp = ctx.global_param_tr[st.polyIndex];
+		if (pp.isNaomi2())
+			continue;
+		const u32 *idx = &ctx.idx[st.first];
+		for (u32 j = 0; j + 2 < st.count; j += 3)
+			addTriangle(ctx, pp, ListType_Translucent, true, &ctx.verts[idx[j]], &ctx.verts[idx[j + 1]], &ctx.verts[idx[j + 2]], false);
+	}
+}
+
+void Rasterizer::addVolumes(const rend_context& ctx, u32 first, u32 count)
+{
+	if (count == 0 || ctx.modtrig.empty())
+		return;
+	bool groupStarted = false;
+	for (u32 i = first; i < first + count; i++)
+	{
+		const ModifierVolumeParam& param = ctx.global_param_mvo[i];
+		if (param.count == 0)
+			continue;
+		const u32 mode = param.isp.DepthMode;
+		if (!groupStarted)
+		{
+			groupStarted = true;
+			volumeGroup++;
+		}
+		// or'ing for open volumes and quads, xor'ing for closed volumes
+		const bool orMode = !param.isp.VolumeLast && mode > 0;
+		if (!param.isNaomi2())
+		{
+			for (u32 t = param.first; t < param.first + param.count; t++)
+			{
+				const ModTriangle& mt = ctx.modtrig[t];
+				float area = (mt.x1 - mt.x0) * (mt.y2 - mt.y0) - (mt.y1 - mt.y0) * (mt.x2 - mt.x0);
+				VolumeTriangle tri;
+				tri.orMode = orMode;
+				bool valid;
+				if (area < 0)
+					valid = setupEdges(tri.edges, mt.x0, mt.y0, mt.z0, mt.x2, mt.y2, mt.z2, mt.x1, mt.y1, mt.z1);
+				else
+					valid = setupEdges(tri.edges, mt.x0, mt.y0, mt.z0, mt.x1, mt.y1, mt.z1, mt.x2, mt.y2, mt.z2);
+				if (!valid)
+					continue;
+				// Mark the tiles touched by the volume, culled triangles included
+				for (int ty = tri.edges.minY / TileSize; ty <= (tri.edges.maxY - 1) / (int)TileSize; ty++)
+					for (int tx = tri.edges.minX / TileSize; tx <= (tri.edges.maxX - 1) / (int)TileSize; tx++)
+					{
+						volumeStamp[ty * tilesX + tx] = volumeGroup;
+						passStamp[ty * tilesX + tx] = passNumber;
+					}
+				// Same culling as the gl renderer
+				if ((param.isp.CullMode == 2 && area < 0) || (param.isp.CullMode == 3 && area > 0))
+					continue;
+				volumes.push_back(tri);
+				bin(tri.edges, CommandType::Volume, volumes.size() - 1);
+			}
+		}
+		if (mode == 1 || mode == 2)
+		{
+			// Inclusion or exclusion volume: sum the area
+			binToTouchedTiles(mode == 1 ? CommandType::Inclusion : CommandType::Exclusion, volumeGroup);
+			groupStarted = false;
+		}
+	}
+	binToTouchedTiles(CommandType::Shadow, passNumber);
+}
+
+void Rasterizer::addTriangle(const rend_context& ctx, const PolyParam& pp, u32 listType, bool sorted,
+		const Vertex *v0, const Vertex *v1, const Vertex *v2, bool flip)
+{
+	// Flat shading uses the last vertex
+	const Vertex *provoking = v2;
+	if (flip)
+		// odd triangle in a strip
+		std::swap(v0, v1);
+	const float area = (v1->x - v0->x) * (v2->y - v0->y) - (v1->y - v0->y) * (v2->x - v0->x);
+	// Same culling as the gl renderer
+	if ((pp.isp.CullMode == 2 && area > 0) || (pp.isp.CullMode == 3 && area < 0))
+		return;
+	if (area < 0)
+		std::swap(v1, v2);
+
+	Triangle tri;
+	if (!setupEdges(tri.edges, v0->x, v0->y, v0->z, v1->x, v1->y, v1->z, v2->x, v2->y, v2->z))
+		return;
+
+	tri.pp = &pp;
+	tri.listType = listType;
+	if (listType == ListType_Punch_Through || (listType == ListType_Translucent && sorted))
+		tri.depthFunc = 6; // >=
+	else
+		tri.depthFunc = pp.isp.DepthMode;
+	if (sorted)
+		tri.depthWrite = false;
+	else
+		// Z Write Disable seems to be ignored for punch-through
+		tri.depthWrite = listType == ListType_Punch_Through || !pp.isp.ZWriteDis;
+	tri.stencil = pp.pcw.Shadow ? 0x80 : 0;
+
+	// Tile clipping
+	tri.clipMode = ClipOff;
+	const u32 clipmode = pp.tileclip >> 28;
+	if (config::Clipping && clipmode >= 2)
+	{
+		const int csx = (pp.tileclip & 63) * 32;
+		const int cex = (((pp.tileclip >> 6) & 63) + 1) * 32;
+		const int csy = ((pp.tileclip >> 12) & 31) * 32;
+		const int cey = (((pp.tileclip >> 17) & 31) + 1) * 32;
+		if (clipmode & 1)
+		{
+			tri.clipMode = ClipInside;
+			tri.clip[0] = csx;
+			tri.clip[1] = csy;
+			tri.clip[2] = cex;
+			tri.clip[3] = cey;
+		}
+		else
+		{
+			Edges& e = tri.edges;
+			e.minX = std::max(e.minX, csx);
+			e.minY = std::max(e.minY, csy);
+			e.maxX = std::min(e.maxX, cex);
+			e.maxY = std::min(e.maxY, cey);
+			if (e.minX >= e.maxX || e.minY >= e.maxY)
+				return;
+		}
+	}
+
+	const float dx1 = v1->x - v0->x;
+	const float dy1 = v1->y - v0->y;
+	const float dx2 = v2->x - v0->x;
+	const float dy2 = v2->y - v0->y;
+	const float invArea = 1.f / (dx1 * dy2 - dy1 * dx2);
+
+	tri.gouraud = pp.pcw.Gouraud;
+	for (int i = 0; i < 4; i++)
+	{
+		if (tri.gouraud)
+		{
+			tri.col[i] = makePlane(dx1, dy1, dx2, dy2, invArea, v0->col[i] / 255.f * v0->z, v1->col[i] / 255.f * v1->z, v2->col[i] / 255.f * v2->z);
+			tri.spc[i] = makePlane(dx1, dy1, dx2, dy2, invArea, v0->spc[i] / 255.f * v0->z, v1->spc[i] / 255.f * v1->z, v2->spc[i] / 255.f * v2->z);
+		}
+		else
+		{
+			tri.col[i] = constantPlane(provoking->col[i] / 255.f);
+			tri.spc[i] = constantPlane(provoking->spc[i] / 255.f);
+		}
+	}
+
+	tri.texels = nullptr;
+	tri.indices = nullptr;
+	const Texture *texture = (const Texture *)pp.texture;
+	if (pp.pcw.Texture && texture != nullptr && !texture->levels.empty())
+	{
+		tri.u = makePlane(dx1, dy1, dx2, dy2, invArea, v0->u * v0->z, v1->u * v1->z, v2->u * v2->z);
+		tri.v = makePlane(dx1, dy1, dx2, dy2, invArea, v0->v * v0->z, v1->v * v1->z, v2->v * v2->z);
+
+		if (config::TextureFiltering == 0)
+			tri.nearest = pp.tsp.FilterMode == 0;
+		else
+			tri.nearest = config::TextureFiltering == 1;
+		// Mipmaps are only used with bilinear filtering. Select a single level for the whole triangle.
+		u32 level = 0;
+		if (texture->levels.size() > 1 && !tri.nearest && listType != ListType_Punch_Through)
+		{
+			const Texture::Level& base = texture->levels[0];
+			const float uvArea = std::abs((v1->u - v0->u) * (v2->v - v0->v) - (v1->v - v0->v) * (v2->u - v0->u))
+					* base.width * base.height;
+			const float lod = 0.5f * std::log2(uvArea * std::abs(invArea)) + D_Adjust_LoD_Bias[pp.tsp.MipMapD];
+			if (lod > 0.f)
+				level = std::min((u32)(lod + 0.5f), (u32)texture->levels.size() - 1);
+		}
+		const Texture::Level& mip = texture->levels[level];
+		tri.texWidth = mip.width;
+		tri.texHeight = mip.height;
+		if (texture->gpuPalette)
+		{
+			tri.indices = &texture->indices[mip.offset];
+			if (pp.tcw.PixelFmt == PixelPal4)
+				tri.paletteIndex = pp.tcw.PalSelect << 4;
+			else
+				tri.paletteIndex = (pp.tcw.PalSelect >> 4) << 8;
+		}
+		else
+		{
+			tri.texels = &texture->texels[mip.offset];
+		}
+		tri.wrapU = pp.tsp.ClampU ? WrapClamp : pp.tsp.FlipU ? WrapMirror : WrapRepeat;
+		tri.wrapV = pp.tsp.ClampV ? WrapClamp : pp.tsp.FlipV ? WrapMirror : WrapRepeat;
+	}
+
+	triangles.push_back(tri);
+	bin(tri.edges, CommandType::Triangle, triangles.size() - 1);
+}
+
+// Vertices must be in clockwise order (positive area)
+bool Rasterizer::setupEdges(Edges& e, float x0, float y0, float z0, float x1, float y1, float z1, float x2, float y2, float z2)
+{
+	if (!std::isfinite(x0) || !std::isfinite(y0) || !std::isfinite(z0)
+			|| !std::isfinite(x1) || !std::isfinite(y1) || !std::isfinite(z1)
+			|| !std::isfinite(x2) || !std::isfinite(y2) || !std::isfinite(z2))
+		return false;
+	const float dx1 = x1 - x0;
+	const float dy1 = y1 - y0;
+	const float dx2 = x2 - x0;
+	const float dy2 = y2 - y0;
+	const float area = dx1 * dy2 - dy1 * dx2;
+	if (!(area > 0.f) || !std::isfinite(area))
+		return false;
+
+	const float minX = std::min({ x0, x1, x2 });
+	const float maxX = std::max({ x0, x1, x2 });
+	const float minY = std::min({ y0, y1, y2 });
+	const float maxY = std::max({ y0, y1, y2 });
+	e.minX = std::max(baseClip[0], (int)std::max(std::floor(minX), -1.f));
+	e.minY = std::max(baseClip[1], (int)std::max(std::floor(minY), -1.f));
+	e.maxX = std::min(baseClip[2], (int)std::min(std::ceil(maxX), (float)width));
+	e.maxY = std::min(baseClip[3], (int)std::min(std::ceil(maxY), (float)height));
+	if (e.minX >= e.maxX || e.minY >= e.maxY)
+		return false;
+
+	e.x0 = x0;
+	e.y0 = y0;
+	const float vx[3] { 0.f, dx1, dx2 };
+	const float vy[3] { 0.f, dy1, dy2 };
+	for (int i = 0; i < 3; i++)
+	{
+		const int j = (i + 1) % 3;
+		e.a[i] = vy[i] - vy[j];
+		e.b[i] = vx[j] - vx[i];
+		e.c[i] = -(e.a[i] * vx[i] + e.b[i] * vy[i]);
+		// top or left edge
+		e.topLeft[i] = e.a[i] > 0.f || (e.a[i] == 0.f && e.b[i] > 0.f);
+	}
+	e.z = makePlane(dx1, dy1, dx2, dy2, 1.f / area, z0, z1, z2);
+
+	return true;
+}
+
+void Rasterizer::bin(const Edges& edges, CommandType type, u32 index)
+{
+	const u32 tx0 = edges.minX / TileSize;
+	const u32 tx1 = (edges.maxX - 1) / TileSize;
+	const u32 ty0 = edges.minY / TileSize;
+	const u32 ty1 = (edges.maxY - 1) / TileSize;
+	for (u32 ty = ty0; ty <= ty1; ty++)
+		for (u32 tx = tx0; tx <= tx1; tx++)
+			tileCommands[ty * tilesX + tx].push_back({ type, index });
+}
+
+void Rasterizer::binToTouchedTiles(CommandType type, u32 stamp)
+{
+	const std::vector<u32>& stamps = type == CommandType::Shadow ? passStamp : volumeStamp;
+	for (u32 tile = 0; tile < stamps.size(); tile++)
+		if (stamps[tile] == stamp)
+			tileCommands[tile].push_back({ type, 0 });
+}
+
+void Rasterizer::renderTiles()
+{
+	nextTile = 0;
+	auto work = [this]() {
+		std::unique_ptr<TileBuffers> buffers = std::make_unique<TileBuffers>();
+		const u32 tileCount = tilesX * tilesY;
+		for (;;)
+		{
+			const u32 tile = nextTile++;
+			if (tile >= tileCount)
+				break;
+			renderTile(tile, *buffers);
+		}
+	};
+	for (WorkerThread& worker : workers)
+		worker.run(work);
+	work();
+	for (WorkerThread& worker : workers)
+		worker.flush();
+}
+
+void Rasterizer::renderTile(u32 tile, TileBuffers& buffers)
+{
+	const int tileX = (tile % tilesX) * TileSize;
+	const int tileY = (tile / tilesX) * TileSize;
+	std::fill(std::begin(buffers.color), std::end(buffers.color), clearColor);
+	std::fill(std::begin(buffers.depth), std::end(buffers.depth), 0.f);
+	std::fill(std::begin(buffers.stencil), std::end(buffers.stencil), 0);
+
+	for (const Command& command : tileCommands[tile])
+	{
+		switch (command.type)
+		{
+		case CommandType::Triangle:
+			drawTriangle(triangles[command.index], tileX, tileY, buffers);
+			break;
+		case CommandType::Volume:
+			drawVolume(volumes[command.index], tileX, tileY, buffers);
+			break;
+		case CommandType::Inclusion:
+			// if (st & 3) st = 1
+			for (u8& st : buffers.stencil)
+				if (st & 3)
+					st = (st & ~3) | 1;
+			break;
+		case CommandType::Exclusion:
+			// if ((st & 3) != 1) st = 0
+			for (u8& st : buffers.stencil)
+				if ((st & 3) != 1)
+					st &= ~3;
+			break;
+		case CommandType::Shadow:
+			for (u32 i = 0; i < TileSize * TileSize; i++)
+			{
+				u8& st = buffers.stencil[i];
+				if ((st & 0x81) == 0x81)
+				{
+					glm::vec4 color = unpackColor(buffers.color[i]);
+					color = glm::vec4(glm::vec3(color) * state.shadowScale, color.a);
+					buffers.color[i] = packColor(color);
+				}
+				st &= ~3;
+			}
+			break;
+		}
+	}
+	for (u32 y = 0; y < TileSize; y++)
+		memcpy(&frame[(tileY + y) * width + tileX], &buffers.color[y * TileSize], TileSize * sizeof(u32));
+}
+
+void Rasterizer::drawTriangle(const Triangle& tri, int tileX, int tileY, TileBuffers& buffers)
+{
+	const Edges& e = tri.edges;
+	const int x0 = std::max(e.minX, tileX);
+	const int x1 = std::min(e.maxX, tileX + (int)TileSize);
+	const int y0 = std::max(e.minY, tileY);
+	const int y1 = std::min(e.maxY, tileY + (int)TileSize);
+	if (x0 >= x1 || y0 >= y1)
+		return;
+	const int n = x1 - x0;
+	const float px = x0 + 0.5f - e.x0;
+	const TSP tsp = tri.pp->tsp;
+
+	alignas(32) float z[TileSize];
+	alignas(32) s32 mask[TileSize];
+	for (int y = y0; y < y1; y++)
+	{
+		const float py = y + 0.5f - e.y0;
+		spanCoverage(e, px, py, n, z, mask);
+		if (tri.clipMode == ClipInside && y >= tri.clip[1] && y < tri.clip[3])
+			for (int i = 0; i < n; i++)
+				mask[i] &= (s32)(x0 + i < tri.clip[0] || x0 + i >= tri.clip[2]);
+		const u32 offset = (y - tileY) * TileSize + x0 - tileX;
+		float *depth = &buffers.depth[offset];
+		if (!depthTest(tri.depthFunc, z, depth, mask, n))
+			return;
+		u32 *color = &buffers.color[offset];
+		u8 *stencil = &buffers.stencil[offset];
+		for (int i = 0; i < n; i++)
+		{
+			if (!mask[i])
+				continue;
+			glm::vec4 fragColor;
+			if (!shadePixel(tri, px + i, py, z[i], fragColor))
+				continue;
+			color[i] = blend(tsp, fragColor, color[i]);
+			if (tri.depthWrite)
+				depth[i] = z[i];
+			stencil[i] = tri.stencil;
+		}
+	}
+}
+
+void Rasterizer::drawVolume(const VolumeTriangle& tri, int tileX, int tileY, TileBuffers& buffers)
+{
+	const Edges& e = tri.edges;
+	const int x0 = std::max(e.minX, tileX);
+	const int x1 = std::min(e.maxX, tileX + (int)TileSize);
+	const int y0 = std::max(e.minY, tileY);
+	const int y1 = std::min(e.maxY, tileY + (int)TileSize);
+	if (x0 >= x1 || y0 >= y1)
+		return;
+	const int n = x1 - x0;
+	const float px = x0 + 0.5f - e.x0;
+
+	alignas(32) float z[TileSize];
+	alignas(32) s32 mask[TileSize];
+	for (int y = y0; y < y1; y++)
+	{
+		spanCoverage(e, px, y + 0.5f - e.y0, n, z, mask);
+		const u32 offset = (y - tileY) * TileSize + x0 - tileX;
+		// Volume is in front of the pixel
+		depthTest(4, z, &buffers.depth[offset], mask, n);
+		u8 *stencil = &buffers.stencil[offset];
+		if (tri.orMode)
+			for (int i = 0; i < n; i++)
+				stencil[i] |= (u8)(mask[i] << 1);
+		else
+			for (int i = 0; i < n; i++)
+				stencil[i] ^= (u8)(mask[i] << 1);
+	}
+}
+
+}	// namespace software
@@ -0,0 +1,157 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "types.h"
+#include "hw/pvr/ta_ctx.h"
+#include "stdclass.h"
+#include <atomic>
+#include <deque>
+#include <vector>
+
+namespace software
+{
+
+class Texture;
+
+//
+// Tile-based rasterizer for the ta render context.
+// Like the PowerVR2 ISP, the frame is split into 32x32 tiles. Primitives are first binned
+// into the tiles they overlap, then tiles are rendered independently by a pool of worker threads.
+// Each tile is rendered start to finish in local color, depth and stencil buffers so the
+// draw order within a tile is preserved.
+//
+class Rasterizer
+{
+public:
+	static constexpr u32 TileSize = 32;
+
+	Rasterizer();
+
+	// Render the context into a width x height RGBA8888 frame, top line first.
+	// width and height must be multiples of TileSize.
+	void render(const rend_context& ctx, u32 width, u32 height, u32 clearColor);
+
+	const u32 *data() const { return frame.data(); }
+	u32 getWidth() const { return width; }
+	u32 getHeight() const { return height; }
+
+	struct Plane
+	{
+		float dx, dy, c;	// relative to the primitive origin
+
+		float at(float x, float y) const { return c + dx * x + dy * y; }
+	};
+
+	struct Edges
+	{
+		float x0, y0;		// origin of edge equations and planes
+		float a[3], b[3], c[3];
+		bool topLeft[3];
+		int minX, minY, maxX, maxY;	// bounding box, max exclusive
+		Plane z;
+	};
+
+	struct Triangle
+	{
+		Edges edges;
+		Plane u, v;			// u/w, v/w
+		Plane col[4];		// divided by w if gouraud
+		Plane spc[4];
+		bool gouraud;
+		const PolyParam *pp;
+		// texture
+		const u32 *texels;
+		const u8 *indices;
+		u32 texWidth, texHeight;
+		u32 paletteIndex;
+		u8 wrapU, wrapV;
+		bool nearest;
+		// pipeline state
+		u8 listType;
+		u8 depthFunc;
+		bool depthWrite;
+		u8 stencil;
+		u8 clipMode;		// 0: off, 1: discard inside, 2: discard outside
+		int clip[4];		// x min, y min, x max, y max (exclusive)
+	};
+
+	struct VolumeTriangle
+	{
+		Edges edges;
+		bool orMode;		// or: set the volume bit, otherwise xor
+	};
+
+private:
+	enum class CommandType : u8 {
+		Triangle,
+		Volume,
+		Inclusion,
+		Exclusion,
+		Shadow
+	};
+
+	struct Command
+	{
+		CommandType type;
+		u32 index;
+	};
+
+	struct TileBuffers
+	{
+		u32 color[TileSize * TileSize];
+		float depth[TileSize * TileSize];
+		u8 stencil[TileSize * TileSize];
+	};
+
+	void addPolys(const rend_context& ctx, const std::vector<PolyParam>& polys, u32 first, u32 count, u32 listType, bool sorted);
+	void addSortedTriangles(const rend_context& ctx, u32 first, u32 count);
+	void addVolumes(const rend_context& ctx, u32 first, u32 count);
+	void addTriangle(const rend_context& ctx, const PolyParam& pp, u32 listType, bool sorted,
+			const Vertex *v0, const Vertex *v1, const Vertex *v2, bool flip);
+	bool setupEdges(Edges& edges, float x0, float y0, float z0, float x1, float y1, float z1, float x2, float y2, float z2);
+	void bin(const Edges& edges, CommandType type, u32 index);
+	void binToTouchedTiles(CommandType type, u32 stamp);
+
+	void renderTiles();
+	void renderTile(u32 tile, TileBuffers& buffers);
+	void drawTriangle(const Triangle& tri, int tileX, int tileY, TileBuffers& buffers);
+	void drawVolume(const VolumeTriangle& tri, int tileX, int tileY, TileBuffers& buffers);
+
+	u32 width = 0;
+	u32 height = 0;
+	u32 tilesX = 0;
+	u32 tilesY = 0;
+	u32 clearColor = 0;
+	int baseClip[4] {};
+	std::vector<u32> frame;
+
+	std::vector<Triangle> triangles;
+	std::vector<VolumeTriangle> volumes;
+	std::vector<std::vector<Command>> tileCommands;
+	// Last volume group and render pass that touched each tile
+	std::vector<u32> volumeStamp;
+	std::vector<u32> passStamp;
+	u32 volumeGroup = 0;
+	u32 passNumber = 0;
+
+	std::deque<WorkerThread> workers;
+	std::atomic<u32> nextTile;
+};
+
+}	// namespace software
@@ -0,0 +1,281 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "sw_rasterizer.h"
+#include "sw_texture.h"
+#include "hw/pvr/ta.h"
+#include "hw/pvr/pvr_mem.h"
+#include "hw/pvr/Renderer_if.h"
+#include "rend/transform_matrix.h"
+#include "cfg/option.h"
+
+//
+// Renderer running entirely on the cpu, for hosts without a usable gpu.
+// Frames are only available through GetLastFrame() and the emulated framebuffer.
+//
+namespace software
+{
+
+class SoftwareRenderer final : public Renderer
+{
+public:
+	bool Init() override
+	{
+		frameRendered = false;
+		return true;
+	}
+
+	void Term() override
+	{
+		texCache.Clear();
+		lastFrame.clear();
+	}
+
+	void Process(TA_context *ctx) override
+	{
+		if (KillTex)
+			texCache.Clear();
+		texCache.Cleanup();
+		ta_parse(ctx, false);
+	}
+
+	bool Render() override;
+	void RenderFramebuffer(const FramebufferInfo& info) override;
+	bool GetLastFrame(std::vector<u8>& data, int& width, int& height) override;
+
+	bool Present() override
+	{
+		if (!frameRendered)
+			return false;
+		frameRendered = false;
+		return true;
+	}
+
+	BaseTextureCacheData *GetTexture(TSP tsp, TCW tcw) override
+	{
+		Texture *tf = texCache.getTextureCacheData(tsp, tcw);
+		if (tf->NeedsUpdate())
+		{
+			if (!tf->Update())
+				tf = nullptr;
+		}
+		else if (tf->IsCustomTextureAvailable())
+		{
+			tf->CheckCustomTexture();
+		}
+		return tf;
+	}
+
+private:
+	void writeRenderToTexture();
+	void writeFramebuffer();
+
+	TextureCache texCache;
+	Rasterizer rasterizer;
+	// Last displayed frame, RGBA8888 top line first
+	std::vector<u32> lastFrame;
+	u32 frameWidth = 0;
+	u32 frameHeight = 0;
+	bool frameRendered = false;
+};
+
+bool SoftwareRenderer::Render()
+{
+	const rend_context& ctx = pvrrc;
+	u32 width = (ctx.ta_GLOB_TILE_CLIP.tile_x_num + 1) * Rasterizer::TileSize;
+	u32 height = (ctx.ta_GLOB_TILE_CLIP.tile_y_num + 1) * Rasterizer::TileSize;
+	if (ctx.isRTT)
+	{
+		constexpr u32 mask = Rasterizer::TileSize - 1;
+		width = std::max(width, (ctx.getFramebufferWidth() + mask) & ~mask);
+		height = std::max(height, (ctx.getFramebufferHeight() + mask) & ~mask);
+	}
+	const u32 clearColor = ctx.isRTT ? 0
+			: VO_BORDER_COL._red | (VO_BORDER_COL._green << 8) | (VO_BORDER_COL._blue << 16) | 0xff000000;
+	rasterizer.render(ctx, width, height, clearColor);
+
+	if (ctx.isRTT)
+	{
+		writeRenderToTexture();
+		return false;
+	}
+	writeFramebuffer();
+
+	return true;
+}
+
+void SoftwareRenderer::writeRenderToTexture()
+{
+	const u32 w = pvrrc.getFramebufferWidth();
+	const u32 h = pvrrc.getFramebufferHeight();
+	u32 linestride = pvrrc.fb_W_LINESTRIDE * 8;
+	if (linestride == 0)
+		linestride = w * 2;
+	const u32 texAddr = pvrrc.fb_W_SOF1 & VRAM_MASK;
+	if (w == 0 || h == 0 || texAddr + (h - 1) * linestride + w * 2 > VRAM_SIZE)
+		return;
+
+	std::vector<u32> pixels(w * h);
+	for (u32 y = 0; y < h; y++)
+		memcpy(&pixels[y * w], rasterizer.data() + y * rasterizer.getWidth(), w * sizeof(u32));
+	WriteTextureToVRam(w, h, (const u8 *)pixels.data(), (u16 *)&vram[texAddr], pvrrc.fb_W_CTRL, linestride);
+}
+
+void SoftwareRenderer::writeFramebuffer()
+{
+	u32 width = rasterizer.getWidth();
+	u32 height = rasterizer.getHeight();
+	const float xscale = pvrrc.scaler_ctl.hscale == 1 ? 0.5f : 1.f;
+	float yscale = 1024.f / pvrrc.scaler_ctl.vscalefactor;
+	if (std::abs(yscale - 1.f) < 0.01)
+		yscale = 1.f;
+	FB_X_CLIP_type xClip = pvrrc.fb_X_CLIP;
+	FB_Y_CLIP_type yClip = pvrrc.fb_Y_CLIP;
+
+	const u32 scaledW = std::max<u32>(width * xscale, 1);
+	const u32 scaledH = std::max<u32>(height * yscale, 1);
+	// Average the source pixels when downscaling, repeat them when upscaling
+	const u32 blockW = xscale < 1.f ? std::lround(1.f / xscale) : 1;
+	const u32 blockH = yscale < 1.f ? std::lround(1.f / yscale) : 1;
+	lastFrame.resize(scaledW * scaledH);
+	const u32 *src = rasterizer.data();
+	for (u32 y = 0; y < scaledH; y++)
+	{
+		const u32 sy = std::min<u32>(y / yscale, height - 1);
+		for (u32 x = 0; x < scaledW; x++)
+		{
+			const u32 sx = std::min<u32>(x / xscale, width - 1);
+			if (blockW == 1 && blockH == 1)
+			{
+				lastFrame[y * scaledW + x] = src[sy * width + sx];
+				continue;
+			}
+			u32 sum[4] {};
+			u32 count = 0;
+			for (u32 by = sy; by < std::min(sy + blockH, height); by++)
+				for (u32 bx = sx; bx < std::min(sx + blockW, width); bx++, count++)
+				{
+					const u32 pixel = src[by * width + bx];
+					for (int i = 0; i < 4; i++)
+						sum[i] += (pixel >> (i * 8)) & 0xff;
+				}
+			u32 pixel = 0;
+			for (int i = 0; i < 4; i++)
+				pixel |= ((sum[i] + count / 2) / count) << (i * 8);
+			lastFrame[y * scaledW + x] = pixel;
+		}
+	}
+	frameWidth = scaledW;
+	frameHeight = scaledH;
+
+	if (!config::EmulateFramebuffer)
+	{
+		frameRendered = true;
+		return;
+	}
+	// FB_Y_CLIP is applied before vscalefactor if > 1, so it must be scaled here
+	if (yscale > 1)
+	{
+		yClip.min = std::round(yClip.min * yscale);
+		yClip.max = std::round(yClip.max * yscale);
+	}
+	xClip.min = std::min(xClip.min, scaledW - 1);
+	xClip.max = std::min(xClip.max, scaledW - 1);
+	yClip.min = std::min(yClip.min, scaledH - 1);
+	yClip.max = std::min(yClip.max, scaledH - 1);
+	WriteFramebuffer(scaledW, scaledH, (const u8 *)lastFrame.data(), pvrrc.fb_W_SOF1 & VRAM_MASK,
+			pvrrc.fb_W_CTRL, pvrrc.fb_W_LINESTRIDE * 8, xClip, yClip);
+}
+
+void SoftwareRenderer::RenderFramebuffer(const FramebufferInfo& info)
+{
+	int width, height;
+	if (info.fb_r_ctrl.fb_enable == 0 || info.vo_control.blank_video == 1)
+	{
+		// Video output disabled
+		getDCFramebufferReadSize(info, width, height);
+		const u32 color = info.vo_border_col._red | (info.vo_border_col._green << 8) | (info.vo_border_col._blue << 16) | 0xff000000;
+		lastFrame.assign(std::max(width * height, 0), color);
+	}
+	else
+	{
+		PixelBuffer<u32> pb;
+		ReadFramebuffer<RGBAPacker>(info, pb, width, height);
+		lastFrame.assign(pb.data(), pb.data() + width * height);
+	}
+	frameWidth = std::max(width, 0);
+	frameHeight = std::max(height, 0);
+	frameRendered = true;
+}
+
+bool SoftwareRenderer::GetLastFrame(std::vector<u8>& data, int& width, int& height)
+{
+	if (lastFrame.empty() || frameWidth == 0 || frameHeight == 0)
+		return false;
+	// The picture isn't rendered in wide screen so the dreamcast aspect ratio is used
+	const float aspectRatio = getDCFramebufferAspectRatio();
+	int srcWidth = frameWidth;
+	int srcHeight = frameHeight;
+	if (config::Rotate90)
+		std::swap(srcWidth, srcHeight);
+	if (width != 0) {
+		height = width / aspectRatio;
+	}
+	else if (height != 0) {
+		width = aspectRatio * height;
+	}
+	else
+	{
+		width = srcWidth;
+		height = srcHeight;
+		// We need square pixels for PNG
+		int w = aspectRatio * height;
+		if (width > w)
+			height = width / aspectRatio;
+		else
+			width = w;
+	}
+	if (width <= 0 || height <= 0)
+		return false;
+
+	data.resize(width * height * 3);
+	u8 *dst = data.data();
+	for (int y = 0; y < height; y++)
+	{
+		const int ry = y * srcHeight / height;
+		for (int x = 0; x < width; x++)
+		{
+			const int rx = x * srcWidth / width;
+			u32 pixel;
+			if (config::Rotate90)
+				pixel = lastFrame[rx * frameWidth + frameWidth - 1 - ry];
+			else
+				pixel = lastFrame[ry * frameWidth + rx];
+			*dst++ = pixel & 0xff;
+			*dst++ = (pixel >> 8) & 0xff;
+			*dst++ = (pixel >> 16) & 0xff;
+		}
+	}
+	return true;
+}
+
+}	// namespace software
+
+Renderer *rend_software() {
+	return new software::SoftwareRenderer();
+}
@@ -0,0 +1,165 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "sw_texture.h"
+
+namespace software
+{
+
+static u32 convertTexel(TextureType type, const u8 *p)
+{
+	u32 r, g, b, a;
+	switch (type)
+	{
+	case TextureType::_8888:
+		return *(const u32 *)p;
+	case TextureType::_565:
+		{
+			const u16 v = *(const u16 *)p;
+			r = (v >> 11) & 0x1f;
+			g = (v >> 5) & 0x3f;
+			b = v & 0x1f;
+			r = (r << 3) | (r >> 2);
+			g = (g << 2) | (g >> 4);
+			b = (b << 3) | (b >> 2);
+			a = 0xff;
+		}
+		break;
+	case TextureType::_5551:
+		{
+			const u16 v = *(const u16 *)p;
+			r = (v >> 11) & 0x1f;
+			g = (v >> 6) & 0x1f;
+			b = (v >> 1) & 0x1f;
+			r = (r << 3) | (r >> 2);
+			g = (g << 3) | (g >> 2);
+			b = (b << 3) | (b >> 2);
+			a = (v & 1) ? 0xff : 0;
+		}
+		break;
+	case TextureType::_4444:
+		{
+			const u16 v = *(const u16 *)p;
+			r = ((v >> 12) & 0xf) * 0x11;
+			g = ((v >> 8) & 0xf) * 0x11;
+			b = ((v >> 4) & 0xf) * 0x11;
+			a = (v & 0xf) * 0x11;
+		}
+		break;
+	default:
+		return *p;
+	}
+	return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+void Texture::UploadToGPU(int width, int height, const u8 *temp_tex_buffer, bool mipmapped, bool mipmapsIncluded)
+{
+	texels.clear();
+	indices.clear();
+	levels.clear();
+	const bool paletted = tex_type == TextureType::_8;
+	const u32 bpp = tex_type == TextureType::_8888 ? 4 : paletted ? 1 : 2;
+
+	auto addLevel = [&](u32 w, u32 h, const u8 *data) {
+		if (paletted)
+		{
+			levels.push_back({ w, h, (u32)indices.size() });
+			indices.insert(indices.end(), data, data + w * h);
+		}
+		else
+		{
+			levels.push_back({ w, h, (u32)texels.size() });
+			for (u32 i = 0; i < w * h; i++, data += bpp)
+				texels.push_back(convertTexel(tex_type, data));
+		}
+	};
+
+	if (mipmapsIncluded)
+	{
+		// Levels are stored from the smallest (1x1) to the largest
+		int levelCount = 0;
+		for (int s = width; s > 0; s /= 2)
+			levelCount++;
+		std::vector<const u8 *> levelData(levelCount);
+		const u8 *p = temp_tex_buffer;
+		for (int i = 0; i < levelCount; i++)
+		{
+			levelData[i] = p;
+			p += (1 << i) * (1 << i) * bpp;
+		}
+		for (int i = levelCount - 1; i >= 0; i--)
+			addLevel(1 << i, 1 << i, levelData[i]);
+		return;
+	}
+	addLevel(width, height, temp_tex_buffer);
+	if (!mipmapped)
+		return;
+
+	// Generate the mipmaps with a box filter, or point sampling for palette indices
+	u32 w = width;
+	u32 h = height;
+	while (w > 1 || h > 1)
+	{
+		const Level src = levels.back();
+		const u32 nw = std::max(w / 2, 1u);
+		const u32 nh = std::max(h / 2, 1u);
+		levels.push_back({ nw, nh, paletted ? (u32)indices.size() : (u32)texels.size() });
+		for (u32 y = 0; y < nh; y++)
+			for (u32 x = 0; x < nw; x++)
+			{
+				const u32 x0 = std::min(x * 2, w - 1);
+				const u32 y0 = std::min(y * 2, h - 1);
+				if (paletted)
+				{
+					const u8 index = indices[src.offset + y0 * w + x0];
+					indices.push_back(index);
+					continue;
+				}
+				const u32 x1 = std::min(x0 + 1, w - 1);
+				const u32 y1 = std::min(y0 + 1, h - 1);
+				const u32 c[4] {
+					texels[src.offset + y0 * w + x0], texels[src.offset + y0 * w + x1],
+					texels[src.offset + y1 * w + x0], texels[src.offset + y1 * w + x1]
+				};
+				u32 out = 0;
+				for (int shift = 0; shift < 32; shift += 8)
+				{
+					u32 sum = 0;
+					for (u32 t : c)
+						sum += (t >> shift) & 0xff;
+					out |= ((sum + 2) / 4) << shift;
+				}
+				texels.push_back(out);
+			}
+		w = nw;
+		h = nh;
+	}
+}
+
+bool Texture::Delete()
+{
+	if (!BaseTextureCacheData::Delete())
+		return false;
+	std::vector<u32>().swap(texels);
+	std::vector<u8>().swap(indices);
+	levels.clear();
+
+	return true;
+}
+
+}	// namespace software
@@ -0,0 +1,68 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "rend/TexCache.h"
+#include <vector>
+
+namespace software
+{
+
+// Texture kept in system memory. Texels are RGBA8888, or palette indices for
+// palette textures looked up at draw time (TextureType::_8).
+class Texture final : public BaseTextureCacheData
+{
+public:
+	Texture(TSP tsp = {}, TCW tcw = {}) : BaseTextureCacheData(tsp, tcw) {}
+	Texture(Texture&& other) : BaseTextureCacheData(std::move(other)) {
+		std::swap(texels, other.texels);
+		std::swap(indices, other.indices);
+		std::swap(levels, other.levels);
+	}
+
+	std::string GetId() override { return std::to_string((uintptr_t)this); }
+	void UploadToGPU(int width, int height, const u8 *temp_tex_buffer, bool mipmapped, bool mipmapsIncluded = false) override;
+	bool Force32BitTexture(TextureType type) const override { return type != TextureType::_8; }
+	bool Delete() override;
+
+	struct Level
+	{
+		u32 width;
+		u32 height;
+		u32 offset;		// index of the first texel
+	};
+	std::vector<u32> texels;
+	std::vector<u8> indices;
+	std::vector<Level> levels;	// level 0 is the full size texture
+};
+
+class TextureCache final : public BaseTextureCache<Texture>
+{
+public:
+	TextureCache() {
+		Texture::SetDirectXColorOrder(false);
+	}
+	~TextureCache() {
+		Clear();
+	}
+	void Cleanup() {
+		CollectCleanup();
+	}
+};
+
+}	// namespace software
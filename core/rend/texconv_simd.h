@@ -0,0 +1,240 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "types.h"
+#include <type_traits>
+
+//
+// Vector primitives used by the texture converters.
+// SSE2 and NEON are part of the x86-64 and arm64 base instruction sets so no runtime dispatch is needed.
+//
+#if HOST_CPU == CPU_X64 || ((HOST_CPU == CPU_X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#include <emmintrin.h>
+#define TEXCONV_SSE2
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define TEXCONV_NEON
+#endif
+
+#if defined(TEXCONV_SSE2) || defined(TEXCONV_NEON)
+#define TEXCONV_SIMD
+
+namespace texconv
+{
+
+#ifdef TEXCONV_SSE2
+
+using u16x8 = __m128i;
+using u32x4 = __m128i;
+
+inline static u16x8 load(const u16 *p) {
+	return _mm_loadu_si128((const __m128i *)p);
+}
+// Load two 4-pixel halves
+inline static u16x8 load(const void *lo, const void *hi) {
+	return _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)lo), _mm_loadl_epi64((const __m128i *)hi));
+}
+inline static void store(u16 *p, u16x8 v) {
+	_mm_storeu_si128((__m128i *)p, v);
+}
+inline static void storeLow(u16 *p, u16x8 v) {
+	_mm_storel_epi64((__m128i *)p, v);
+}
+inline static void storeHigh(u16 *p, u16x8 v) {
+	_mm_storel_epi64((__m128i *)p, _mm_unpackhi_epi64(v, v));
+}
+inline static void store(u32 *p, u32x4 v) {
+	_mm_storeu_si128((__m128i *)p, v);
+}
+
+inline static u16x8 set(u16 v) {
+	return _mm_set1_epi16((short)v);
+}
+inline static u16x8 and_(u16x8 a, u16x8 b) {
+	return _mm_and_si128(a, b);
+}
+inline static u16x8 or_(u16x8 a, u16x8 b) {
+	return _mm_or_si128(a, b);
+}
+template<int n>
+inline static u16x8 shl(u16x8 v) {
+	return _mm_slli_epi16(v, n);
+}
+template<int n>
+inline static u16x8 shr(u16x8 v) {
+	return _mm_srli_epi16(v, n);
+}
+
+// Signed 16-bit arithmetic
+inline static u16x8 add(u16x8 a, u16x8 b) {
+	return _mm_add_epi16(a, b);
+}
+inline static u16x8 sub(u16x8 a, u16x8 b) {
+	return _mm_sub_epi16(a, b);
+}
+inline static u16x8 mul(u16x8 a, s16 b) {
+	return _mm_mullo_epi16(a, _mm_set1_epi16(b));
+}
+template<int n>
+inline static u16x8 sar(u16x8 v) {
+	return _mm_srai_epi16(v, n);
+}
+inline static u16x8 clamp(u16x8 v, s16 min, s16 max) {
+	return _mm_min_epi16(_mm_max_epi16(v, _mm_set1_epi16(min)), _mm_set1_epi16(max));
+}
+
+// Interleave the 16-bit lanes of a and b. The first 4 lanes go to lo, the last 4 to hi.
+inline static void zip(u16x8 a, u16x8 b, u32x4& lo, u32x4& hi)
+{
+	lo = _mm_unpacklo_epi16(a, b);
+	hi = _mm_unpackhi_epi16(a, b);
+}
+
+// Copy the even (resp. odd) lane of each pair to both lanes of the pair
+inline static u16x8 dupEven(u16x8 v) {
+	return _mm_or_si128(_mm_and_si128(v, _mm_set1_epi32(0xffff)), _mm_slli_epi32(v, 16));
+}
+inline static u16x8 dupOdd(u16x8 v) {
+	return _mm_or_si128(_mm_srli_epi32(v, 16), _mm_and_si128(v, _mm_set1_epi32(0xffff0000)));
+}
+
+// Reorder a 4x4 tile of twiddled pixels into rows.
+// r02 receives rows 0 and 2, r13 rows 1 and 3.
+inline static void detwiddle4x4(u16x8 a, u16x8 b, u16x8& r02, u16x8& r13)
+{
+	// p0 p2 p4 p6 p1 p3 p5 p7
+	a = _mm_shufflelo_epi16(a, _MM_SHUFFLE(3, 1, 2, 0));
+	a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 1, 2, 0));
+	a = _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0));
+	b = _mm_shufflelo_epi16(b, _MM_SHUFFLE(3, 1, 2, 0));
+	b = _mm_shufflehi_epi16(b, _MM_SHUFFLE(3, 1, 2, 0));
+	b = _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 1, 2, 0));
+	// even: p0 p2 p4 p6 p8 p10 p12 p14 -> p0 p2 p8 p10 p4 p6 p12 p14
+	r02 = _mm_shuffle_epi32(_mm_unpacklo_epi64(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+	r13 = _mm_shuffle_epi32(_mm_unpackhi_epi64(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+#else	// TEXCONV_NEON
+
+using u16x8 = uint16x8_t;
+using u32x4 = uint32x4_t;
+
+inline static u16x8 load(const u16 *p) {
+	return vld1q_u16(p);
+}
+inline static u16x8 load(const void *lo, const void *hi) {
+	return vcombine_u16(vld1_u16((const u16 *)lo), vld1_u16((const u16 *)hi));
+}
+inline static void store(u16 *p, u16x8 v) {
+	vst1q_u16(p, v);
+}
+inline static void storeLow(u16 *p, u16x8 v) {
+	vst1_u16(p, vget_low_u16(v));
+}
+inline static void storeHigh(u16 *p, u16x8 v) {
+	vst1_u16(p, vget_high_u16(v));
+}
+inline static void store(u32 *p, u32x4 v) {
+	vst1q_u32(p, v);
+}
+
+inline static u16x8 set(u16 v) {
+	return vdupq_n_u16(v);
+}
+inline static u16x8 and_(u16x8 a, u16x8 b) {
+	return vandq_u16(a, b);
+}
+inline static u16x8 or_(u16x8 a, u16x8 b) {
+	return vorrq_u16(a, b);
+}
+template<int n>
+inline static u16x8 shl(u16x8 v) {
+	return vshlq_n_u16(v, n);
+}
+template<int n>
+inline static u16x8 shr(u16x8 v) {
+	return vshrq_n_u16(v, n);
+}
+
+inline static u16x8 add(u16x8 a, u16x8 b) {
+	return vaddq_u16(a, b);
+}
+inline static u16x8 sub(u16x8 a, u16x8 b) {
+	return vsubq_u16(a, b);
+}
+inline static u16x8 mul(u16x8 a, s16 b) {
+	return vmulq_n_u16(a, (u16)b);
+}
+template<int n>
+inline static u16x8 sar(u16x8 v) {
+	return vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(v), n));
+}
+inline static u16x8 clamp(u16x8 v, s16 min, s16 max) {
+	int16x8_t s = vreinterpretq_s16_u16(v);
+	return vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(s, vdupq_n_s16(min)), vdupq_n_s16(max)));
+}
+
+inline static void zip(u16x8 a, u16x8 b, u32x4& lo, u32x4& hi)
+{
+	uint16x8x2_t z = vzipq_u16(a, b);
+	lo = vreinterpretq_u32_u16(z.val[0]);
+	hi = vreinterpretq_u32_u16(z.val[1]);
+}
+
+inline static u16x8 dupEven(u16x8 v) {
+	return vtrnq_u16(v, v).val[0];
+}
+inline static u16x8 dupOdd(u16x8 v) {
+	return vtrnq_u16(v, v).val[1];
+}
+
+inline static void detwiddle4x4(u16x8 a, u16x8 b, u16x8& r02, u16x8& r13)
+{
+	uint16x8x2_t eo = vuzpq_u16(a, b);
+	// p0 p2 p4 p6 p8 p10 p12 p14 -> p0 p2 p8 p10 p4 p6 p12 p14
+	uint32x4x2_t even = vuzpq_u32(vreinterpretq_u32_u16(eo.val[0]), vreinterpretq_u32_u16(eo.val[0]));
+	uint32x4x2_t odd = vuzpq_u32(vreinterpretq_u32_u16(eo.val[1]), vreinterpretq_u32_u16(eo.val[1]));
+	r02 = vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(even.val[0]), vget_low_u32(even.val[1])));
+	r13 = vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(odd.val[0]), vget_low_u32(odd.val[1])));
+}
+
+#endif
+
+// Signed division by 2^n rounding toward zero, like the C division operator
+template<int n>
+inline static u16x8 divPow2(u16x8 v) {
+	return sar<n>(add(v, and_(sar<15>(v), set((1 << n) - 1))));
+}
+
+// Store 8 pixels
+inline static void store(u32 *p, u32x4 lo, u32x4 hi)
+{
+	store(p, lo);
+	store(p + 4, hi);
+}
+
+// Unpackers and pixel convertors with a vector implementation define Simd = true
+template<typename T, typename = void>
+struct IsSimd : std::false_type {};
+template<typename T>
+struct IsSimd<T, std::enable_if_t<T::Simd>> : std::true_type {};
+
+}	// namespace texconv
+
+#endif	// TEXCONV_SIMD
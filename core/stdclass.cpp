@@ -189,6 +189,64 @@ void cResetEvent::Wait()
     state = false;
 }
 
+void WorkerThread::run(Function&& task)
+{
+	std::lock_guard<std::mutex> _(mutex);
+	tasks.push_back(std::move(task));
+	if (!running)
+	{
+		running = true;
+		thread = std::thread(&WorkerThread::loop, this);
+	}
+	else
+	{
+		cond.notify_one();
+	}
+}
+
+void WorkerThread::flush()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	idleCond.wait(lock, [this]() { return tasks.empty() && !busy; });
+}
+
+void WorkerThread::stop()
+{
+	{
+		std::lock_guard<std::mutex> _(mutex);
+		running = false;
+		cond.notify_one();
+	}
+	if (!thread.joinable())
+		return;
+	if (thread.get_id() != std::this_thread::get_id())
+		thread.join();
+	else
+		thread.detach();
+}
+
+void WorkerThread::loop()
+{
+	ThreadName _(name);
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;)
+	{
+		cond.wait(lock, [this]() { return !running || !tasks.empty(); });
+		if (tasks.empty())
+			break;
+		Function task = std::move(tasks.front());
+		tasks.pop_front();
+		busy = true;
+		lock.unlock();
+		task();
+		lock.lock();
+		busy = false;
+		if (tasks.empty())
+			idleCond.notify_all();
+	}
+	idleCond.notify_all();
+}
+
 void RamRegion::serialize(Serializer &ser) const {
 	ser.serialize(data, size);
 }
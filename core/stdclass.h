@@ -6,6 +6,7 @@
 #include <cctype>
 #include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -58,6 +59,35 @@ public :
 	void Wait();	//Wait for signal , then reset[if auto]
 };
 
+// Runs tasks sequentially on a dedicated background thread
+class WorkerThread
+{
+public:
+	using Function = std::function<void()>;
+
+	WorkerThread(const char *name) : name(name) {}
+	~WorkerThread() { stop(); }
+
+	// Queue a task. The thread is started on first use.
+	void run(Function&& task);
+	// Wait until all queued tasks are done
+	void flush();
+	// Run the remaining tasks and terminate the thread
+	void stop();
+
+private:
+	void loop();
+
+	const char *name;
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::condition_variable idleCond;
+	std::deque<Function> tasks;
+	bool running = false;
+	bool busy = false;
+};
+
 void set_user_config_dir(const std::string& dir);
 void set_user_data_dir(const std::string& dir);
 void add_system_config_dir(const std::string& dir);
@@ -98,6 +98,7 @@ enum class RenderType {
 	DirectX9 = 1,
 	DirectX11 = 2,
 	DirectX11_OIT = 6,
+	Software = 7,
 };
 
 static inline bool isOpenGL(RenderType renderType)  {
@@ -2262,6 +2262,9 @@ static void gui_settings_video()
     			"Very slow and incompatible with upscaling and wide screen.");
     	OptionCheckbox("Load Custom Textures", config::CustomTextures,
     			"Load custom/high-res textures from data/textures/<game id>");
+    	OptionCheckbox("Asynchronous Texture Decoding", config::AsyncTextureDecode,
+    			"Decode new textures on background threads. Reduces stuttering when many textures are loaded at once. "
+    			"Textures may appear a few frames late.");
     }
 	ImGui::Spacing();
     header("Aspect Ratio");
@@ -2477,6 +2480,8 @@ static void gui_settings_audio()
 {
 	OptionCheckbox("Enable DSP", config::DSPEnabled,
 			"Enable the Dreamcast Digital Sound Processor. Only recommended on fast platforms");
+	OptionCheckbox("Threaded Audio", config::ThreadedAudio,
+			"Run the sound CPU and audio generation on a separate thread. Sound timing may vary slightly. Disabled when playing online");
     OptionCheckbox("Enable VMU Sounds", config::VmuSound, "Play VMU beeps when enabled.");
 
 	if (OptionSlider("Volume Level", config::AudioVolume, 0, 100, "Adjust the emulator's audio level", "%d%%"))
@@ -2497,6 +2502,14 @@ static void gui_settings_audio()
 		ImGui::SameLine();
 		ShowHelpMarker("Sets the maximum audio latency. Not supported by all audio drivers.");
     }
+	OptionCheckbox("Dynamic Rate Control", config::DynamicRateControl,
+			"Resample the audio to keep the buffer level stable instead of synchronizing the emulation with the audio output. Use with V-Sync");
+	if (config::DynamicRateControl && game_started)
+	{
+		AudioStats stats = GetAudioStats();
+		ImGui::Text("Buffer: %d%%  Drift: %d ppm  Underruns: %u  Overruns: %u",
+				(int)(stats.fillLevel * 100.f), stats.drift, stats.underruns, stats.overruns);
+	}
 
 	AudioBackend *backend = nullptr;
 	std::string backend_name = config::AudioBackend;
@@ -2739,6 +2752,14 @@ static void gui_settings_advanced()
 		OptionSlider("SH4 Clock", config::Sh4Clock, 100, 300,
 				"Over/Underclock the main SH4 CPU. Default is 200 MHz. Other values may crash, freeze or trigger unexpected nuclear reactions.",
 				"%d MHz");
+		OptionSlider("Interpreter CPU Ratio", config::InterpreterCpuRatio, 1, 8,
+				"Number of SH4 cycles counted per interpreted instruction. Higher values are faster but less accurate. Only used by the interpreter");
+		OptionCheckbox("Persistent Block Cache", config::DynarecBlockCache,
+				"Save decoded SH4 blocks to disk to speed up the next game start. Only used by the dynarec");
+		OptionCheckbox("Tiered Compilation", config::DynarecTieredCompilation,
+				"Compile new SH4 blocks quickly without optimizations and optimize the frequently executed ones in the background");
+		OptionCheckbox("Superblocks", config::DynarecSuperblocks,
+				"Merge SH4 blocks across forward jumps so they can be optimized together");
     }
 	ImGui::Spacing();
     header("Other");
@@ -2746,6 +2767,8 @@ static void gui_settings_advanced()
     	OptionCheckbox("HLE BIOS", config::UseReios, "Force high-level BIOS emulation");
         OptionCheckbox("Multi-threaded emulation", config::ThreadedRendering,
         		"Run the emulated CPU and GPU on different threads");
+        OptionCheckbox("Pipelined TA Parsing", config::PipelinedTAParsing,
+        		"Parse the display lists on a separate thread while the game is sending them");
 #ifndef __ANDROID
         OptionCheckbox("Serial Console", config::SerialConsole,
         		"Dump the Dreamcast serial console to stdout");
@@ -2754,6 +2777,10 @@ static void gui_settings_advanced()
 			DisabledScope scope(game_started);
 			OptionCheckbox("Dreamcast 32MB RAM Mod", config::RamMod32MB,
 				"Enables 32MB RAM Mod for Dreamcast. May affect compatibility");
+			OptionCheckbox("Naomi ROM Cache", config::NaomiRomCache,
+				"Save the assembled Naomi/Atomiswave ROM image to disk and map it at the next start instead of decompressing the archive");
+			OptionCheckbox("Naomi GD-ROM DIMM Cache", config::DimmCache,
+				"Save the decrypted Naomi GD-ROM DIMM content to disk so that the next start doesn't decrypt it again");
 		}
         OptionCheckbox("Dump Textures", config::DumpTextures,
         		"Dump all textures into data/texdump/<game id>");
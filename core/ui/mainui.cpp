@@ -40,6 +40,7 @@ bool mainui_rend_frame()
 
 	os_DoEvents();
 	os_UpdateInputState();
+	dc_savestateNotify();
 
 	if (gui_is_open() || gui_state == GuiState::VJoyEdit)
 	{
@@ -151,6 +151,21 @@ void create_mappings(const Mapping *vmem_maps, unsigned nummaps) {
 #endif
 }
 
+// Windows can't map views of a file into a reserved range without placeholders so mirrors aren't supported
+void *reserve_mirror(size_t size) {
+	return nullptr;
+}
+
+void release_mirror(void *base, size_t size) {
+}
+
+bool map_mirror(void *dest, size_t memoffset, size_t size, bool allow_writes) {
+	return false;
+}
+
+void unmap_mirror(void *dest, size_t size) {
+}
+
 template<typename Mapper>
 static void *prepare_jit_block_template(size_t size, Mapper mapper)
 {
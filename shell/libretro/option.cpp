@@ -24,6 +24,11 @@ namespace config {
 // Dynarec
 
 Option<bool> DynarecEnabled("", true);
+Option<bool> DynarecBlockCache("");
+Option<bool> DynarecTieredCompilation("");
+Option<bool> DynarecSuperblocks("");
+Option<bool> DynarecHostMmu("", false);
+Option<int> InterpreterCpuRatio("", 1);
 IntOption Sh4Clock(CORE_OPTION_NAME "_sh4clock", 200);
 
 // General
@@ -40,12 +45,14 @@ Option<bool> ForceFreePlay(CORE_OPTION_NAME "_force_freeplay", true);
 // Sound
 
 Option<bool> DSPEnabled(CORE_OPTION_NAME "_enable_dsp", false);
+Option<bool> ThreadedAudio("");
 #if HOST_CPU == CPU_ARM
 Option<int> AudioBufferSize("", 5644);	// 128 ms
 #else
 Option<int> AudioBufferSize("", 2822);	// 64 ms
 #endif
 Option<bool> AutoLatency("");
+Option<bool> DynamicRateControl("");
 
 OptionString AudioBackend("", "auto");
 Option<bool> VmuSound(CORE_OPTION_NAME "_vmu_sound", false);
@@ -65,6 +72,7 @@ IntOption MaxFilteredTextureSize(CORE_OPTION_NAME "_texupscale_max_filtered_text
 Option<float> ExtraDepthScale("", 1.f);
 Option<bool> CustomTextures(CORE_OPTION_NAME "_custom_textures");
 Option<bool> DumpTextures(CORE_OPTION_NAME "_dump_textures");
+Option<bool> AsyncTextureDecode("");
 Option<int> ScreenStretching("", 100);
 Option<bool> Fog(CORE_OPTION_NAME "_fog", true);
 Option<bool> FloatVMUs("");
@@ -84,10 +92,12 @@ Option<int> AutoSkipFrame(CORE_OPTION_NAME "_auto_skip_frame", 0);
 Option<int> RenderResolution("", 480);
 Option<bool> VSync("", true);
 Option<bool> ThreadedRendering(CORE_OPTION_NAME "_threaded_rendering", true);
+Option<bool> PipelinedTAParsing("");
 Option<int> AnisotropicFiltering(CORE_OPTION_NAME "_anisotropic_filtering");
 Option<int> TextureFiltering(CORE_OPTION_NAME "_texture_filtering");
 Option<bool> PowerVR2Filter(CORE_OPTION_NAME "_pvr2_filtering");
 Option<int64_t> PixelBufferSize("", 512_MB);
+Option<int64_t> TextureCacheSize("", 512_MB);
 IntOption PerPixelLayers(CORE_OPTION_NAME "_oit_layers");
 Option<bool> NativeDepthInterpolation(CORE_OPTION_NAME "_native_depth_interpolation");
 Option<bool> EmulateFramebuffer(CORE_OPTION_NAME "_emulate_framebuffer", false);
@@ -101,6 +111,9 @@ Option<bool> UseReios(CORE_OPTION_NAME "_hle_bios");
 
 Option<bool> OpenGlChecks("", false);
 Option<bool> FastGDRomLoad(CORE_OPTION_NAME "_gdrom_fast_loading", false);
+Option<int, false> ChdCacheSize("", 16);
+Option<bool, false> DimmCache("", false);
+Option<bool, false> NaomiRomCache("", false);
 Option<bool> RamMod32MB(CORE_OPTION_NAME "_dc_32mb_mod", false);
 
 //Option<std::vector<std::string>, false> ContentPath("");
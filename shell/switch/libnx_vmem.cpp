@@ -237,6 +237,25 @@ void create_mappings(const Mapping *vmem_maps, unsigned nummaps)
 	}
 }
 
+// Mirrors aren't supported
+void *reserve_mirror(size_t size)
+{
+	return nullptr;
+}
+
+void release_mirror(void *base, size_t size)
+{
+}
+
+bool map_mirror(void *dest, size_t memoffset, size_t size, bool allow_writes)
+{
+	return false;
+}
+
+void unmap_mirror(void *dest, size_t size)
+{
+}
+
 // Prepares the code region for JIT operations, thus marking it as RWX
 bool prepare_jit_block(void *code_area, size_t size, void **code_area_rwx)
 {
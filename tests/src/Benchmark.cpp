@@ -0,0 +1,244 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/addrspace.h"
+#include "hw/sh4/dyna/blockindex.h"
+#include "hw/sh4/sh4_if.h"
+#include "hw/sh4/sh4_interpreter.h"
+#include "hw/sh4/sh4_sched.h"
+#include "rend/TexCache.h"
+#include "Sh4DynarecDiffTest.h"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <random>
+
+// Timing loops of some core components. They only print their results and are kept out
+// of the unit tests. Run with --gtest_filter='*Benchmark*' --gtest_also_run_disabled_tests
+class Benchmark : public ::testing::Test {
+protected:
+	using Clock = std::chrono::steady_clock;
+
+	void startTimer() {
+		start = Clock::now();
+	}
+
+	// Microseconds since the last call to startTimer()
+	int elapsed() const {
+		return (int)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+	}
+
+	// Average time of 1024x1024 conversions compared with the scalar templates
+	template<typename Pixel>
+	void texConv(const char *name, void (*func)(PixelBuffer<Pixel> *, const u8 *, u32, u32),
+			void (*reference)(PixelBuffer<Pixel> *, const u8 *, u32, u32), const std::vector<u8>& source)
+	{
+		constexpr int Runs = 20;
+		PixelBuffer<Pixel> pb;
+		pb.init(1024, 1024);
+		startTimer();
+		for (int i = 0; i < Runs; i++)
+			reference(&pb, source.data(), 1024, 1024);
+		int scalarTime = elapsed();
+		startTimer();
+		for (int i = 0; i < Runs; i++)
+			func(&pb, source.data(), 1024, 1024);
+		int simdTime = elapsed();
+		printf("%-12s scalar %6d us, vector %6d us\n", name, scalarTime / Runs, simdTime / Runs);
+	}
+
+	Clock::time_point start;
+};
+
+// Compare lookup and invalidation throughput with the std::map based index.
+TEST_F(Benchmark, DISABLED_BlockIndex)
+{
+	struct Block
+	{
+		u8 *code;
+	};
+	using BlockPtr = std::shared_ptr<Block>;
+	constexpr u32 BlockCount = 8192;
+	constexpr u32 BlockSize = 128;
+	constexpr u32 Lookups = 1000000;
+	std::vector<u8> buffer(BlockCount * BlockSize);
+	std::vector<BlockPtr> blocks;
+	for (u32 i = 0; i < BlockCount; i++)
+		blocks.push_back(std::make_shared<Block>(Block{ &buffer[i * BlockSize] }));
+	std::mt19937 rng(42);
+	std::vector<u32> offsets(Lookups);
+	for (u32& offset : offsets)
+		offset = rng() % (BlockCount * BlockSize);
+
+	CodeIndex<BlockPtr> index;
+	std::map<void *, BlockPtr> map;
+	for (const BlockPtr& block : blocks)
+	{
+		index.add(block->code, block);
+		map[block->code] = block;
+	}
+
+	u32 found = 0;
+	startTimer();
+	for (u32 offset : offsets)
+		found += index.find(&buffer[offset]) != nullptr;
+	int indexTime = elapsed();
+	ASSERT_EQ(Lookups, found);
+
+	found = 0;
+	startTimer();
+	for (u32 offset : offsets)
+	{
+		auto it = map.upper_bound(&buffer[offset]);
+		found += it != map.begin() && (--it)->second != nullptr;
+	}
+	int mapTime = elapsed();
+	ASSERT_EQ(Lookups, found);
+	printf("Lookup: CodeIndex %d us, std::map %d us\n", indexTime, mapTime);
+
+	// Invalidate and re-add half of the blocks, like temp block churn does
+	startTimer();
+	for (int pass = 0; pass < 10; pass++)
+	{
+		for (u32 i = BlockCount / 2; i < BlockCount; i++)
+			index.remove(blocks[i]->code);
+		for (u32 i = BlockCount / 2; i < BlockCount; i++)
+			index.add(blocks[i]->code, blocks[i]);
+	}
+	indexTime = elapsed();
+	startTimer();
+	for (int pass = 0; pass < 10; pass++)
+	{
+		for (u32 i = BlockCount / 2; i < BlockCount; i++)
+			map.erase(blocks[i]->code);
+		for (u32 i = BlockCount / 2; i < BlockCount; i++)
+			map[blocks[i]->code] = blocks[i];
+	}
+	mapTime = elapsed();
+	printf("Invalidate: CodeIndex %d us, std::map %d us\n", indexTime, mapTime);
+	ASSERT_EQ(map.size(), index.size());
+}
+
+// Replay a request/fire trace similar to what the Dreamcast hardware generates:
+// a few periodic timers (SPG, AICA, TMU) and many short one-shot requests (DMA, GD-ROM, maple)
+// that are frequently rescheduled or cancelled.
+TEST_F(Benchmark, DISABLED_Scheduler)
+{
+	if (!addrspace::reserve())
+		die("addrspace::reserve failed");
+	emu.init();
+	dc_reset(true);
+	// cancel all hardware events
+	sh4_sched_reset(true);
+
+	static const int periods[] = { 448 * 10, 13000, 3300000, 200000, 1000000 };
+	std::vector<int> ids;
+	u32 fired = 0;
+	auto callback = [](int tag, int sch_cycl, int jitter, void *arg) {
+		(*(u32 *)arg)++;
+		return tag;
+	};
+	for (int period : periods)
+	{
+		ids.push_back(sh4_sched_register(period, callback, &fired));
+		sh4_sched_request(ids.back(), period);
+	}
+	std::vector<int> oneShots;
+	for (int i = 0; i < 12; i++)
+	{
+		oneShots.push_back(sh4_sched_register(0, callback, &fired));
+		ids.push_back(oneShots.back());
+	}
+
+	std::mt19937 rng(1234);
+	std::vector<std::pair<int, int>> trace;
+	for (int i = 0; i < 2000000; i++)
+	{
+		int id = oneShots[rng() % oneShots.size()];
+		int cycles = rng() % 8 == 0 ? -1 : (int)(rng() % 20000);
+		trace.emplace_back(id, cycles);
+	}
+
+	startTimer();
+	for (const auto& [id, cycles] : trace)
+	{
+		sh4_sched_request(id, cycles);
+		// same as the interpreter main loop
+		Sh4cntx.sh4_sched_next -= SH4_TIMESLICE;
+		if (Sh4cntx.sh4_sched_next < 0)
+			sh4_sched_tick(SH4_TIMESLICE);
+	}
+	int time = elapsed();
+	printf("Scheduler trace replay: %d requests in %d ms\n", (int)trace.size(), time / 1000);
+	for (int id : ids)
+		sh4_sched_unregister(id);
+	ASSERT_GT(fired, 0u);
+}
+
+TEST_F(Benchmark, DISABLED_TextureConversion)
+{
+	std::mt19937 rng(1234);
+	std::vector<u8> source(1024 * 1024 * 2);
+	for (u8& b : source)
+		b = (u8)rng();
+	std::vector<u8> codebook(VQ_CODEBOOK_SIZE);
+	for (u8& b : codebook)
+		b = (u8)rng();
+	const u8 *savedCodebook = vq_codebook;
+	vq_codebook = codebook.data();
+
+	texConv<u16>("1555 TW", opengl::tex1555_TW, texture_TW_scalar<ConvertTwiddle<Unpacker1555>>, source);
+	texConv<u16>("1555 VQ", opengl::tex1555_VQ, texture_VQ_scalar<ConvertTwiddle<Unpacker1555>>, source);
+	texConv<u32>("565 TW32", opengl::tex565_TW32, texture_TW_scalar<ConvertTwiddle<Unpacker565_32<RGBAPacker>>>, source);
+	texConv<u32>("4444 VQ32", opengl::tex4444_VQ32, texture_VQ_scalar<ConvertTwiddle<Unpacker4444_32<RGBAPacker>>>, source);
+	texConv<u32>("YUV TW", opengl::texYUV422_TW, texture_TW_scalar<ConvertTwiddleYUV<RGBAPacker>>, source);
+	texConv<u32>("YUV PL", opengl::texYUV422_PL, texture_PL_scalar<ConvertPlanarYUV<RGBAPacker>>, source);
+	texConv<u32>("1555 PL32", opengl::tex1555_PL32, texture_PL_scalar<ConvertPlanar<Unpacker1555_32<RGBAPacker>>>, source);
+
+	vq_codebook = savedCodebook;
+}
+
+#if FEAT_SHREC != DYNAREC_NONE
+class Sh4Benchmark : public Sh4DynarecDiffTest
+{
+protected:
+	// Returns the average time in ns per guest instruction
+	double run(sh4_if& cpu, const OpClass& opClass, u32 seed)
+	{
+		constexpr int BlockSize = 32;
+		std::mt19937 rng(seed);
+		std::vector<u16> ops(BlockSize);
+		for (u16& op : ops)
+			op = randomOp(rng, opClass);
+		ops.push_back(0x7001 | (CounterReg << 8));		// add #1,r13
+		writeBlock(ops, START_PC);
+
+		CpuState initial;
+		randomState(rng, initial);
+		setState(initial);
+
+		sh4_sched_request(stopEvent, SH4_MAIN_CLOCK / 10);
+		auto start = std::chrono::steady_clock::now();
+		cpu.Run();
+		auto end = std::chrono::steady_clock::now();
+
+		// block + bra + nop
+		const u64 instructions = (u64)ctx->r[CounterReg] * (ops.size() + 2);
+		if (instructions == 0)
+			return 0;
+		return std::chrono::duration<double, std::nano>(end - start).count() / instructions;
+	}
+};
+
+// Interpreter and recompiler speed on random blocks of each instruction class
+TEST_F(Sh4Benchmark, DISABLED_Recompiler)
+{
+	printf("%-8s %12s %12s\n", "class", "interp ns/op", "dynarec ns/op");
+	for (const OpClass& opClass : opClasses())
+	{
+		const double interp = run(interpreter, opClass, 42);
+		const double dynarec = run(recompiler, opClass, 42);
+		printf("%-8s %12.2f %12.2f\n", opClass.name, interp, dynarec);
+	}
+}
+#endif // FEAT_SHREC != DYNAREC_NONE
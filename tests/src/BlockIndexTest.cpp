@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/sh4/dyna/blockindex.h"
+#include <memory>
+
+struct TestBlock
+{
+	u8 *code;
+	u32 size;
+};
+using TestBlockPtr = std::shared_ptr<TestBlock>;
+
+class BlockIndexTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		buffer.resize(1_MB);
+	}
+
+	TestBlockPtr makeBlock(u32 offset, u32 size) {
+		return std::make_shared<TestBlock>(TestBlock{ &buffer[offset], size });
+	}
+
+	std::vector<u8> buffer;
+};
+
+TEST_F(BlockIndexTest, AddFind)
+{
+	CodeIndex<TestBlockPtr> index;
+	ASSERT_TRUE(index.empty());
+	ASSERT_EQ(nullptr, index.find(&buffer[0]));
+
+	TestBlockPtr b1 = makeBlock(100, 50);
+	TestBlockPtr b2 = makeBlock(200, 50);
+	TestBlockPtr b0 = makeBlock(0, 50);
+	ASSERT_TRUE(index.add(b1->code, b1));
+	ASSERT_TRUE(index.add(b2->code, b2));
+	// out of order
+	ASSERT_TRUE(index.add(b0->code, b0));
+	ASSERT_FALSE(index.add(b1->code, b1));
+	ASSERT_EQ(3u, index.size());
+
+	ASSERT_EQ(b0, index.find(&buffer[0]));
+	ASSERT_EQ(b0, index.find(&buffer[99]));
+	ASSERT_EQ(b1, index.find(&buffer[100]));
+	ASSERT_EQ(b1, index.find(&buffer[199]));
+	ASSERT_EQ(b2, index.find(&buffer[200]));
+	ASSERT_EQ(b2, index.find(&buffer[1000]));
+}
+
+TEST_F(BlockIndexTest, Remove)
+{
+	CodeIndex<TestBlockPtr> index;
+	TestBlockPtr b0 = makeBlock(0, 50);
+	TestBlockPtr b1 = makeBlock(100, 50);
+	TestBlockPtr b2 = makeBlock(200, 50);
+	index.add(b0->code, b0);
+	index.add(b1->code, b1);
+	index.add(b2->code, b2);
+
+	ASSERT_TRUE(index.remove(b1->code));
+	ASSERT_FALSE(index.remove(b1->code));
+	ASSERT_FALSE(index.remove(&buffer[101]));
+	ASSERT_EQ(2u, index.size());
+	// removed entries are skipped
+	ASSERT_EQ(b0, index.find(&buffer[120]));
+	ASSERT_EQ(b2, index.find(&buffer[200]));
+
+	// reuse of a removed entry
+	TestBlockPtr b3 = makeBlock(100, 150);
+	ASSERT_TRUE(index.add(b3->code, b3));
+	ASSERT_EQ(b3, index.find(&buffer[120]));
+	ASSERT_TRUE(index.remove(b2->code));
+	ASSERT_EQ(b3, index.find(&buffer[220]));
+
+	int count = 0;
+	index.forEach([&count](const TestBlockPtr&) { count++; });
+	ASSERT_EQ(2, count);
+
+	index.clear();
+	ASSERT_TRUE(index.empty());
+	ASSERT_EQ(nullptr, index.find(&buffer[120]));
+}
+
+TEST_F(BlockIndexTest, Compact)
+{
+	CodeIndex<TestBlockPtr> index;
+	std::vector<TestBlockPtr> blocks;
+	for (u32 i = 0; i < 1000; i++)
+	{
+		blocks.push_back(makeBlock(i * 64, 64));
+		index.add(blocks.back()->code, blocks.back());
+	}
+	for (u32 i = 0; i < 1000; i += 2)
+		ASSERT_TRUE(index.remove(blocks[i]->code));
+	ASSERT_EQ(500u, index.size());
+	for (u32 i = 1; i < 1000; i += 2)
+	{
+		ASSERT_EQ(blocks[i], index.find(blocks[i]->code));
+		ASSERT_EQ(blocks[i], index.find(blocks[i]->code + 63));
+		// the code of a removed block resolves to the previous live block
+		if (i >= 3)
+			ASSERT_EQ(blocks[i - 2], index.find(blocks[i - 1]->code));
+	}
+	ASSERT_EQ(nullptr, index.find(blocks[0]->code));
+}
+
+TEST_F(BlockIndexTest, RemoveRange)
+{
+	CodeIndex<TestBlockPtr> index;
+	std::vector<TestBlockPtr> blocks;
+	for (u32 i = 0; i < 1000; i++)
+	{
+		blocks.push_back(makeBlock(i * 64, 64));
+		index.add(blocks.back()->code, blocks.back());
+	}
+	// a contiguous range of removed entries is compacted before it gets large
+	for (u32 i = 100; i < 900; i++)
+	{
+		ASSERT_TRUE(index.remove(blocks[i]->code));
+		ASSERT_EQ(blocks[99], index.find(blocks[i]->code));
+	}
+	ASSERT_EQ(200u, index.size());
+	ASSERT_EQ(blocks[99], index.find(blocks[899]->code + 63));
+	ASSERT_EQ(blocks[900], index.find(blocks[900]->code));
+
+	// re-add them
+	for (u32 i = 100; i < 900; i++)
+		ASSERT_TRUE(index.add(blocks[i]->code, blocks[i]));
+	ASSERT_EQ(1000u, index.size());
+	for (u32 i = 0; i < 1000; i++)
+		ASSERT_EQ(blocks[i], index.find(blocks[i]->code + 10));
+}
@@ -0,0 +1,51 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "Sh4DynarecDiffTest.h"
+
+#if FEAT_SHREC != DYNAREC_NONE
+
+TEST_F(Sh4DynarecDiffTest, Alu)
+{
+	diffTest(opClasses()[0], 500, 1);
+}
+TEST_F(Sh4DynarecDiffTest, Shift)
+{
+	diffTest(opClasses()[1], 500, 2);
+}
+TEST_F(Sh4DynarecDiffTest, MulDiv)
+{
+	diffTest(opClasses()[2], 500, 3);
+}
+TEST_F(Sh4DynarecDiffTest, Memory)
+{
+	diffTest(opClasses()[3], 500, 4);
+}
+TEST_F(Sh4DynarecDiffTest, FloatingPoint)
+{
+	diffTest(opClasses()[4], 500, 5);
+}
+TEST_F(Sh4DynarecDiffTest, Mixed)
+{
+	OpClass mixed { "mixed", {} };
+	for (const OpClass& opClass : opClasses())
+		mixed.ops.insert(mixed.ops.end(), opClass.ops.begin(), opClass.ops.end());
+	diffTest(mixed, 1000, 6);
+}
+
+#endif // FEAT_SHREC != DYNAREC_NONE
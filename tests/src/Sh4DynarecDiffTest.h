@@ -0,0 +1,461 @@
+/*
+	Copyright 2024 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/sh4/sh4_if.h"
+#include "hw/sh4/sh4_core.h"
+#undef r
+#undef fr
+#undef sr
+#undef mac
+#undef gbr
+#undef fpscr
+#undef old_fpscr
+#undef fpul
+#include "hw/sh4/interpr/sh4_opcache.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_sched.h"
+#include "hw/sh4/sh4_opcode_list.h"
+#include "hw/mem/addrspace.h"
+#include "oslib/oslib.h"
+
+#if FEAT_SHREC != DYNAREC_NONE
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+//
+// Differential testing of the recompiler against the interpreter.
+// Random basic blocks are generated and executed by both, and the resulting cpu and memory states are compared.
+//
+// Register usage of the generated blocks:
+// r0-r12: random operands
+// r13: loop counter (benchmark only)
+// r14, gbr: base address of the scratch memory used by loads and stores
+//
+class Sh4DynarecDiffTest : public ::testing::Test
+{
+protected:
+	static constexpr u32 START_PC = 0xAC000000;
+	static constexpr u32 SCRATCH_ADDR = 0x8C100000;
+	static constexpr u32 SCRATCH_SIZE = 1024;
+	static constexpr int RandomRegs = 13;
+	static constexpr int CounterReg = 13;
+	static constexpr int BaseReg = 14;
+
+	enum Operands {
+		None,
+		Rn,			// ---- nnnn ---- ----
+		RnRm,		// ---- nnnn mmmm ----
+		Imm8,		// ---- ---- iiii iiii
+		RnImm8,		// ---- nnnn iiii iiii
+		FRn,		// ---- nnnn ---- ----	float register
+		FRnFRm,		// ---- nnnn mmmm ----	float registers
+		FRm,		// ---- mmmm ---- ----	float register
+		StoreDisp,	// ---- BASE mmmm dddd	mov.l Rm,@(disp,Rn)
+		LoadDisp,	// ---- nnnn BASE dddd	mov.l @(disp,Rm),Rn
+		R0Disp,		// ---- ---- BASE dddd	mov.b/w R0,@(disp,Rn) or @(disp,Rm),R0
+		GbrDisp,	// ---- ---- dddd dddd
+	};
+	struct OpTemplate
+	{
+		u16 pattern;
+		Operands operands;
+	};
+	struct OpClass
+	{
+		const char *name;
+		std::vector<OpTemplate> ops;
+	};
+
+	static const std::vector<OpClass>& opClasses()
+	{
+		// fdiv, fsqrt and ftrc are left out: their results for NaN, infinite and out of range
+		// operands differ between the host and the interpreter implementations.
+		static const std::vector<OpClass> classes {
+			{ "alu", {
+				{ 0x6003, RnRm },	// mov Rm,Rn
+				{ 0xe000, RnImm8 },	// mov #imm,Rn
+				{ 0x300c, RnRm },	// add Rm,Rn
+				{ 0x7000, RnImm8 },	// add #imm,Rn
+				{ 0x300e, RnRm },	// addc Rm,Rn
+				{ 0x300f, RnRm },	// addv Rm,Rn
+				{ 0x3008, RnRm },	// sub Rm,Rn
+				{ 0x300a, RnRm },	// subc Rm,Rn
+				{ 0x300b, RnRm },	// subv Rm,Rn
+				{ 0x2009, RnRm },	// and Rm,Rn
+				{ 0x200b, RnRm },	// or Rm,Rn
+				{ 0x200a, RnRm },	// xor Rm,Rn
+				{ 0x6007, RnRm },	// not Rm,Rn
+				{ 0x600b, RnRm },	// neg Rm,Rn
+				{ 0x600a, RnRm },	// negc Rm,Rn
+				{ 0xc900, Imm8 },	// and #imm,R0
+				{ 0xcb00, Imm8 },	// or #imm,R0
+				{ 0xca00, Imm8 },	// xor #imm,R0
+				{ 0x2008, RnRm },	// tst Rm,Rn
+				{ 0xc800, Imm8 },	// tst #imm,R0
+				{ 0x600c, RnRm },	// extu.b Rm,Rn
+				{ 0x600d, RnRm },	// extu.w Rm,Rn
+				{ 0x600e, RnRm },	// exts.b Rm,Rn
+				{ 0x600f, RnRm },	// exts.w Rm,Rn
+				{ 0x6008, RnRm },	// swap.b Rm,Rn
+				{ 0x6009, RnRm },	// swap.w Rm,Rn
+				{ 0x200d, RnRm },	// xtrct Rm,Rn
+				{ 0x3000, RnRm },	// cmp/eq Rm,Rn
+				{ 0x3002, RnRm },	// cmp/hs Rm,Rn
+				{ 0x3003, RnRm },	// cmp/ge Rm,Rn
+				{ 0x3006, RnRm },	// cmp/hi Rm,Rn
+				{ 0x3007, RnRm },	// cmp/gt Rm,Rn
+				{ 0x200c, RnRm },	// cmp/str Rm,Rn
+				{ 0x4011, Rn },		// cmp/pz Rn
+				{ 0x4015, Rn },		// cmp/pl Rn
+				{ 0x8800, Imm8 },	// cmp/eq #imm,R0
+				{ 0x4010, Rn },		// dt Rn
+				{ 0x0029, Rn },		// movt Rn
+				{ 0x0008, None },	// clrt
+				{ 0x0018, None },	// sett
+			} },
+			{ "shift", {
+				{ 0x4000, Rn },		// shll Rn
+				{ 0x4001, Rn },		// shlr Rn
+				{ 0x4020, Rn },		// shal Rn
+				{ 0x4021, Rn },		// shar Rn
+				{ 0x4004, Rn },		// rotl Rn
+				{ 0x4005, Rn },		// rotr Rn
+				{ 0x4024, Rn },		// rotcl Rn
+				{ 0x4025, Rn },		// rotcr Rn
+				{ 0x4008, Rn },		// shll2 Rn
+				{ 0x4009, Rn },		// shlr2 Rn
+				{ 0x4018, Rn },		// shll8 Rn
+				{ 0x4019, Rn },		// shlr8 Rn
+				{ 0x4028, Rn },		// shll16 Rn
+				{ 0x4029, Rn },		// shlr16 Rn
+				{ 0x400c, RnRm },	// shad Rm,Rn
+				{ 0x400d, RnRm },	// shld Rm,Rn
+			} },
+			{ "muldiv", {
+				{ 0x0007, RnRm },	// mul.l Rm,Rn
+				{ 0x200e, RnRm },	// mulu.w Rm,Rn
+				{ 0x200f, RnRm },	// muls.w Rm,Rn
+				{ 0x3005, RnRm },	// dmulu.l Rm,Rn
+				{ 0x300d, RnRm },	// dmuls.l Rm,Rn
+				{ 0x001a, Rn },		// sts MACL,Rn
+				{ 0x000a, Rn },		// sts MACH,Rn
+				{ 0x0028, None },	// clrmac
+				{ 0x0019, None },	// div0u
+				{ 0x2007, RnRm },	// div0s Rm,Rn
+				{ 0x3004, RnRm },	// div1 Rm,Rn
+			} },
+			{ "mem", {
+				{ 0x1000, StoreDisp },	// mov.l Rm,@(disp,Rn)
+				{ 0x5000, LoadDisp },	// mov.l @(disp,Rm),Rn
+				{ 0x8000, R0Disp },		// mov.b R0,@(disp,Rn)
+				{ 0x8100, R0Disp },		// mov.w R0,@(disp,Rn)
+				{ 0x8400, R0Disp },		// mov.b @(disp,Rm),R0
+				{ 0x8500, R0Disp },		// mov.w @(disp,Rm),R0
+				{ 0xc200, GbrDisp },	// mov.l R0,@(disp,GBR)
+				{ 0xc600, GbrDisp },	// mov.l @(disp,GBR),R0
+				{ 0xc000, GbrDisp },	// mov.b R0,@(disp,GBR)
+				{ 0xc500, GbrDisp },	// mov.w @(disp,GBR),R0
+			} },
+			{ "fpu", {
+				{ 0xf00c, FRnFRm },	// fmov FRm,FRn
+				{ 0xf000, FRnFRm },	// fadd FRm,FRn
+				{ 0xf001, FRnFRm },	// fsub FRm,FRn
+				{ 0xf002, FRnFRm },	// fmul FRm,FRn
+				{ 0xf004, FRnFRm },	// fcmp/eq FRm,FRn
+				{ 0xf005, FRnFRm },	// fcmp/gt FRm,FRn
+				{ 0xf04d, FRn },	// fneg FRn
+				{ 0xf05d, FRn },	// fabs FRn
+				{ 0xf08d, FRn },	// fldi0 FRn
+				{ 0xf09d, FRn },	// fldi1 FRn
+				{ 0xf01d, FRm },	// flds FRm,FPUL
+				{ 0xf00d, FRn },	// fsts FPUL,FRn
+				{ 0xf02d, FRn },	// float FPUL,FRn
+				{ 0x405a, Rn },		// lds Rm,FPUL
+				{ 0x005a, Rn },		// sts FPUL,Rn
+			} },
+		};
+		return classes;
+	}
+
+	struct CpuState
+	{
+		u32 r[16];
+		u32 fr[32];
+		u64 mac;
+		u32 gbr;
+		u32 fpul;
+		u32 sr;
+		u32 fpscr;
+		u8 scratch[SCRATCH_SIZE];
+	};
+
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		mem_map_default();
+		dc_reset(true);
+		// cancel all hardware events
+		sh4_sched_reset(true);
+		sh4_sched_ffts();
+		// fast memory accesses and protected code pages of the recompiler
+		os_InstallFaultHandler();
+		ctx = &p_sh4rcb->cntx;
+		Get_Sh4Interpreter(&interpreter);
+		Get_Sh4Recompiler(&recompiler);
+		stopEvent = sh4_sched_register(0, stopCallback, &recompiler);
+	}
+
+	void TearDown() override {
+		sh4_sched_unregister(stopEvent);
+		os_UninstallFaultHandler();
+	}
+
+	static int stopCallback(int tag, int sch_cycl, int jitter, void *arg)
+	{
+		((sh4_if *)arg)->Stop();
+		return 0;
+	}
+
+	u16 randomOp(std::mt19937& rng, const OpClass& opClass)
+	{
+		const OpTemplate& op = opClass.ops[rng() % opClass.ops.size()];
+		const u16 n = rng() % RandomRegs;
+		const u16 m = rng() % RandomRegs;
+		const u16 fn = rng() % 16;
+		const u16 fm = rng() % 16;
+		switch (op.operands)
+		{
+		case None:
+			return op.pattern;
+		case Rn:
+			return op.pattern | (n << 8);
+		case RnRm:
+			return op.pattern | (n << 8) | (m << 4);
+		case Imm8:
+		case GbrDisp:
+			return op.pattern | (rng() & 0xff);
+		case RnImm8:
+			return op.pattern | (n << 8) | (rng() & 0xff);
+		case FRn:
+			return op.pattern | (fn << 8);
+		case FRnFRm:
+			return op.pattern | (fn << 8) | (fm << 4);
+		case FRm:
+			return op.pattern | (fm << 8);
+		case StoreDisp:
+			return op.pattern | (BaseReg << 8) | (m << 4) | (rng() & 0xf);
+		case LoadDisp:
+			return op.pattern | (n << 8) | (BaseReg << 4) | (rng() & 0xf);
+		case R0Disp:
+			return op.pattern | (BaseReg << 4) | (rng() & 0xf);
+		default:
+			die("Unknown operands");
+			return 0;
+		}
+	}
+
+	// Write the block at START_PC followed by a branch to endAddr
+	void writeBlock(const std::vector<u16>& ops, u32 endAddr)
+	{
+		u32 pc = START_PC;
+		for (u16 op : ops)
+		{
+			addrspace::write16(pc, op);
+			pc += 2;
+		}
+		const s32 disp = ((s32)endAddr - (s32)(pc + 4)) / 2;
+		addrspace::write16(pc, 0xa000 | (disp & 0xfff));	// bra endAddr
+		addrspace::write16(pc + 2, 0x0009);					// nop
+	}
+
+	void randomState(std::mt19937& rng, CpuState& state)
+	{
+		for (u32& r : state.r)
+		{
+			// favor small values and edge cases
+			switch (rng() % 4)
+			{
+			case 0:
+				r = rng() % 64;
+				break;
+			case 1:
+				r = (u32)-(s32)(rng() % 64);
+				break;
+			case 2:
+				r = 0x7fffffff + rng() % 3;
+				break;
+			default:
+				r = rng();
+				break;
+			}
+		}
+		state.r[CounterReg] = 0;
+		state.r[BaseReg] = SCRATCH_ADDR;
+		// Only use exactly representable values to avoid denormals
+		for (u32& fr : state.fr)
+		{
+			float f = (float)((s32)(rng() % 16001) - 8000) / 8.f;
+			memcpy(&fr, &f, sizeof(fr));
+		}
+		state.mac = ((u64)rng() << 32) | rng();
+		state.gbr = SCRATCH_ADDR;
+		state.fpul = rng();
+		// Privileged mode, register bank 1, exceptions and interrupts blocked
+		state.sr = 0x700000F0 | (rng() & 0x301);	// M, Q and T
+		state.fpscr = 0x00040001;					// DN, round to zero
+		for (u8& b : state.scratch)
+			b = rng();
+	}
+
+	void setState(const CpuState& state)
+	{
+		memcpy(ctx->r, state.r, sizeof(ctx->r));
+		memcpy(ctx->xffr, state.fr, sizeof(ctx->xffr));
+		ctx->mac.full = state.mac;
+		ctx->gbr = state.gbr;
+		ctx->fpul = state.fpul;
+		sh4_sr_SetFull(state.sr);
+		ctx->fpscr.full = state.fpscr;
+		ctx->old_fpscr = ctx->fpscr;
+		RestoreHostRoundingMode();
+		ctx->pc = START_PC;
+		ctx->interrupt_pend = 0;
+		for (u32 i = 0; i < SCRATCH_SIZE; i += 4)
+			addrspace::write32(SCRATCH_ADDR + i, *(const u32 *)&state.scratch[i]);
+		// Running the interpreter enables its cache, which the recompiler fallbacks must not use
+		opcache::enable(false);
+		interpreter.ResetCache();
+		recompiler.ResetCache();
+	}
+
+	void getState(CpuState& state)
+	{
+		memcpy(state.r, ctx->r, sizeof(state.r));
+		memcpy(state.fr, ctx->xffr, sizeof(state.fr));
+		state.mac = ctx->mac.full;
+		state.gbr = ctx->gbr;
+		state.fpul = ctx->fpul;
+		state.sr = sh4_sr_GetFull();
+		state.fpscr = ctx->fpscr.full;
+		for (u32 i = 0; i < SCRATCH_SIZE; i += 4)
+			*(u32 *)&state.scratch[i] = addrspace::read32(SCRATCH_ADDR + i);
+	}
+
+	static std::string disassemble(const std::vector<u16>& ops)
+	{
+		std::string s;
+		u32 pc = START_PC;
+		for (u16 op : ops)
+		{
+			char text[64];
+			OpDesc[op]->Disassemble(text, pc, op);
+			s += text;
+			s += '\n';
+			pc += 2;
+		}
+		return s;
+	}
+
+	static bool sameFloat(u32 a, u32 b)
+	{
+		float fa, fb;
+		memcpy(&fa, &a, sizeof(fa));
+		memcpy(&fb, &b, sizeof(fb));
+		// NaN payloads aren't significant
+		return a == b || (std::isnan(fa) && std::isnan(fb));
+	}
+
+	void compareStates(const CpuState& expected, const CpuState& actual, const std::vector<u16>& ops)
+	{
+		SCOPED_TRACE(disassemble(ops));
+		for (int i = 0; i < 16; i++)
+			ASSERT_EQ(expected.r[i], actual.r[i]) << "r" << i;
+		for (int i = 0; i < 32; i++)
+			ASSERT_TRUE(sameFloat(expected.fr[i], actual.fr[i])) << "xffr" << i
+				<< " expected " << std::hex << expected.fr[i] << " actual " << actual.fr[i];
+		ASSERT_EQ(expected.mac, actual.mac);
+		ASSERT_EQ(expected.gbr, actual.gbr);
+		ASSERT_EQ(expected.fpul, actual.fpul);
+		ASSERT_EQ(expected.sr, actual.sr);
+		ASSERT_EQ(expected.fpscr, actual.fpscr);
+		for (u32 i = 0; i < SCRATCH_SIZE; i++)
+			ASSERT_EQ(expected.scratch[i], actual.scratch[i]) << "scratch offset " << i;
+	}
+
+	// Run the block and its terminating branch with the interpreter, one instruction at a time
+	void runInterpreter(size_t opCount)
+	{
+		for (size_t i = 0; i < opCount; i++)
+			interpreter.Step();
+	}
+
+	// Run the recompiler until the stop event is triggered
+	void runRecompiler(int cycles)
+	{
+		sh4_sched_request(stopEvent, cycles);
+		recompiler.Run();
+	}
+
+	void diffTest(const OpClass& opClass, int iterations, u32 seed)
+	{
+		std::mt19937 rng(seed);
+		for (int i = 0; i < iterations; i++)
+		{
+			std::vector<u16> ops(1 + rng() % 32);
+			for (u16& op : ops)
+				op = randomOp(rng, opClass);
+			// The block ends with a branch to an infinite loop
+			const u32 loopAddr = START_PC + ops.size() * 2 + 4;
+			writeBlock(ops, loopAddr);
+			addrspace::write16(loopAddr, 0xaffe);		// bra loopAddr
+			addrspace::write16(loopAddr + 2, 0x0009);	// nop
+
+			CpuState initial;
+			randomState(rng, initial);
+
+			setState(initial);
+			runInterpreter(ops.size() + 1);
+			ASSERT_EQ(loopAddr, ctx->pc);
+			CpuState expected;
+			getState(expected);
+
+			setState(initial);
+			runRecompiler(1000);
+			ASSERT_EQ(loopAddr, ctx->pc);
+			CpuState actual;
+			getState(actual);
+
+			compareStates(expected, actual, ops);
+		}
+	}
+
+	Sh4Context *ctx;
+	sh4_if interpreter;
+	sh4_if recompiler;
+	int stopEvent = -1;
+};
+
+#endif // FEAT_SHREC != DYNAREC_NONE
@@ -0,0 +1,389 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/addrspace.h"
+#include "hw/sh4/sh4_if.h"
+#include "hw/sh4/sh4_sched.h"
+#include "hw/sh4/sh4_interpreter.h"
+#include <algorithm>
+#include <functional>
+#include <random>
+
+class Sh4SchedTest : public ::testing::Test {
+protected:
+	struct Event
+	{
+		int id = -1;
+		int period = 0;		// reschedule period, 0 for one-shot
+		std::vector<u64> fired;
+	};
+
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		dc_reset(true);
+		// cancel all hardware events
+		sh4_sched_reset(true);
+		sh4_sched_ffts();
+	}
+
+	void TearDown() override
+	{
+		for (Event& event : events)
+			sh4_sched_unregister(event.id);
+		events.clear();
+	}
+
+	static int callback(int tag, int sch_cycl, int jitter, void *arg)
+	{
+		Event& event = *(Event *)arg;
+		event.fired.push_back(sh4_sched_now64());
+		return event.period;
+	}
+
+	Event& addEvent(int period = 0)
+	{
+		events.emplace_back();
+		Event& event = events.back();
+		event.period = period;
+		event.id = sh4_sched_register(0, callback, &event);
+		return event;
+	}
+
+	// Same as the interpreter main loop
+	void run(u64 cycles)
+	{
+		for (u64 i = 0; i < cycles; i += SH4_TIMESLICE)
+		{
+			Sh4cntx.sh4_sched_next -= SH4_TIMESLICE;
+			if (Sh4cntx.sh4_sched_next < 0)
+				sh4_sched_tick(SH4_TIMESLICE);
+		}
+	}
+
+	std::deque<Event> events;
+};
+
+TEST_F(Sh4SchedTest, Order)
+{
+	Event& e1 = addEvent();
+	Event& e2 = addEvent();
+	Event& e3 = addEvent();
+	u64 start = sh4_sched_now64();
+	sh4_sched_request(e1.id, 30000);
+	sh4_sched_request(e2.id, 10000);
+	sh4_sched_request(e3.id, 20000);
+	ASSERT_TRUE(sh4_sched_is_scheduled(e1.id));
+	run(50000);
+
+	ASSERT_EQ(1u, e1.fired.size());
+	ASSERT_EQ(1u, e2.fired.size());
+	ASSERT_EQ(1u, e3.fired.size());
+	ASSERT_LT(e2.fired[0], e3.fired[0]);
+	ASSERT_LT(e3.fired[0], e1.fired[0]);
+	ASSERT_GE(e1.fired[0], start + 30000);
+	ASSERT_LT(e1.fired[0], start + 30000 + SH4_TIMESLICE);
+	ASSERT_FALSE(sh4_sched_is_scheduled(e1.id));
+}
+
+TEST_F(Sh4SchedTest, CancelReschedule)
+{
+	Event& e1 = addEvent();
+	Event& e2 = addEvent();
+	u64 start = sh4_sched_now64();
+	sh4_sched_request(e1.id, 10000);
+	sh4_sched_request(e2.id, 10000);
+	sh4_sched_request(e1.id, -1);
+	ASSERT_FALSE(sh4_sched_is_scheduled(e1.id));
+	sh4_sched_request(e2.id, 20000);
+	run(40000);
+
+	ASSERT_EQ(0u, e1.fired.size());
+	ASSERT_EQ(1u, e2.fired.size());
+	ASSERT_GE(e2.fired[0], start + 20000);
+}
+
+TEST_F(Sh4SchedTest, Periodic)
+{
+	Event& e1 = addEvent(1000);
+	Event& e2 = addEvent(3000);
+	sh4_sched_request(e1.id, 1000);
+	sh4_sched_request(e2.id, 3000);
+	run(300000);
+
+	// jitter is compensated so there's no drift
+	ASSERT_NEAR(300, (int)e1.fired.size(), 1);
+	ASSERT_NEAR(100, (int)e2.fired.size(), 1);
+}
+
+// The linear scan scheduler replaced by the heap, used as a reference.
+// Its state is separate from the emulator's (Sh4cntx.sh4_sched_next is 'next' here).
+class LinearScheduler
+{
+public:
+	using Callback = std::function<int(int index, int remain, int jitter)>;
+
+	LinearScheduler(size_t count, Callback callback) : events(count), callback(callback) {
+		ffts();
+	}
+
+	void request(int index, int cycles)
+	{
+		Event& event = events[index];
+		event.start = now();
+		if (cycles == -1)
+		{
+			event.end = -1;
+		}
+		else
+		{
+			event.end = event.start + cycles;
+			if (event.end == -1)
+				event.end++;
+		}
+		ffts();
+	}
+
+	void tick(int cycles)
+	{
+		if (next >= 0)
+			return;
+		u32 fztime = now() - cycles;
+		if (nextId != -1)
+		{
+			for (size_t i = 0; i < events.size(); i++)
+			{
+				int remaining = remainingCycles(events[i], fztime);
+				if (remaining >= 0 && remaining <= cycles)
+					handle(i);
+			}
+		}
+		ffts();
+	}
+
+	u64 now64() const {
+		return ffb - next;
+	}
+
+	int next = 0;
+
+private:
+	struct Event
+	{
+		int start = -1;
+		int end = -1;
+	};
+
+	u32 now() const {
+		return ffb - next;
+	}
+
+	static u32 remainingCycles(const Event& event, u32 reference)
+	{
+		if (event.end != -1)
+			return event.end - reference;
+		else
+			return -1;
+	}
+
+	void ffts()
+	{
+		u32 diff = -1;
+		int slot = -1;
+		for (size_t i = 0; i < events.size(); i++)
+		{
+			u32 remaining = remainingCycles(events[i], now());
+			if (remaining < diff)
+			{
+				slot = i;
+				diff = remaining;
+			}
+		}
+		ffb -= next;
+		nextId = slot;
+		if (slot != -1)
+			next = diff;
+		else
+			next = SH4_MAIN_CLOCK;
+		ffb += next;
+	}
+
+	void handle(int index)
+	{
+		Event& event = events[index];
+		int remain = event.end - event.start;
+		int elapsed = now() - event.start;
+		event.start = now();
+		int jitter = elapsed - remain;
+		event.end = -1;
+		int reschedule = callback(index, remain, jitter);
+		if (reschedule > 0)
+			request(index, std::max(0, reschedule - jitter));
+	}
+
+	std::vector<Event> events;
+	Callback callback;
+	u64 ffb = 0;
+	int nextId = -1;
+};
+
+// Replay a recorded sequence of requests, timeslices and callback actions on both schedulers
+// and check that callbacks are called in the same order, at the same time and with the same arguments.
+// Timeslices that overrun the scheduled time leave overdue events, and callbacks
+// schedule, reschedule and cancel other events including 0-cycle requests.
+TEST_F(Sh4SchedTest, ReplayLinearScheduler)
+{
+	constexpr int EventCount = 8;
+	enum StepType { Request, Run, Overrun, Advance };
+	struct Step
+	{
+		StepType type;
+		int index;
+		int cycles;
+	};
+	struct Action
+	{
+		int reschedule;
+		int other;			// index of another event to request, or -1
+		int otherCycles;
+	};
+	std::mt19937 rng(5678);
+	auto randomCycles = [&rng]() {
+		switch (rng() % 4)
+		{
+		case 0: return -1;
+		case 1: return 0;
+		case 2: return (int)(rng() % 2000);
+		default: return (int)(rng() % 200000);
+		}
+	};
+	std::vector<Step> trace;
+	for (int i = 0; i < 20000; i++)
+	{
+		switch (rng() % 8)
+		{
+		case 0:
+		case 1:
+			trace.push_back({ Request, (int)(rng() % EventCount), randomCycles() });
+			break;
+		case 2:
+			trace.push_back({ Overrun, 0, (int)(rng() % 3000) });
+			break;
+		case 3:
+			trace.push_back({ Advance, 0, (int)(rng() % SH4_TIMESLICE) });
+			break;
+		default:
+			trace.push_back({ Run, 0, 0 });
+			break;
+		}
+	}
+	std::vector<Action> actions;
+	for (int i = 0; i < 100000; i++)
+	{
+		Action action;
+		action.reschedule = rng() % 3 == 0 ? (int)(rng() % 10000) : 0;
+		action.other = rng() % 2 == 0 ? (int)(rng() % EventCount) : -1;
+		action.otherCycles = randomCycles();
+		actions.push_back(action);
+	}
+
+	struct Call
+	{
+		int index;
+		u64 time;
+		int remain;
+		int jitter;
+		bool operator==(const Call& other) const {
+			return index == other.index && time == other.time && remain == other.remain && jitter == other.jitter;
+		}
+	};
+
+	// Reference
+	std::vector<Call> refCalls;
+	std::vector<int> refNext;
+	{
+		size_t actionIdx = 0;
+		LinearScheduler *ref = nullptr;
+		LinearScheduler linear(EventCount, [&](int index, int remain, int jitter) {
+			refCalls.push_back({ index, ref->now64(), remain, jitter });
+			const Action& action = actions[actionIdx++ % actions.size()];
+			if (action.other != -1 && action.other != index)
+				ref->request(action.other, action.otherCycles);
+			return action.reschedule;
+		});
+		ref = &linear;
+		for (const Step& step : trace)
+		{
+			switch (step.type)
+			{
+			case Request:
+				linear.request(step.index, step.cycles);
+				break;
+			case Run:
+			case Overrun:
+				linear.next -= SH4_TIMESLICE + step.cycles;
+				linear.tick(SH4_TIMESLICE);
+				break;
+			case Advance:
+				linear.next -= step.cycles;
+				break;
+			}
+			refNext.push_back(linear.next);
+		}
+	}
+
+	// Heap scheduler
+	struct Context
+	{
+		std::vector<int> ids;
+		std::vector<Call> calls;
+		const std::vector<Action> *actions;
+		size_t actionIdx = 0;
+		u64 start;
+	};
+	static Context context;
+	context = Context();
+	context.actions = &actions;
+	context.start = sh4_sched_now64();
+	for (int i = 0; i < EventCount; i++)
+		context.ids.push_back(sh4_sched_register(i, [](int index, int remain, int jitter, void *) {
+			context.calls.push_back({ index, sh4_sched_now64() - context.start, remain, jitter });
+			const Action& action = (*context.actions)[context.actionIdx++ % context.actions->size()];
+			if (action.other != -1 && action.other != index)
+				sh4_sched_request(context.ids[action.other], action.otherCycles);
+			return action.reschedule;
+		}));
+	ASSERT_TRUE(std::is_sorted(context.ids.begin(), context.ids.end()));
+	std::vector<int> next;
+	for (const Step& step : trace)
+	{
+		switch (step.type)
+		{
+		case Request:
+			sh4_sched_request(context.ids[step.index], step.cycles);
+			break;
+		case Run:
+		case Overrun:
+			Sh4cntx.sh4_sched_next -= SH4_TIMESLICE + step.cycles;
+			sh4_sched_tick(SH4_TIMESLICE);
+			break;
+		case Advance:
+			Sh4cntx.sh4_sched_next -= step.cycles;
+			break;
+		}
+		next.push_back(Sh4cntx.sh4_sched_next);
+	}
+	for (int id : context.ids)
+		sh4_sched_unregister(id);
+
+	ASSERT_EQ(refNext.size(), next.size());
+	for (size_t i = 0; i < next.size(); i++)
+		ASSERT_EQ(refNext[i], next[i]) << "step " << i;
+	ASSERT_GT(refCalls.size(), 1000u);
+	ASSERT_EQ(refCalls.size(), context.calls.size());
+	for (size_t i = 0; i < refCalls.size(); i++)
+		ASSERT_TRUE(refCalls[i] == context.calls[i]) << "call " << i << ": event " << refCalls[i].index << " at " << refCalls[i].time
+			<< " instead of event " << context.calls[i].index << " at " << context.calls[i].time;
+}
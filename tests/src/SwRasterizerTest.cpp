@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "rend/software/sw_rasterizer.h"
+#include "hw/pvr/pvr_regs.h"
+
+class SwRasterizerTest : public ::testing::Test
+{
+protected:
+	static constexpr u32 Width = 64;
+	static constexpr u32 Height = 64;
+
+	void SetUp() override
+	{
+		ctx.verts.clear();
+		ctx.idx.clear();
+		ctx.global_param_op.clear();
+		ctx.global_param_pt.clear();
+		ctx.global_param_tr.clear();
+		ctx.global_param_mvo.clear();
+		ctx.modtrig.clear();
+		ctx.render_passes.clear();
+		ctx.sortedTriangles.clear();
+		ctx.isRTT = false;
+		ctx.fog_clamp_min.full = 0;
+		ctx.fog_clamp_max.full = 0xffffffff;
+		ctx.scaler_ctl.full = 0;
+		ctx.scaler_ctl.vscalefactor = 0x400;
+		ctx.fb_X_CLIP.min = 0;
+		ctx.fb_X_CLIP.max = Width - 1;
+		ctx.fb_Y_CLIP.min = 0;
+		ctx.fb_Y_CLIP.max = Height - 1;
+	}
+
+	PolyParam& addQuad(std::vector<PolyParam>& list, float x0, float y0, float x1, float y1, float z, u32 rgba)
+	{
+		PolyParam pp;
+		pp.init();
+		pp.first = ctx.idx.size();
+		pp.count = 4;
+		pp.pcw.Gouraud = 1;
+		pp.isp.DepthMode = 6;	// >=
+		pp.tsp.SrcInstr = 1;	// one
+		pp.tsp.DstInstr = 0;	// zero
+		pp.tsp.UseAlpha = 1;
+		pp.tsp.FogCtrl = 2;		// no fog
+		const float coords[4][2] { { x0, y0 }, { x1, y0 }, { x0, y1 }, { x1, y1 } };
+		for (const auto& c : coords)
+		{
+			Vertex vtx {};
+			vtx.x = c[0];
+			vtx.y = c[1];
+			vtx.z = z;
+			memcpy(vtx.col, &rgba, 4);
+			ctx.idx.push_back(ctx.verts.size());
+			ctx.verts.push_back(vtx);
+		}
+		list.push_back(pp);
+		return list.back();
+	}
+
+	void render()
+	{
+		RenderPass pass {};
+		pass.op_count = ctx.global_param_op.size();
+		pass.pt_count = ctx.global_param_pt.size();
+		pass.tr_count = ctx.global_param_tr.size();
+		pass.mvo_count = ctx.global_param_mvo.size();
+		ctx.render_passes.push_back(pass);
+		rasterizer.render(ctx, Width, Height, 0xff000000);
+	}
+
+	u32 pixel(u32 x, u32 y) const {
+		return rasterizer.data()[y * Width + x];
+	}
+
+	rend_context ctx;
+	software::Rasterizer rasterizer;
+};
+
+TEST_F(SwRasterizerTest, OpaqueDepth)
+{
+	addQuad(ctx.global_param_op, 0, 0, Width, Height, 1.f, 0xff0000ff);	// red background
+	addQuad(ctx.global_param_op, 16, 16, 48, 48, 0.5f, 0xff00ff00);		// green, behind
+	addQuad(ctx.global_param_op, 0, 0, 32, 32, 2.f, 0xffff0000);		// blue, in front
+	render();
+
+	ASSERT_EQ(0xffff0000u, pixel(0, 0));
+	ASSERT_EQ(0xffff0000u, pixel(31, 31));
+	ASSERT_EQ(0xff0000ffu, pixel(32, 32));
+	ASSERT_EQ(0xff0000ffu, pixel(40, 20));
+	ASSERT_EQ(0xff0000ffu, pixel(Width - 1, Height - 1));
+}
+
+TEST_F(SwRasterizerTest, FillRule)
+{
+	// Adjacent quads sharing an edge must not overlap or leave gaps
+	addQuad(ctx.global_param_tr, 0, 0, 20.5f, Height, 1.f, 0x80000040);
+	addQuad(ctx.global_param_tr, 20.5f, 0, Width, Height, 1.f, 0x80000040);
+	for (PolyParam& pp : ctx.global_param_tr)
+	{
+		pp.isp.DepthMode = 7;	// always
+		pp.tsp.DstInstr = 1;	// one: additive blending
+	}
+	render();
+
+	for (u32 y = 0; y < Height; y++)
+		for (u32 x = 0; x < Width; x++)
+			ASSERT_EQ(0xff000040u, pixel(x, y) | 0xff000000) << "at " << x << "," << y;
+}
+
+TEST_F(SwRasterizerTest, Blending)
+{
+	addQuad(ctx.global_param_op, 0, 0, Width, Height, 1.f, 0xff0000ff);	// red
+	PolyParam& pp = addQuad(ctx.global_param_tr, 0, 0, Width, Height, 1.f, 0x8000ff00);	// green, 50% alpha
+	pp.isp.DepthMode = 7;
+	pp.tsp.SrcInstr = 4;	// src alpha
+	pp.tsp.DstInstr = 5;	// 1 - src alpha
+	render();
+
+	const u32 c = pixel(10, 10);
+	ASSERT_NEAR(0x7f, c & 0xff, 1);
+	ASSERT_NEAR(0x80, (c >> 8) & 0xff, 1);
+	ASSERT_EQ(0u, (c >> 16) & 0xff);
+}
+
+TEST_F(SwRasterizerTest, ModifierVolume)
+{
+	FPU_SHAD_SCALE.full = 0;
+	FPU_SHAD_SCALE.scale_factor = 128;
+	PolyParam& pp = addQuad(ctx.global_param_op, 0, 0, Width, Height, 1.f, 0xffffffff);
+	pp.pcw.Shadow = 1;
+
+	// Inclusion volume in front of the left half of the screen
+	ModifierVolumeParam mvp;
+	mvp.init();
+	mvp.first = 0;
+	mvp.count = 2;
+	mvp.isp.VolumeLast = 1;
+	mvp.isp.DepthMode = 1;
+	ctx.global_param_mvo.push_back(mvp);
+	ctx.modtrig.push_back({ 0, 0, 2.f, 32, 0, 2.f, 0, (float)Height, 2.f });
+	ctx.modtrig.push_back({ 32, 0, 2.f, 32, (float)Height, 2.f, 0, (float)Height, 2.f });
+	render();
+
+	ASSERT_EQ(0xff808080u, pixel(5, 5));
+	ASSERT_EQ(0xff808080u, pixel(31, 63));
+	ASSERT_EQ(0xffffffffu, pixel(32, 5));
+	ASSERT_EQ(0xffffffffu, pixel(63, 63));
+}
@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "rend/TexCache.h"
+#include <random>
+
+class TexConvTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		std::mt19937 rng(1234);
+		source.resize(1024 * 1024 * 2);
+		for (u8& b : source)
+			b = (u8)rng();
+		codebook.resize(VQ_CODEBOOK_SIZE);
+		for (u8& b : codebook)
+			b = (u8)rng();
+		savedCodebook = vq_codebook;
+		vq_codebook = codebook.data();
+	}
+
+	void TearDown() override {
+		vq_codebook = savedCodebook;
+	}
+
+	template<typename Pixel>
+	using ConvFunc = void (*)(PixelBuffer<Pixel> *, const u8 *, u32, u32);
+
+	template<typename Pixel>
+	void compare(ConvFunc<Pixel> func, ConvFunc<Pixel> reference, u32 width, u32 height)
+	{
+		PixelBuffer<Pixel> pb;
+		pb.init(width, height);
+		func(&pb, source.data(), width, height);
+		PixelBuffer<Pixel> refpb;
+		refpb.init(width, height);
+		reference(&refpb, source.data(), width, height);
+		for (u32 y = 0; y < height; y++)
+			for (u32 x = 0; x < width; x++)
+				ASSERT_EQ(*refpb.data(x, y), *pb.data(x, y)) << "at " << x << "," << y << " size " << width << "x" << height;
+	}
+
+	template<typename Convertor>
+	void checkTwiddled()
+	{
+		using Pixel = typename Convertor::unpacked_type;
+		for (auto [w, h] : sizes)
+		{
+			compare<Pixel>(texture_TW<Convertor>, texture_TW_scalar<Convertor>, w, h);
+			compare<Pixel>(texture_VQ<Convertor>, texture_VQ_scalar<Convertor>, w, h);
+		}
+	}
+
+	template<typename Convertor>
+	void checkPlanar()
+	{
+		using Pixel = typename Convertor::unpacked_type;
+		for (auto [w, h] : sizes)
+			if (w >= 4)
+				compare<Pixel>(texture_PL<Convertor>, texture_PL_scalar<Convertor>, w, h);
+		compare<Pixel>(texture_PL<Convertor>, texture_PL_scalar<Convertor>, 640, 480);
+		compare<Pixel>(texture_PL<Convertor>, texture_PL_scalar<Convertor>, 20, 7);
+	}
+
+	std::vector<u8> source;
+	std::vector<u8> codebook;
+	const u8 *savedCodebook = nullptr;
+	const std::vector<std::pair<u32, u32>> sizes { { 2, 2 }, { 4, 4 }, { 8, 8 }, { 64, 64 }, { 256, 64 }, { 32, 1024 }, { 1024, 1024 } };
+};
+
+TEST_F(TexConvTest, Twiddled16)
+{
+	checkTwiddled<ConvertTwiddle<UnpackerNop<u16>>>();
+	checkTwiddled<ConvertTwiddle<Unpacker1555>>();
+	checkTwiddled<ConvertTwiddle<Unpacker4444>>();
+}
+
+TEST_F(TexConvTest, Twiddled32)
+{
+	checkTwiddled<ConvertTwiddle<Unpacker565_32<RGBAPacker>>>();
+	checkTwiddled<ConvertTwiddle<Unpacker1555_32<RGBAPacker>>>();
+	checkTwiddled<ConvertTwiddle<Unpacker4444_32<RGBAPacker>>>();
+	checkTwiddled<ConvertTwiddleYUV<RGBAPacker>>();
+	checkTwiddled<ConvertTwiddle<Unpacker565_32<BGRAPacker>>>();
+	checkTwiddled<ConvertTwiddle<Unpacker1555_32<BGRAPacker>>>();
+	checkTwiddled<ConvertTwiddle<Unpacker4444_32<BGRAPacker>>>();
+	checkTwiddled<ConvertTwiddleYUV<BGRAPacker>>();
+}
+
+TEST_F(TexConvTest, Planar)
+{
+	checkPlanar<ConvertPlanar<Unpacker565_32<RGBAPacker>>>();
+	checkPlanar<ConvertPlanar<Unpacker1555_32<RGBAPacker>>>();
+	checkPlanar<ConvertPlanar<Unpacker4444_32<RGBAPacker>>>();
+	checkPlanar<ConvertPlanarYUV<RGBAPacker>>();
+	checkPlanar<ConvertPlanar<Unpacker565_32<BGRAPacker>>>();
+	checkPlanar<ConvertPlanarYUV<BGRAPacker>>();
+}
@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/ta_ctx.h"
+#include <algorithm>
+#include <random>
+
+class TriangleSortTest : public ::testing::Test {
+protected:
+	// Adds a strip of count vertices to the translucent list
+	void addStrip(const std::vector<float>& z)
+	{
+		PolyParam pp;
+		pp.init();
+		pp.first = ctx.verts.size();
+		pp.count = z.size();
+		// all different so that consecutive triangles aren't merged into the same poly
+		pp.tsp.full = ctx.global_param_tr.size();
+		ctx.global_param_tr.push_back(pp);
+		for (float vz : z)
+		{
+			Vertex vtx {};
+			vtx.z = vz;
+			ctx.verts.push_back(vtx);
+		}
+	}
+
+	void sort()
+	{
+		ctx.render_passes.resize(1);
+		RenderPass& pass = ctx.render_passes[0];
+		pass = {};
+		pass.tr_count = ctx.global_param_tr.size();
+		RenderPass previousPass {};
+		sortTriangles(ctx, pass, previousPass);
+	}
+
+	rend_context ctx {};
+};
+
+// Sorting by z must give the same order as the std::stable_sort it replaces
+TEST_F(TriangleSortTest, stableSort)
+{
+	std::mt19937 rng(1234);
+	// few distinct depths to get many ties, including -0 and +0
+	const float depths[] { -2.f, -0.5f, -0.f, 0.f, 1e-10f, 0.25f, 1.f, 1000.f, 3e37f };
+	for (u32 triangles : { 1u, 2u, 17u, 1000u, 5000u })
+	{
+		ctx = {};
+		std::vector<float> minZ;
+		for (u32 i = 0; i < triangles; i++)
+		{
+			std::vector<float> z(3);
+			for (float& vz : z)
+				vz = depths[rng() % std::size(depths)];
+			addStrip(z);
+			minZ.push_back(std::min(z[0], std::min(z[1], z[2])));
+		}
+		std::vector<u32> order(triangles);
+		for (u32 i = 0; i < triangles; i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+			return minZ[a] < minZ[b];
+		});
+
+		sort();
+		ASSERT_EQ(triangles * 3, ctx.idx.size());
+		for (u32 i = 0; i < triangles; i++)
+			ASSERT_EQ(order[i] * 3, ctx.idx[i * 3]) << "at " << i << " of " << triangles;
+	}
+}
+
+// Strips with less than 3 vertices don't produce any triangle
+TEST_F(TriangleSortTest, noTriangle)
+{
+	addStrip({ 1.f, 2.f });
+	sort();
+	ASSERT_TRUE(ctx.idx.empty());
+	ASSERT_EQ(1u, ctx.sortedTriangles.size());
+	ASSERT_EQ(0u, ctx.sortedTriangles[0].count);
+}